@@ -0,0 +1,104 @@
+/**
+ * @file circular_queue.cpp
+ * @brief Microbenchmark of `emu::circular_queue` against the `std::queue` based container it replaced.
+ *
+ * usage: bin/bench_circular_queue [lines]
+ *
+ * Each line follows the pixel fetcher: the queue is cleared, then filled 8 pixels at a time and drained a pixel at a
+ * time until 160 pixels came out.
+ */
+#include "platform.h"
+
+#include <chrono>
+#include <queue>
+
+using namespace std;
+
+int systemExitStatus = 1;
+
+/// @brief The previous `circular_queue`, a `std::deque` underneath.
+template <typename T, size_t kCapacity>
+class dequeCircularQueue: public std::queue<T>
+{
+public:
+    void enqueue(T newValue)
+    {
+        if (this->size() == kCapacity)
+        {
+            this->pop();
+        }
+        this->push(newValue);
+    }
+
+    T dequeue()
+    {
+        auto front = this->front();
+        this->pop();
+        return front;
+    }
+
+    void clear()
+    {
+        std::queue<T> empty;
+        std::swap(static_cast<std::queue<T> &>(*this), empty);
+    }
+};
+
+/// @brief Same layout as `PixelFetcher::pixelInfo`.
+struct packed(1) pixel
+{
+    uint8_t encoding  : 2;
+    uint8_t isBgPixel : 1;
+    uint8_t objectPalette : 1;
+    uint8_t priority  : 1;
+};
+
+static constexpr uint32_t kPixelsPerLine = 160;
+
+/// @brief Returns nanoseconds per pixel.
+template <typename Queue>
+static double
+runLines(uint64_t lines, uint32_t &checksum)
+{
+    Queue queue;
+    auto begin = chrono::steady_clock::now();
+    for (uint64_t line = 0; line < lines; line++)
+    {
+        queue.clear();
+        uint8_t seed = static_cast<uint8_t>(line);
+        for (uint32_t x = 0; x < kPixelsPerLine; )
+        {
+            if (queue.size() <= 8)
+            {
+                for (uint8_t i = 0; i < 8; i++)
+                {
+                    uint8_t encoding = static_cast<uint8_t>((seed + i) & 0x3);
+                    queue.enqueue(pixel { .encoding = encoding, .isBgPixel = 1, .objectPalette = 0, .priority = 0 });
+                }
+                seed += 3;
+            }
+            checksum += queue.dequeue().encoding;
+            x++;
+        }
+    }
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - begin;
+    return elapsed.count() / (lines * kPixelsPerLine);
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t lines = (argc > 1) ? strtoull(argv[1], nullptr, 0) : 1000000;
+    require_or(lines > 0, log_error("Need at least one line"); return 1);
+
+    uint32_t checksum = 0;
+    double deque = runLines<dequeCircularQueue<pixel, 16>>(lines, checksum);
+    double ring = runLines<emu::circular_queue<pixel, 16>>(lines, checksum);
+    printf("%llu lines of %u pixels\n", static_cast<unsigned long long>(lines), kPixelsPerLine);
+    printf("std::queue          %8.2f ns/pixel\n", deque);
+    printf("circular_queue      %8.2f ns/pixel (%.1fx)\n", ring, deque / ring);
+    /// Keeps the queues from being optimized out.
+    printf("checksum 0x%08x\n", checksum);
+    systemExitStatus = 0;
+    return 0;
+}
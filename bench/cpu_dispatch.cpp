@@ -0,0 +1,83 @@
+/**
+ * @file cpu_dispatch.cpp
+ * @brief Benchmark of the CPU backends running the same game for the same number of M-cycles.
+ *
+ * usage: bin/bench_cpu_dispatch [game file] [M-cycles]
+ */
+#include "Emulator.hpp"
+#include "hal.h"
+
+#include <chrono>
+
+using namespace std;
+using namespace emu::gameboy;
+
+int systemExitStatus = 1;
+
+struct result
+{
+    double   seconds = 0;
+    uint64_t mCycles = 0;
+    uint64_t instructions = 0;
+};
+
+/// @brief Boot the game on a fresh emulator and run it with one backend, idle loops are never skipped.
+static bool
+runGame(const char *gameFilename, CentralProcessor::backend backend, bool fusion, uint64_t mCycles, result &out)
+{
+    emu::Emulator emulator(emu::Emulator::Type::gameboy);
+    require_or(emulator.Activate(gameFilename), log_error("Failed to load %s", gameFilename); return false);
+    require_or(emulator.SetCpuBackend(backend), return false);
+    emulator.SetIdleLoopSkipping(false);
+    emulator.SetInstructionFusion(fusion);
+
+    auto begin = chrono::steady_clock::now();
+    while (emulator.GetCycleCount() < mCycles)
+    {
+        emulator.Run();
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+    out.seconds = elapsed.count();
+    out.mCycles = emulator.GetCycleCount();
+    out.instructions = emulator.GetInstructionCount();
+    return true;
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *gameFilename = (argc > 1) ? argv[1] : "games/Tetris.gb";
+    uint64_t mCycles = (argc > 2) ? strtoull(argv[2], nullptr, 0) : 20000000;
+    /// The PPU draws into the display's pixel buffer.
+    HAL_DisplayInit("bench", kConfigScreenPixelsX, kConfigScreenPixelsY);
+
+    struct
+    {
+        const char *                name;
+        CentralProcessor::backend   backend;
+        bool                        fusion;
+    } engines[] = {
+        { "interpreter",            CentralProcessor::backend::interpreter, false },
+        { "interpreter (fused)",    CentralProcessor::backend::interpreter, true },
+        { "threaded",               CentralProcessor::backend::threaded,    false },
+        { "recompiler",             CentralProcessor::backend::recompiler,  false },
+    };
+    result baseline;
+    /// The plain interpreter runs first, the others are compared against it.
+    for (auto &engine: engines)
+    {
+        result run;
+        require_or(runGame(gameFilename, engine.backend, engine.fusion, mCycles, run),
+                   printf("%-20s not supported\n", engine.name); continue);
+        if (engine.backend == CentralProcessor::backend::interpreter && !engine.fusion)
+        {
+            baseline = run;
+        }
+        /// Engines overshoot the target by a different number of M-cycles, compare their rates.
+        double rate = run.mCycles / run.seconds;
+        printf("%-20s %.0f M-cycles/s, %.0f instructions/s (%.2fx)\n", engine.name, rate, 
+               run.instructions / run.seconds, rate / (baseline.mCycles / baseline.seconds));
+    }
+    systemExitStatus = 0;
+    return 0;
+}
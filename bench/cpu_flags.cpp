@@ -0,0 +1,80 @@
+/**
+ * @file cpu_flags.cpp
+ * @brief Microbenchmark of an ALU-heavy loop with lazy and eager flag evaluation.
+ *
+ * usage: bin/bench_cpu_flags [game file] [instructions]
+ */
+#include "cpu.h"
+#include "mmu.h"
+
+#include <chrono>
+
+using namespace std;
+using namespace emu::gameboy;
+
+int systemExitStatus = 1;
+
+/// Loop placed in work RAM, only the branch at the end of each iteration reads a flag.
+static constexpr uint16_t kLoopAddress = 0xC000;
+static constexpr uint8_t kLoop[] = {
+    0x06, 0x00,         /// LD B,0
+    0x81,               /// ADD A,C
+    0x8A,               /// ADC A,D
+    0x93,               /// SUB A,E
+    0xA8,               /// XOR A,B
+    0xA4,               /// AND A,H
+    0xB5,               /// OR A,L
+    0x0C,               /// INC C
+    0xBA,               /// CP A,D
+    0x9B,               /// SBC A,E
+    0x05,               /// DEC B
+    0x20, 0xF4,         /// JR NZ,-12
+    0xC3, 0x00, 0xC0,   /// JP 0xC000
+};
+
+/// @brief Run the loop from a fixed register state, returns instructions per second.
+static double
+runLoop(CentralProcessor &cpu, uint64_t instructions, bool lazyFlags, uint16_t &af)
+{
+    auto &registers = cpu.getRegisters();
+    cpu.reset();
+    cpu.setLazyFlags(lazyFlags);
+    registers.de = 0x1234;
+    registers.hl = 0xF00F;
+    registers.programCounter = kLoopAddress;
+
+    uint64_t start = cpu.getInstructionCount();
+    auto begin = chrono::steady_clock::now();
+    while (cpu.getInstructionCount() - start < instructions)
+    {
+        cpu.executeNextInstruction(cpu.getNextInstruction());
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+    af = registers.getAF();
+    return instructions / elapsed.count();
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *gameFilename = (argc > 1) ? argv[1] : "games/Tetris.gb";
+    uint64_t instructions = (argc > 2) ? strtoull(argv[2], nullptr, 0) : 50000000;
+
+    auto memory = make_shared<GameboyMemory>();
+    require_or(memory->activate(gameFilename), log_error("Failed to load %s", gameFilename); return 1);
+    memory->write(kLoopAddress, kLoop, sizeof(kLoop));
+    CentralProcessor cpu(memory);
+
+    uint16_t eagerAF = 0;
+    uint16_t lazyAF = 0;
+    /// Warm up the block cache before measuring.
+    runLoop(cpu, instructions / 10, true, lazyAF);
+    double eager = runLoop(cpu, instructions, false, eagerAF);
+    double lazy = runLoop(cpu, instructions, true, lazyAF);
+    require_or(eagerAF == lazyAF, log_error("Flags differ, eager AF=0x%04x lazy AF=0x%04x", eagerAF, lazyAF); return 1);
+
+    printf("eager flags: %.0f instructions/s\n", eager);
+    printf("lazy flags:  %.0f instructions/s (%.2fx)\n", lazy, lazy / eager);
+    systemExitStatus = 0;
+    return 0;
+}
@@ -0,0 +1,120 @@
+/**
+ * @file mem_access.cpp
+ * @brief Microbenchmark of CPU reads and writes to each region of the address space.
+ *
+ * usage: bin/bench_mem_access [game file] [accesses] [dirty]
+ *
+ * With "dirty", writes are made with dirty page tracking on and a checkpoint every 4096 accesses.
+ */
+#include "mmu.h"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace emu::gameboy;
+
+int systemExitStatus = 1;
+
+/// @brief Addresses are drawn up front so the loop only measures the memory accesses.
+static vector<uint16_t>
+makeAddresses(uint16_t begin, uint16_t end, size_t count)
+{
+    mt19937 generator(0x6B);
+    uniform_int_distribution<uint32_t> distribution(begin, end - 1);
+    vector<uint16_t> addresses(count);
+    for (auto &address: addresses)
+    {
+        address = static_cast<uint16_t>(distribution(generator));
+    }
+    return addresses;
+}
+
+/// @brief Returns nanoseconds per access.
+template <typename T>
+static double
+runReads(GameboyMemory &memory, const vector<uint16_t> &addresses, uint64_t accesses, uint32_t &checksum)
+{
+    auto begin = chrono::steady_clock::now();
+    for (uint64_t i = 0; i < accesses; i += addresses.size())
+    {
+        for (auto address: addresses)
+        {
+            checksum += memory.read<T>(address);
+        }
+    }
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - begin;
+    return elapsed.count() / accesses;
+}
+
+template <typename T>
+static double
+runWrites(GameboyMemory &memory, const vector<uint16_t> &addresses, uint64_t accesses, bool checkpoints)
+{
+    auto begin = chrono::steady_clock::now();
+    for (uint64_t i = 0; i < accesses; i += addresses.size())
+    {
+        for (auto address: addresses)
+        {
+            memory.write<T>(address, static_cast<T>(address + i));
+        }
+        if (checkpoints)
+        {
+            memory.clearDirtyPages();
+        }
+    }
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - begin;
+    return elapsed.count() / accesses;
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *gameFilename = (argc > 1) ? argv[1] : "games/Tetris.gb";
+    uint64_t accesses = (argc > 2) ? strtoull(argv[2], nullptr, 0) : 100000000;
+    static constexpr size_t kAddresses = 4096;
+    accesses = max<uint64_t>(kAddresses, accesses - (accesses % kAddresses));
+    bool dirtyTracking = (argc > 3) && !strcmp(argv[3], "dirty");
+
+    GameboyMemory memory;
+    require_or(memory.activate(gameFilename), log_error("Failed to load %s", gameFilename); return 1);
+    memory.setDirtyTracking(dirtyTracking);
+
+    /// Only the LCD registers are read from the IO page, nothing hooks them here.
+    struct
+    {
+        const char *name;
+        uint16_t    begin;
+        uint16_t    end;
+        bool        writable;
+    } regions[] = {
+        { "ROM bank 0",     0x0100, 0x4000, false },
+        { "ROM bank 1",     0x4000, 0x8000, false },
+        { "video RAM",      0x8000, 0xA000, true },
+        { "work RAM",       0xC000, 0xE000, true },
+        { "echo RAM",       0xE000, 0xFE00, true },
+        { "LCD registers",  0xFF40, 0xFF4C, false },
+        { "high RAM",       0xFF80, 0xFFFF, true },
+    };
+    uint32_t checksum = 0;
+    printf("%-14s %12s %12s %12s %12s\n", "region", "read8 ns", "read16 ns", "write8 ns", "write16 ns");
+    for (auto &region: regions)
+    {
+        /// 16-bit accesses stay inside the region.
+        auto addresses = makeAddresses(region.begin, region.end - 1, kAddresses);
+        double read8 = runReads<uint8_t>(memory, addresses, accesses, checksum);
+        double read16 = runReads<uint16_t>(memory, addresses, accesses, checksum);
+        printf("%-14s %12.2f %12.2f", region.name, read8, read16);
+        if (region.writable)
+        {
+            printf(" %12.2f %12.2f", runWrites<uint8_t>(memory, addresses, accesses, dirtyTracking),
+                   runWrites<uint16_t>(memory, addresses, accesses, dirtyTracking));
+        }
+        printf("\n");
+    }
+    /// Keeps the reads from being optimized out.
+    printf("checksum 0x%08x\n", checksum);
+    systemExitStatus = 0;
+    return 0;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file pixel_kernels.cpp
+ * @brief Microbenchmark of the HAL pixel kernels at every instruction set level the host supports.
+ *
+ * usage: bin/bench_pixel_kernels [lines]
+ *
+ * Each line decodes the 20 tiles a scanline crosses, applies a palette to 160 pixels and converts them to ARGB8888.
+ * Every level's output is checked against the scalar kernels.
+ */
+#include "hal.h"
+#include "hal_pixel.h"
+
+#include <chrono>
+#include <vector>
+
+using namespace std;
+
+int systemExitStatus = 1;
+
+static constexpr uint16_t kPixelsPerLine = 160;
+static constexpr uint16_t kTilesPerLine = kPixelsPerLine / 8;
+
+struct result
+{
+    double   decode = 0;
+    double   palette = 0;
+    double   argb = 0;
+    uint32_t checksum = 0;
+};
+
+template <typename Fn>
+static double
+nanosecondsPerPixel(uint64_t lines, Fn &&fn)
+{
+    auto begin = chrono::steady_clock::now();
+    for (uint64_t line = 0; line < lines; line++)
+    {
+        fn(line);
+    }
+    chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - begin;
+    return elapsed.count() / (lines * kPixelsPerLine);
+}
+
+static result
+runKernels(uint64_t lines, const vector<uint8_t> &tiles)
+{
+    result out;
+    uint8_t indices[kTilesPerLine][64], flipped[kTilesPerLine][64];
+    uint8_t row[kPixelsPerLine], brightness[kPixelsPerLine];
+    uint32_t argb[kPixelsPerLine];
+
+    out.decode = nanosecondsPerPixel(lines, [&](uint64_t line) {
+        const uint8_t *tile = &tiles[(line % 64) * 16 * kTilesPerLine];
+        for (uint16_t i = 0; i < kTilesPerLine; i++)
+        {
+            HAL_PixelDecodeTile(tile + 16 * i, indices[i], flipped[i]);
+        }
+    });
+    for (uint16_t i = 0; i < kTilesPerLine; i++)
+    {
+        memcpy(&row[8 * i], &indices[i][8 * (i & 7)], 8);
+        for (uint8_t j = 0; j < 64; j++)
+        {
+            out.checksum = out.checksum * 31 + indices[i][j] + 5 * flipped[i][j];
+        }
+    }
+    out.palette = nanosecondsPerPixel(lines, [&](uint64_t line) {
+        HAL_PixelApplyPalette(row, static_cast<uint8_t>(line), brightness, kPixelsPerLine);
+    });
+    out.argb = nanosecondsPerPixel(lines, [&](uint64_t line) {
+        brightness[line % kPixelsPerLine] ^= 1;
+        HAL_PixelToARGB8888(brightness, argb, kPixelsPerLine);
+    });
+    for (uint16_t i = 0; i < kPixelsPerLine; i++)
+    {
+        out.checksum = out.checksum * 31 + brightness[i] + argb[i];
+    }
+    return out;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t lines = (argc > 1) ? strtoull(argv[1], nullptr, 0) : 1000000;
+    require_or(lines > 0, log_error("Need at least one line"); return 1);
+
+    vector<uint8_t> tiles(64 * 16 * kTilesPerLine);
+    uint32_t seed = 0x12345678;
+    for (auto &byte : tiles)
+    {
+        seed = seed * 1103515245 + 12345;
+        byte = static_cast<uint8_t>(seed >> 16);
+    }
+
+    printf("%llu lines of %u pixels, ns/pixel\n", static_cast<unsigned long long>(lines), kPixelsPerLine);
+    printf("%-8s %8s %8s %8s\n", "isa", "decode", "palette", "argb");
+    const HAL_PixelISA selected = HAL_PixelGetISA();
+    result scalar;
+    for (int isa = HAL_PIXEL_ISA_SCALAR; isa < HAL_PIXEL_ISA_COUNT; isa++)
+    {
+        require_or(HAL_PixelSetISA(static_cast<HAL_PixelISA>(isa)) == kReturnOK,
+                   printf("%-8s not supported\n", HAL_PixelGetISAName(static_cast<HAL_PixelISA>(isa))); continue);
+        result r = runKernels(lines, tiles);
+        if (isa == HAL_PIXEL_ISA_SCALAR)
+        {
+            scalar = r;
+        }
+        printf("%-8s %8.3f %8.3f %8.3f", HAL_PixelGetISAName(static_cast<HAL_PixelISA>(isa)), r.decode, r.palette, r.argb);
+        printf(" (%.1fx %.1fx %.1fx)\n", scalar.decode / r.decode, scalar.palette / r.palette, scalar.argb / r.argb);
+        require_or(r.checksum == scalar.checksum, log_error("Output differs from the scalar kernels"); return 1);
+    }
+    HAL_PixelSetISA(selected);
+    printf("runtime dispatch picks %s\n", HAL_PixelGetISAName(selected));
+    systemExitStatus = 0;
+    return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file rom_sharing.cpp
+ * @brief Resident memory and load time of many emulator memories running the same game.
+ *
+ * Every instance shares one mapping of the ROM, private copies of it are measured for comparison.
+ *
+ * usage: bin/bench_rom_sharing [game file] [instances]
+ */
+#include "mmu.h"
+
+#include <chrono>
+#include <memory>
+#include <unistd.h>
+#include <vector>
+
+using namespace std;
+using namespace emu::gameboy;
+
+int systemExitStatus = 1;
+
+/// @brief Resident set size in KB, 0 if it can't be read.
+static uint64_t
+residentKB()
+{
+    unsigned long long pages = 0, resident = 0;
+    FILE *statm = fopen("/proc/self/statm", "r");
+    require_or(statm != nullptr, return 0);
+    int fields = fscanf(statm, "%llu %llu", &pages, &resident);
+    fclose(statm);
+    require_or(fields == 2, return 0);
+    return resident * sysconf(_SC_PAGESIZE) / 1024;
+}
+
+/// @brief Read every byte so it is resident.
+static uint32_t
+touch(const uint8_t *data, size_t size)
+{
+    uint32_t checksum = 0;
+    for (size_t i = 0; i < size; i++)
+    {
+        checksum += data[i];
+    }
+    return checksum;
+}
+
+int
+main(int argc, char **argv)
+{
+    const char *gameFilename = (argc > 1) ? argv[1] : "games/Tetris.gb";
+    size_t instances = (argc > 2) ? strtoull(argv[2], nullptr, 0) : 100;
+    require_or(instances > 0, log_error("Need at least one instance"); return 1);
+
+    uint32_t checksum = 0;
+    uint64_t before = residentKB();
+    vector<unique_ptr<GameboyMemory>> memories;
+    auto begin = chrono::steady_clock::now();
+    for (size_t i = 0; i < instances; i++)
+    {
+        memories.emplace_back(new GameboyMemory);
+        require_or(memories.back()->activate(gameFilename), log_error("Failed to load %s", gameFilename); return 1);
+    }
+    chrono::duration<double, micro> elapsed = chrono::steady_clock::now() - begin;
+    for (auto &memory: memories)
+    {
+        auto &rom = memory->getROMImage();
+        checksum += touch(rom->data(), rom->size());
+    }
+    uint64_t shared = residentKB();
+
+    /// What the same instances cost if each kept its own copy of the ROM.
+    auto &rom = memories.front()->getROMImage();
+    vector<vector<uint8_t>> copies;
+    for (size_t i = 0; i < instances; i++)
+    {
+        copies.emplace_back(rom->data(), rom->data() + rom->size());
+        checksum += touch(copies.back().data(), copies.back().size());
+    }
+    uint64_t copied = residentKB();
+
+    printf("%s: %zu KB ROM (%s), %zu instances\n", gameFilename, rom->size() / 1024,
+           rom->isMapped() ? "mapped" : "private copy", instances);
+    printf("activate            %10.1f us/instance\n", elapsed.count() / instances);
+    printf("resident, shared    %10llu KB (+%.1f KB/instance)\n", static_cast<unsigned long long>(shared),
+           static_cast<double>(shared - before) / instances);
+    printf("resident, copied    %10llu KB (+%.1f KB/instance)\n", static_cast<unsigned long long>(copied),
+           static_cast<double>(copied - before) / instances);
+    /// Keeps the reads from being optimized out.
+    printf("checksum 0x%08x\n", checksum);
+    systemExitStatus = 0;
+    return 0;
+}
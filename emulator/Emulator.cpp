@@ -11,17 +11,38 @@ Emulator::Emulator(Type type): _memory(new GameboyMemory)
     
 }
 
-Emulator::~Emulator() { }
+Emulator::~Emulator()
+{
+    require_or(_heatmapFile, return);
+    auto &heatmap = _memory->getAccessCounter();
+    if (!_heatmapEveryFrame)
+    {
+        heatmap.exportToFile(_heatmapFile, _frames);
+    }
+    fclose(_heatmapFile);
+    printf("Memory accesses over %llu frames\n", static_cast<unsigned long long>(_frames));
+    heatmap.printSummary(stdout);
+}
     
 bool 
-Emulator::Activate(const char *gameFile)
+Emulator::Activate(const char *gameFile, const char *bootROMFile)
 {
-    require_or(_memory->activate(gameFile), return false);
+    require_or(_memory->activate(gameFile, bootROMFile), return false);
+    _gameFile = gameFile;
     
     _ppu.emplace(_memory);
     _ppu->configureInterrupts(kConfigVBlankInterruptFlag, kConfigLCDInterruptFlag);
     _ppu->reset();
     _ppu->disable();
+    _ppu->setFrameCallback([this]() {
+        _memory->flushSaveFile();
+        _memory->publishFrame(_scheduler.getCycleCount());
+        _frames++;
+        if (_heatmapEveryFrame)
+        {
+            _memory->getAccessCounter().exportToFile(_heatmapFile, _frames);
+        }
+    });
 
     _control.emplace(_memory);
     _control->configureInterrupt(kConfigJoypadInterruptFlag);
@@ -30,6 +51,22 @@ Emulator::Activate(const char *gameFile)
     _timer.emplace(_memory, kConfigTimerInterruptFlag);
     
     _cpu.emplace(_memory);
+
+    using component = Scheduler::component;
+    _scheduler.attach(component::ppu, [this](uint32_t mCycles) { _ppu->mCycleUpdate(mCycles); },
+                      [this]() { return _ppu->getCyclesUntilEvent(); });
+    _scheduler.attach(component::timer, [this](uint32_t mCycles) { _timer->mCycleUpdate(mCycles); },
+                      [this]() { return _timer->getCyclesUntilEvent(); });
+    _scheduler.attach(component::dma, [this](uint32_t mCycles) { _memory->mCycleUpdate(mCycles); },
+                      [this]() { return _memory->getCyclesUntilEvent(); });
+    _memory->setAccessCallback([this](bool isWrite) { _scheduler.synchronize(isWrite); });
+    _memory->setCycleCountCallback([this]() { return _scheduler.getCycleCount(); });
+    _cpu->setClockCallback([this](uint8_t mCycles) { return _scheduler.tryAdvance(mCycles); });
+    if (!bootROMFile)
+    {
+        _memory->loadPostBootState();
+        _cpu->resetPostBoot();
+    }
 #if (EMULATOR_LOG_LEVEL == kLogLevelDebug)
     _cpu->printInstructions();
 #endif // (EMULATOR_LOG_LEVEL == kLogLevelDebug)
@@ -37,25 +74,116 @@ Emulator::Activate(const char *gameFile)
     return true;
 }
 
+bool
+Emulator::LoadSaveFile(const char *saveFile)
+{
+    require_or(_cpu, return false);
+    std::string filename;
+    if (saveFile == nullptr)
+    {
+        filename = _gameFile;
+        size_t extension = filename.rfind('.');
+        if ((extension != std::string::npos) && (filename.find('/', extension) == std::string::npos))
+        {
+            filename.erase(extension);
+        }
+        saveFile = filename.append(".sav").c_str();
+    }
+    require_or(_memory->loadSaveFile(saveFile), return false);
+    log_debug("Saving to %s", saveFile);
+    return true;
+}
+
+bool
+Emulator::ShareMemory(const char *name)
+{
+    require_or(!_cpu, log_error("Memory can only be shared before activating"); return false);
+    return _memory->shareMemory(name);
+}
+
+bool
+Emulator::RecordHeatmap(const char *filename, bool everyFrame)
+{
+    require_or(gameboy::GameboyMemory::AccessCounter::kEnabled,
+               log_error("Built without memory access counters, rebuild with MEMORY_HEATMAP=1 or 16"); return false);
+    require_or(!_heatmapFile, return false);
+    _heatmapFile = fopen(filename, "wb");
+    require_or(_heatmapFile, log_error("Failed to open %s (%s)", filename, strerror(errno)); return false);
+    _heatmapEveryFrame = everyFrame;
+    return true;
+}
+
+bool
+Emulator::SetCpuBackend(CentralProcessor::backend backend)
+{
+    require_or(_cpu, return false);
+    return _cpu->setBackend(backend);
+}
+
+bool
+Emulator::StreamTrace(const char *filename)
+{
+    require_or(_cpu, return false);
+    return _cpu->streamTrace(filename, kTraceFileRecords);
+}
+
 void 
 Emulator::Run()
 {
-    auto instruction = _cpu->getNextInstruction();
+    if (_idleLoopSkipping && SkipIdleLoop())
+    {
+        return;
+    }
+    if ((_cpu->getBackend() == CentralProcessor::backend::recompiler) && !_cpu->isHalted())
+    {
+        /// Moves the clock as it goes, stopping short of the next event.
+        _cpu->runCompiledBlock(_scheduler);
+        return;
+    }
+    if ((_cpu->getBackend() == CentralProcessor::backend::threaded) && !_cpu->isHalted())
+    {
+        /// Runs up to the next event, moving the clock as it goes.
+        uint64_t budget = std::max<uint64_t>(emu::min(_scheduler.getCyclesUntilEvent(), kMaxIdleMCycles), 1);
+        _cpu->runThreaded(_scheduler, static_cast<uint32_t>(budget));
+        return;
+    }
 
-    uint8_t mCycles = instruction->getCycles();
-    _ppu->mCycleUpdate(mCycles);
-    _timer->mCycleUpdate(mCycles);
-    _memory->mCycleUpdate(mCycles);
+    /// Components only run when one of them has an event due, or the instruction touches their registers.
+    auto instruction = _cpu->getNextInstruction();
+    if (_cpu->isHalted())
+    {
+        /// Only an event can raise an interrupt and wake the CPU, skip straight to the next one.
+        uint64_t mCycles = emu::min(_scheduler.getCyclesUntilEvent(), kMaxIdleMCycles);
+        _scheduler.advance(_cpu->idle(static_cast<uint32_t>(mCycles)));
+        return;
+    }
+    _scheduler.advance(instruction->getCycles());
+    _scheduler.advance(_cpu->executeNextInstruction(instruction));
+}
 
-    mCycles = _cpu->executeNextInstruction(instruction);
-    _ppu->mCycleUpdate(mCycles);
-    _timer->mCycleUpdate(mCycles);
-    _memory->mCycleUpdate(mCycles);
+bool
+Emulator::SkipIdleLoop()
+{
+    uint32_t loopCycles = _cpu->getIdleLoopCycles();
+    require_or(loopCycles, return false);
+    /// The last iteration must have polled after the last event, or the values it read may already be stale.
+    require_or(_scheduler.getCycleCount() - loopCycles >= _scheduler.getLastEventCycle(), return false);
+    /// Whole iterations that finish before the next event, when the polled value may change.
+    uint64_t iterations = emu::min(_scheduler.getCyclesUntilEvent(), kMaxIdleMCycles) / loopCycles;
+    require_or(iterations, return false);
+    uint64_t instructions = _cpu->getInstructionCount();
+    uint64_t mCycles = _cpu->skipIdleLoop(iterations);
+    _scheduler.advance(static_cast<uint32_t>(mCycles));
+    _idleLoopStats.skips++;
+    _idleLoopStats.mCycles += mCycles;
+    _idleLoopStats.instructions += _cpu->getInstructionCount() - instructions;
+    return true;
 }
 
 void
 Emulator::DumpState()
 {
+    _scheduler.synchronize();
     _memory->dumpToFile();
     _cpu->printState(CentralProcessor::printStateOption::compact);
 }
@@ -2,6 +2,7 @@
 #define emu__Emulator_hpp
 
 #include "platform.h"
+#include "Scheduler.hpp"
 
 #include "apu.h"
 #include "cpu.h"
@@ -14,18 +15,71 @@
 namespace emu {
 class Emulator
 {
+private:
+    /// 32MB of trace records
+    static constexpr uint32_t kTraceFileRecords = 1U << 20;
+    /// Longest HALT or idle loop fast-forward, one frame so joypad input and the host loop stay responsive.
+    static constexpr uint32_t kMaxIdleMCycles = 17556;
+
 public:
     enum class Type: uint8_t
     {
         gameboy,
     };
+    struct IdleLoopStats
+    {
+        /// Times a polling loop was fast-forwarded
+        uint64_t skips = 0;
+        /// Guest M-cycles and instructions not executed
+        uint64_t mCycles = 0;
+        uint64_t instructions = 0;
+    };
 public:
     Emulator(Type type);
     ~Emulator();
 
-    bool Activate(const char *gameFile);
+    /**
+     * @brief Load a game and start it with the boot ROM.
+     *
+     * @param[in] bootROMFile nullptr to skip the boot ROM, the game starts at 0x0100 with the state the boot ROM
+     *                        leaves behind (about 5.9 million M-cycles sooner).
+     */
+    bool Activate(const char *gameFile, const char *bootROMFile = kConfigStartupCodeFile);
+    /**
+     * @brief Keep battery-backed cartridge RAM in a save file, written back in the background once per frame.
+     *
+     * @param[in] saveFile nullptr for the game file with a `.sav` extension.
+     */
+    bool LoadSaveFile(const char *saveFile = nullptr);
+    /// @brief Place guest memory in the POSIX shared memory segment `name` for external tools, before `Activate`.
+    bool ShareMemory(const char *name);
+    bool SetCpuBackend(gameboy::CentralProcessor::backend backend);
+    /// @brief Stream executed instructions into a memory mapped file, decoded by `tools/trace_decoder`.
+    bool StreamTrace(const char *filename);
+    /**
+     * @brief Write the memory access heatmap to `filename` and print a summary when the emulator is destroyed.
+     *
+     * Only available when built with `MEMORY_HEATMAP`. Counts run from the start, so with `everyFrame` each frame's
+     * accesses are the difference between its record and the previous one.
+     *
+     * @param[in] everyFrame Append a record at every frame, rather than one for the whole run.
+     */
+    bool RecordHeatmap(const char *filename, bool everyFrame);
     void Run();
     void DumpState();
+    uint64_t GetInstructionCount() const { return _cpu->getInstructionCount(); }
+    uint64_t GetCycleCount() const { return _scheduler.getCycleCount(); }
+    /// @brief Fast-forward guest loops that poll memory until the next event, on by default.
+    void SetIdleLoopSkipping(bool enable) { _idleLoopSkipping = enable; }
+    const IdleLoopStats &GetIdleLoopStats() const { return _idleLoopStats; }
+    /// @brief Run frequent instruction sequences with a single dispatch, on by default.
+    void SetInstructionFusion(bool enable) { _cpu->setInstructionFusion(enable); }
+    /// @brief Draw lines at once unless they need the pixel FIFO, on by default.
+    void SetScanlineRendering(bool enable) { _ppu->setScanlineRendering(enable); }
+    const gameboy::PixelProcessor::lineStats &GetLineStats() const { return _ppu->getLineStats(); }
+
+private:
+    bool SkipIdleLoop();
 
 private:
     std::shared_ptr<gameboy::GameboyMemory>  _memory;
@@ -33,6 +87,13 @@ private:
     std::optional<gameboy::PixelProcessor>   _ppu;
     std::optional<gameboy::Control>          _control;
     std::optional<gameboy::GameboyTimer>     _timer;
+    Scheduler                                _scheduler;
+    std::string                              _gameFile;
+    bool                                     _idleLoopSkipping = true;
+    IdleLoopStats                            _idleLoopStats;
+    uint64_t                                 _frames = 0;
+    FILE *                                   _heatmapFile = nullptr;
+    bool                                     _heatmapEveryFrame = false;
 };
 } // namespace emu
 
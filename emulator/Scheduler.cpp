@@ -0,0 +1,54 @@
+#include "Scheduler.hpp"
+
+using namespace emu;
+
+void
+Scheduler::attach(component id, UpdateFn update, NextEventFn nextEvent)
+{
+    assert(id < component::count);
+    auto &entry = _components[static_cast<size_t>(id)];
+    entry.update = std::move(update);
+    entry.nextEvent = std::move(nextEvent);
+    entry.lastUpdate = _now;
+    _nextEvent = _now;
+}
+
+void
+Scheduler::synchronize(bool reschedule)
+{
+    catchUp();
+    if (reschedule)
+    {
+        _nextEvent = _now;
+    }
+}
+
+void
+Scheduler::catchUp()
+{
+    for (auto &entry: _components)
+    {
+        require_or(entry.update, continue);
+        while (entry.lastUpdate < _now)
+        {
+            uint32_t mCycles = static_cast<uint32_t>(std::min<uint64_t>(_now - entry.lastUpdate, UINT32_MAX));
+            entry.update(mCycles);
+            entry.lastUpdate += mCycles;
+        }
+    }
+}
+
+void
+Scheduler::dispatch()
+{
+    catchUp();
+    _lastEvent = _now;
+    _nextEvent = kNever;
+    for (auto &entry: _components)
+    {
+        require_or(entry.nextEvent, continue);
+        uint64_t cycles = entry.nextEvent();
+        require_or(cycles != kNever, continue);
+        _nextEvent = std::min(_nextEvent, _now + std::max<uint64_t>(cycles, 1));
+    }
+}
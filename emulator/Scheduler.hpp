@@ -0,0 +1,88 @@
+#ifndef emu__Scheduler_hpp
+#define emu__Scheduler_hpp
+
+#include "platform.h"
+
+#include <array>
+#include <functional>
+
+namespace emu {
+/**
+ * @brief Global M-cycle clock that lets components run behind the CPU.
+ *
+ * Each component reports how many M-cycles it can run without the CPU being able to tell, i.e. until it may raise an
+ * interrupt. The CPU runs freely until the earliest of those events, at which point every component catches up to the
+ * clock. Components also catch up whenever the CPU touches memory they own, see `synchronize`.
+ */
+class Scheduler
+{
+public:
+    /// @brief Components catch up in this order.
+    enum class component : uint8_t
+    {
+        ppu,
+        timer,
+        dma,
+        count,
+    };
+    /// @brief Advance a component by some M-cycles.
+    using UpdateFn = std::function<void(uint32_t)>;
+    /// @brief M-cycles until a component's next event, `kNever` if it has nothing scheduled.
+    using NextEventFn = std::function<uint64_t()>;
+
+    static constexpr uint64_t kNever = UINT64_MAX;
+
+public:
+    void attach(component id, UpdateFn update, NextEventFn nextEvent);
+
+    /// @brief Move the clock forward, components only run if an event is due.
+    void advance(uint32_t mCycles)
+    {
+        _now += mCycles;
+        if (expect_false(_now >= _nextEvent))
+        {
+            dispatch();
+        }
+    }
+    /// @brief Move the clock forward only if no event falls due on the way, so no component has to run.
+    bool tryAdvance(uint32_t mCycles)
+    {
+        require_or(_now + mCycles < _nextEvent, return false);
+        _now += mCycles;
+        return true;
+    }
+    /**
+     * @brief Bring every component up to the clock before the CPU accesses their state.
+     *
+     * @param[in] reschedule The access may change when the next event is (i.e. a register write), look it up again on
+     *                       the next `advance`.
+     */
+    void synchronize(bool reschedule = true);
+
+    uint64_t getCycleCount() const { return _now; }
+    /// @brief Clock when components last ran because an event was due, component state may have changed then.
+    uint64_t getLastEventCycle() const { return _lastEvent; }
+    /// @brief M-cycles until the next event is due, 0 if it already is.
+    uint64_t getCyclesUntilEvent() const { return (_nextEvent > _now) ? (_nextEvent - _now) : 0; }
+
+private:
+    void catchUp();
+    void dispatch();
+
+private:
+    struct slot
+    {
+        UpdateFn    update;
+        NextEventFn nextEvent;
+        uint64_t    lastUpdate = 0;
+    };
+
+private:
+    std::array<slot, static_cast<size_t>(component::count)> _components;
+    uint64_t                                                _now = 0;
+    uint64_t                                                _nextEvent = 0;
+    uint64_t                                                _lastEvent = 0;
+};
+} // namespace emu
+
+#endif /* emu__Scheduler_hpp */
@@ -6,6 +6,7 @@
 
 typedef struct apu_struct
 {
+    emu::gameboy::GameboyMemory *memory;
     HAL_Timer *        length_timer;
     // Channel 1 - Pulse with period sweep
     struct
@@ -19,6 +20,7 @@ typedef struct apu_struct
         float             period_step;
         float             volume_gain;
         float             volume_step;
+        emu::gameboy::GameboyMemory::IOHookHandle io_hook;
     } channel1;
     //hal_audio_channel_t channel2_pulse;
     //hal_audio_channel_t channel3_wave;
@@ -108,6 +110,7 @@ void
 apu_create(emu::gameboy::GameboyMemory *memory)
 {
     assert(HAL_AudioDeviceGetState() != HAL_STATE_INACTIVE);
+    apu.memory = memory;
     apu_registers = reinterpret_cast<apu_registers_t>(memory->getIORegisters()->audio);
     apu.length_timer  = HAL_TimerCreate(apu_length_timer, NULL);
 
@@ -117,7 +120,7 @@ apu_create(emu::gameboy::GameboyMemory *memory)
     apu.channel1.device = HAL_AudioChannelOpen(apu.channel1.buffer_size);
     apu.channel1.period_timer = HAL_TimerCreate(apu_channel1_period_timer_callback, NULL);
     apu.channel1.volume_timer = HAL_TimerCreate(apu_channel1_volume_timer_callback, NULL);
-    //memory->registerIOSignaler(apu_process_channel1_update, 0xFF14, UINT16_MAX);
+    apu.channel1.io_hook = memory->registerIOWriteHook(0xFF14, apu_process_channel1_update);
 
     //apu.channel2_pulse  = HAL_AudioChannelOpen(8);
     //apu.channel3_wave   = HAL_AudioChannelOpen(sizeof(apu_channel3_wave_pattern_ram_struct));
@@ -137,7 +140,7 @@ void apu_destroy(void)
     HAL_TimerDestroy(apu.channel1.period_timer);
     HAL_TimerStop(apu.channel1.volume_timer);
     HAL_TimerDestroy(apu.channel1.volume_timer);
-    /// @todo API to clear mmu_memory_watcher
+    apu.memory->deregisterIOHook(apu.channel1.io_hook);
 
     //HAL_AudioChannelClose(apu.channel2_pulse);
     //HAL_AudioChannelClose(apu.channel3_wave);
@@ -145,6 +148,7 @@ void apu_destroy(void)
     HAL_TimerStop(apu.length_timer);
     HAL_TimerDestroy(apu.length_timer);
     apu_registers = NULL;
+    apu.memory = NULL;
 }
 
 void
@@ -4,14 +4,33 @@
 #include "platform.h"
 #include "mmu.h"
 
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <vector>
+
+namespace emu {
+class Scheduler;
+} // namespace emu
+
 namespace emu::gameboy::instruction {
 class instruction;
+template<typename Set, uint16_t Size>
+class InstructionSet;
 class GameboyInstructionSet8bit;
 class GameboyInstructionSet16bit;
 class GameboyInstructionSetStop;
+class GameboyInstructionSetFused;
+class ThreadedInterpreter;
 } // namespace emu::gameboy::instruction
 
+namespace emu::gameboy::jit {
+class BlockCompiler;
+} // namespace emu::gameboy::jit
+
 namespace emu::gameboy {
+class CentralProcessor;
+
 namespace detail::cpu {
 struct flags
 {
@@ -24,6 +43,17 @@ struct flags
 static_assert(sizeof(flags) == 1);
 struct registers
 {
+public:
+    /// @brief Last flag-setting ALU operation, Z/N/H/C are derived from its result when read.
+    enum class flagOperation : uint8_t
+    {
+        none,
+        add,
+        subtract,
+        bitwiseAnd,
+        bitwiseOr,
+    };
+
 public:
     union { struct { uint8_t c; uint8_t b; }; uint16_t bc = 0; };
     union { struct { uint8_t e; uint8_t d; }; uint16_t de = 0; };
@@ -31,57 +61,224 @@ public:
     union { struct { flags   f; uint8_t a; }; uint16_t af = 0; };
     uint16_t stackPointer = 0xFFFE;
     uint16_t programCounter = 0;
+    /// Pending flags, `f` is stale unless the operation is none
+    flagOperation   flagOp = flagOperation::none;
+    /// Operands XOR'd together, bit 4 of this and the result gives the half carry
+    uint8_t         flagOperands = 0;
+    /// Result of the operation, bit 8 holds the carry
+    uint16_t        flagResult = 0;
+    /// Resolve flags after every ALU operation when false
+    bool            lazyFlags = true;
     
     registers(): bc(0), de(0), hl(0), af(0), stackPointer(0xFFFE), programCounter(0) { }
     void setFlags(bool carry, bool halfCarry, bool subtract, bool zero)
     {
+        flagOp = flagOperation::none;
         f.halfCarry = halfCarry;
         f.carry = carry;
         f.subtract = subtract;
         f.zero = zero;
     }
+    /// @brief Record the flags of an ALU operation without computing them.
+    void deferFlags(flagOperation op, uint8_t operands, uint16_t result)
+    {
+        flagOp = op;
+        flagOperands = operands;
+        flagResult = result;
+        if (!lazyFlags)
+        {
+            resolveFlags();
+        }
+    }
+    /// @brief Write any pending flags into `f`.
+    void resolveFlags()
+    {
+        require_or(flagOp != flagOperation::none, return);
+        uint8_t halfCarry = 0;
+        switch (flagOp)
+        {
+        case flagOperation::add:
+        case flagOperation::subtract:
+            halfCarry = ((flagOperands ^ flagResult) >> 4) & 1;
+            break;
+        case flagOperation::bitwiseAnd:
+            halfCarry = 1;
+            break;
+        default:
+            break;
+        }
+        uint8_t carry = (flagResult >> 8) & 1;
+        uint8_t subtract = (flagOp == flagOperation::subtract);
+        uint8_t zero = !(flagResult & 0xFF);
+        af = (af & 0xFF0F) | (zero << 7) | (subtract << 6) | (halfCarry << 5) | (carry << 4);
+        flagOp = flagOperation::none;
+    }
+    flags &getFlags() { resolveFlags(); return f; }
+    uint16_t getAF() { resolveFlags(); return af; }
+    void setAF(uint16_t value) { flagOp = flagOperation::none; af = value; }
+    /// @brief Zero and carry are read by conditional branches, neither needs the flags resolved.
+    bool zero() const { return (flagOp == flagOperation::none) ? f.zero : !(flagResult & 0xFF); }
+    bool carry() const { return (flagOp == flagOperation::none) ? f.carry : ((flagResult >> 8) & 1); }
 };
-class DebugObject
+/// @brief An instruction decoded once, along with its operand and encoded length.
+struct decodedInstruction
+{
+    const ::emu::gameboy::instruction::instruction *descriptor = nullptr;
+    uint16_t address = 0;
+    uint16_t imm = 0;
+    uint8_t  length = 0;
+};
+/// @brief A straight-line run of decoded instructions, ending at the first control flow instruction.
+struct decodedBlock
+{
+    static constexpr size_t kMaxInstructions = 32;
+    uint16_t bank = 0;
+    std::vector<decodedInstruction> instructions;
+    /// Fused sequence starting at each instruction, `descriptor` is null where there is none
+    std::vector<decodedInstruction> fused;
+    /// Handler of each instruction in the threaded interpreter, set the first time it runs the block
+    std::vector<const void *> threaded;
+    /// Native code for the block, set once the recompiler has translated it
+    void (*compiled)(CentralProcessor *, ::emu::Scheduler *) = nullptr;
+    /// Side effect free polling loop that branches back to its own start
+    bool idleLoop = false;
+};
+/// @brief Binary record of one executed instruction, only formatted when printed or decoded offline.
+struct traceRecord
+{
+    /// M-cycle count when the instruction started
+    uint64_t mCycle;
+    /// Address of the instruction, the remaining registers are as they were before it executed
+    uint16_t programCounter;
+    uint16_t stackPointer;
+    uint16_t af;
+    uint16_t bc;
+    uint16_t de;
+    uint16_t hl;
+    uint16_t imm;
+    /// `instruction::instructionSet` and opcode within it, opcode is a `traceEvent` for the none set
+    uint8_t  set;
+    uint8_t  opcode;
+    /// Pending flags, F in `af` is stale unless `flagOp` is none
+    uint16_t flagResult;
+    uint8_t  flagOp;
+    uint8_t  flagOperands;
+    uint8_t  reserved[4];
+};
+static_assert(sizeof(traceRecord) == 32);
+/// @brief CPU events recorded in place of an instruction.
+enum class traceEvent : uint8_t
+{
+    interruptDelay,
+    haltDelay,
+    interrupt,
+};
+/**
+ * @brief Fixed size ring of the most recently executed instructions.
+ * 
+ * Recording copies registers into a preallocated record, nothing is allocated or formatted while running. The ring 
+ * can instead be streamed into a memory mapped file, which `tools/trace_decoder` prints after the fact.
+ */
+class InstructionTrace
 {
-private:
-    static constexpr uint32_t kMaxDebugRecords = 64;
-    
 public:
-    struct Record
+    static constexpr uint32_t kRecords = 64;
+    static constexpr uint64_t kFileMagic = 0x3130454341525447; /// "GTRACE01"
+    /// @brief Header of a trace file, followed by `capacity` records.
+    struct fileHeader
     {
-        char nameBuffer[16];
-        registers registerState;
-        
-        Record(const char *name, registers registerState, std::optional<uint16_t> arg = std::nullopt)
-        {
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wformat-security"
-            (arg == std::nullopt) ? snprintf(nameBuffer, 16, name) : snprintf(nameBuffer, 10, name, *arg);
-            this->registerState = registerState;
-#pragma clang diagnostic pop
-        }
+        uint64_t magic;
+        uint32_t recordSize;
+        uint32_t capacity;
+        /// Total records written, the oldest is at `count - capacity` when the ring has wrapped
+        uint64_t count;
+        uint8_t  reserved[40];
     };
+    static_assert(sizeof(fileHeader) == 64);
 
 public:
-    void insertRecord(const char *name, registers registerState, std::optional<uint16_t> arg = std::nullopt)
+    InstructionTrace() = default;
+    InstructionTrace(const InstructionTrace &) = delete;
+    InstructionTrace &operator=(const InstructionTrace &) = delete;
+    ~InstructionTrace() { stopStreaming(); }
+
+    void record(const registers &reg, uint16_t address, uint8_t set, uint8_t opcode, uint16_t imm, uint64_t mCycle)
     {
-        if (_records.size() == kMaxDebugRecords)
+        auto &entry = _records[(*_count)++ & _mask];
+        entry.mCycle = mCycle;
+        entry.programCounter = address;
+        entry.stackPointer = reg.stackPointer;
+        entry.af = reg.af;
+        entry.bc = reg.bc;
+        entry.de = reg.de;
+        entry.hl = reg.hl;
+        entry.imm = imm;
+        entry.set = set;
+        entry.opcode = opcode;
+        entry.flagResult = reg.flagResult;
+        entry.flagOp = static_cast<uint8_t>(reg.flagOp);
+        entry.flagOperands = reg.flagOperands;
+    }
+
+    /// @brief Write records into a file of `capacity` records (rounded up to a power of 2) instead of memory.
+    bool startStreaming(const char *filename, uint32_t capacity);
+    void stopStreaming();
+    
+    /// @brief Visit at most `limit` of the latest records, oldest first.
+    template<typename Fn>
+    void forEach(uint64_t limit, Fn fn) const
+    {
+        uint64_t count = *_count;
+        uint64_t first = count - std::min({ count, limit, _mask + 1 });
+        for (uint64_t i = first; i < count; i++)
         {
-            _records.pop();
+            fn(_records[i & _mask]);
         }
-        _records.push(std::shared_ptr<Record>(new Record(name, registerState, arg)));
     }
-    
-    std::shared_ptr<Record> getNextRecord()
-    { 
-        require_or(_records.size() > 0, return nullptr);
-        auto retval = _records.front();
-        _records.pop();
-        return retval;
+
+    static void print(const traceRecord &record, bool full);
+    /// @brief Descriptor of a recorded instruction, nullptr for interrupts and other events.
+    static const ::emu::gameboy::instruction::instruction *getInstruction(const traceRecord &record);
+
+private:
+    std::array<traceRecord, kRecords>   _buffer = {};
+    uint64_t                            _bufferCount = 0;
+    traceRecord *                       _records = _buffer.data();
+    uint64_t *                          _count = &_bufferCount;
+    uint64_t                            _mask = kRecords - 1;
+    fileHeader *                        _file = nullptr;
+    size_t                              _fileSize = 0;
+};
+/// @brief A file streamed by `InstructionTrace`, mapped read only for the tools that inspect it.
+class TraceFile
+{
+public:
+    TraceFile() = default;
+    TraceFile(const TraceFile &) = delete;
+    TraceFile &operator=(const TraceFile &) = delete;
+    ~TraceFile() { close(); }
+
+    /// @brief Map and validate `filename`, logs why on failure.
+    bool open(const char *filename);
+    void close();
+
+    /// @brief Visit at most `limit` of the latest records, oldest first.
+    template<typename Fn>
+    void forEach(uint64_t limit, Fn fn) const
+    {
+        require_or(_header, return);
+        auto records = reinterpret_cast<const traceRecord *>(_header + 1);
+        uint64_t count = _header->count;
+        uint64_t first = count - std::min({ count, limit, static_cast<uint64_t>(_header->capacity) });
+        for (uint64_t i = first; i < count; i++)
+        {
+            fn(records[i & (_header->capacity - 1)]);
+        }
     }
 
 private:
-    std::queue<std::shared_ptr<Record>> _records;
+    const InstructionTrace::fileHeader *    _header = nullptr;
+    size_t                                  _size = 0;
 };
 }
 
@@ -89,12 +286,11 @@ class CentralProcessor
 {
 public:
     using registers = detail::cpu::registers;
-    using DebugObject = detail::cpu::DebugObject;
-
-private:
-    using GameboyInstructionSet8bit = instruction::GameboyInstructionSet8bit;
-    using GameboyInstructionSet16bit = instruction::GameboyInstructionSet16bit;
-    using GameboyInstructionSetStop = instruction::GameboyInstructionSetStop;
+    using InstructionTrace = detail::cpu::InstructionTrace;
+    using decodedInstruction = detail::cpu::decodedInstruction;
+    using decodedBlock = detail::cpu::decodedBlock;
+    /// @brief Move the system clock by some M-cycles, false if a component has an event due before then.
+    using ClockFn = std::function<bool(uint8_t)>;
 
 private:
     static constexpr uint8_t kInterruptMCycles = 5;
@@ -113,21 +309,79 @@ public:
         compact,
         full,
     };
+    enum class backend : uint8_t
+    {
+        /// @brief Decode and execute one instruction per `Emulator::Run`.
+        interpreter,
+        /// @brief Translate blocks to native code, execute one block per `Emulator::Run`.
+        recompiler,
+        /// @brief Dispatch through computed gotos, execute until the next event per `Emulator::Run`.
+        threaded,
+    };
 
 public:
     CentralProcessor(std::shared_ptr<GameboyMemory> memory);
     ~CentralProcessor();
 
     void reset();
+    /// @brief Registers as the DMG boot ROM leaves them when it jumps to the cartridge (0x0100).
+    void resetPostBoot();
     void wake(); 
 
     void printInstructions();
     void printState(printStateOption opt);
+    bool streamTrace(const char *filename, uint32_t records);
+
+    bool setBackend(backend newBackend);
+    backend getBackend() const { return _backend; }
 
     const ::emu::gameboy::instruction::instruction *getNextInstruction();
     uint8_t executeNextInstruction(const ::emu::gameboy::instruction::instruction *instruction);
+    /**
+     * @brief Run the compiled block at the program counter, moving the clock ahead of its instructions.
+     *
+     * A block stops short of an instruction an event is due before, the interpreter runs the rest of it one
+     * instruction at a time so the event lands between the same two instructions. Interrupts, halt and code outside of
+     * the block cache are left to the interpreter too.
+     * @returns The M-cycles run.
+     */
+    uint32_t runCompiledBlock(::emu::Scheduler &scheduler);
+    /**
+     * @brief Run instructions back to back until `budget` M-cycles have passed, moving the clock for each one.
+     *
+     * Stops early at a halt, or when looping back to an idle loop, so `Emulator::Run` can fast-forward either.
+     * @returns The M-cycles run.
+     */
+    uint32_t runThreaded(::emu::Scheduler &scheduler, uint32_t budget);
+    /**
+     * @brief Stay halted for several M-cycles at once, in place of a `kHaltDelay` per M-cycle.
+     *
+     * Only valid when `getNextInstruction` left the CPU halted, i.e. nothing can wake it before `mCycles` have passed.
+     * @returns The M-cycles spent halted.
+     */
+    uint32_t idle(uint32_t mCycles);
+    /**
+     * @brief M-cycles of one iteration if the CPU just looped back to the start of a side effect free polling loop.
+     *
+     * Running the loop again leaves the CPU as it is until a value it polls changes, which only happens on a
+     * scheduler event. Returns 0 if the CPU is not in such a loop, or it polls a register that changes by itself.
+     */
+    uint32_t getIdleLoopCycles() const;
+    /// @brief Account for `iterations` of the current polling loop without running them, returns the M-cycles skipped.
+    uint64_t skipIdleLoop(uint64_t iterations);
     void dotCycleUpdate();
     
+    uint64_t getInstructionCount() const { return _instructionCount; }
+    bool isHalted() const { return _halt; }
+    void setLazyFlags(bool enable);
+    /// @brief Run frequent instruction sequences with a single dispatch, on by default.
+    void setInstructionFusion(bool enable) { _fusion = enable; }
+    /**
+     * @brief Lets a fused sequence move the clock to each of its instructions, so every instruction still sees the
+     *        system as it would when run on its own.
+     */
+    void setClockCallback(ClockFn callback) { _clock = std::move(callback); }
+    
     registers& getRegisters() { return _registers; }
     void setInterruptState(interruptState newState) { _interruptState = newState; }
     
@@ -140,73 +394,82 @@ public:
 
 private:
     bool checkForInterrupt();
-    uint8_t readProgramCounter() { return _memory->read(_registers.programCounter++); }
+    bool continueFused(uint8_t mCycles);
+    
+    const decodedInstruction *fetchInstruction();
+    decodedBlock *enterBlock(uint16_t address);
+    decodedBlock *lookupBlock(uint16_t address);
+    bool decodeInstruction(uint16_t address, decodedInstruction &decoded) const;
+    decodedBlock *decodeBlock(uint16_t bank, uint16_t address);
+    void invalidateCodePage(uint8_t page);
     
 private:
     std::shared_ptr<GameboyMemory>      _memory;
-    /// @todo Need to update instruction set
-    const GameboyInstructionSet8bit *   _instructions8bit = nullptr;
-    const GameboyInstructionSet16bit *  _instructions16bit = nullptr;
-    const GameboyInstructionSetStop *   _stopInstruction = nullptr;
     registers                           _registers;
     uint64_t                            _mCycleCount = 0;
+    uint64_t                            _instructionCount = 0;
     interruptState                      _interruptState = interruptState::disabled;
     uint8_t                             _branchPenalty = 0;
+    bool                                _fusion = true;
     bool                                _halt = false;
     bool                                _power = true;
-    DebugObject                         _debugOject;
+    InstructionTrace                    _trace;
+    /// Direct mapped by start address, each block is tagged with the bank it was decoded from
+    std::vector<std::unique_ptr<decodedBlock>>      _blockCache;
+    std::array<std::vector<uint16_t>, 0x100>        _blocksByPage;
+    decodedBlock *                                  _block = nullptr;
+    size_t                                          _blockIndex = 0;
+    uint64_t                                        _blockStartCycle = 0;
+    decodedInstruction                              _uncachedInstruction;
+    uint16_t                                        _operand = 0;
+    backend                                         _backend = backend::interpreter;
+    std::unique_ptr<jit::BlockCompiler>             _compiler;
+    ClockFn                                         _clock;
     
+    template<typename Set, uint16_t Size>
+    friend class instruction::InstructionSet;
     friend class instruction::GameboyInstructionSet8bit;
     friend class instruction::GameboyInstructionSet16bit;
     friend class instruction::GameboyInstructionSetStop;
+    friend class instruction::GameboyInstructionSetFused;
+    friend class instruction::ThreadedInterpreter;
+    friend class jit::BlockCompiler;
 };
 
 namespace instruction {
-class instruction
+/// @brief Which instruction set an instruction is dispatched through.
+enum class instructionSet : uint8_t
 {
-private:
-    using action_t = void (*)(CentralProcessor&, std::optional<uint16_t>);
+    none,
+    set8bit,
+    set16bit,
+    stop,
+    /// Several 8-bit instructions run with one dispatch
+    fused,
+};
 
+/// @brief Compile-time description of an instruction, the action is bound by `(set, opcode)`.
+class instruction
+{
 public:
-    instruction(): _name(nullptr), _action(nullptr), _cycles(0), _immSize(0) { }
-    instruction(const char *name, action_t action, uint8_t cycles): 
+    constexpr instruction() { }
+    constexpr instruction(const char *name, instructionSet set, uint8_t opcode, uint8_t cycles, uint8_t immSize = 0): 
         _name(name), 
-        _action(action), 
-        _cycles(cycles),
-        _immSize(0) 
-    { }
-    instruction(const char *name, action_t action, uint8_t cycles, uint8_t immSize): 
-        _name(name), 
-        _action(action), 
+        _set(set), 
+        _opcode(opcode), 
         _cycles(cycles), 
         _immSize(immSize) 
     { }
 
-    uint8_t invoke(CentralProcessor& cpu, std::optional<uint16_t> imm) const
-    {
-        cpu.setBranchPenalty(0);
-        switch (_immSize)
-        {
-        case 0:
-            _action(cpu, std::nullopt);
-            break;
-        case 1:
-            assert((*imm & 0xFF00) == 0);
-        case 2:
-            _action(cpu, imm);
-            break;
-        default:
-            assert(_immSize);
-        }
-        return _cycles;
-    }
-    const char *getName() const { return _name; }
-    uint8_t getCycles() const { return _cycles; }
-    uint8_t getImmediateSize() const { return _immSize;}
+    constexpr const char *getName() const { return _name; }
+    constexpr instructionSet getSet() const { return _set; }
+    constexpr uint8_t getOpcode() const { return _opcode; }
+    constexpr uint8_t getCycles() const { return _cycles; }
+    constexpr uint8_t getImmediateSize() const { return _immSize;}
 
     void print(uint8_t opcode) const 
     {
-        require_or(_action, printf("0x%x\t%s\n", opcode, "Not implemented"); return);
+        require_or(_name, printf("0x%x\t%s\n", opcode, "Not implemented"); return);
         char sep[3] = "\t\t";
         if (strlen(_name) >= 8)
         {
@@ -216,11 +479,11 @@ public:
     }
 
 private:
-    const char *_name = nullptr;
-    action_t    _action = nullptr;
-    uint8_t     _cycles = 0;
-    uint8_t     _immSize = 0;
-    uint8_t     _branchPenalty = 0;
+    const char *    _name = nullptr;
+    instructionSet  _set = instructionSet::none;
+    uint8_t         _opcode = 0;
+    uint8_t         _cycles = 0;
+    uint8_t         _immSize = 0;
 };
 } // namespace instruction
 } // namespace emu::gameboy
@@ -1,24 +1,137 @@
 #include "cpu.h"
 #include "cpu_instr.h"
+#include "cpu_jit.h"
+#include "Scheduler.hpp"
+
+#include <algorithm>
 
 using namespace emu::gameboy;
 using namespace emu::gameboy::instruction;
 
-static auto kIntDelay = ::emu::gameboy::instruction::instruction("INT", [](__unused CentralProcessor &, __unused std::optional<uint16_t>) { }, 5);
-static auto kHaltDelay = ::emu::gameboy::instruction::instruction("HDEL", [](__unused CentralProcessor &, __unused std::optional<uint16_t>) { }, 1);
+using detail::cpu::traceEvent;
+
+static constexpr auto kIntDelay = ::emu::gameboy::instruction::instruction("INT", instructionSet::none, 
+                                                                            static_cast<uint8_t>(traceEvent::interruptDelay), 5);
+static constexpr auto kHaltDelay = ::emu::gameboy::instruction::instruction("HDEL", instructionSet::none, 
+                                                                             static_cast<uint8_t>(traceEvent::haltDelay), 1);
+
+/// @brief 8-bit opcodes that may change the program counter, stop the CPU or enable interrupts, these end a 
+///        decoded block.
+static constexpr auto kBlockTerminators = []() {
+    std::array<bool, GameboyInstructionSet8bit::kInstructionArraySize> terminators = {};
+    for (uint8_t opcode: { 0x18, 0x20, 0x28, 0x30, 0x38, 0x76, 0xC0, 0xC2, 0xC3, 0xC4, 0xC7, 0xC8, 0xC9, 0xCA, 
+                           0xCC, 0xCD, 0xCF, 0xD0, 0xD2, 0xD4, 0xD7, 0xD8, 0xD9, 0xDA, 0xDC, 0xDF, 0xE7, 0xE9, 
+                           0xEF, 0xF7, 0xFB, 0xFF })
+    {
+        terminators[opcode] = true;
+    }
+    return terminators;
+}();
+
+/// @brief Direct writes to IE/IF may raise an interrupt, these also end a decoded block.
+static constexpr bool
+writesInterruptRegisters(const CentralProcessor::decodedInstruction &decoded)
+{
+    auto descriptor = decoded.descriptor;
+    require_or(descriptor->getSet() == instructionSet::set8bit, return false);
+    switch (descriptor->getOpcode())
+    {
+    case 0xE0:
+        return decoded.imm == 0x0F || decoded.imm == 0xFF;
+    case 0xEA:
+        return decoded.imm == 0xFF0F || decoded.imm == 0xFFFF;
+    default:
+        return false;
+    }
+}
+
+/**
+ * @brief A block is an idle loop if its last instruction branches back to its start, and it only loads A from memory,
+ *        tests A or memory, and branches on the result.
+ *
+ * A is loaded before anything reads it, so every iteration computes the same registers and flags from the same
+ * memory. The flags a branch reads are either set by the loop or never changed by it.
+ */
+static bool
+isIdleLoop(const CentralProcessor::decodedBlock &block)
+{
+    const uint16_t start = block.instructions.front().address;
+    bool loadedA = false;
+    for (auto &decoded: block.instructions)
+    {
+        auto set = decoded.descriptor->getSet();
+        uint8_t opcode = decoded.descriptor->getOpcode();
+        uint16_t next = decoded.address + decoded.length;
+        uint16_t relative = next + static_cast<int8_t>(decoded.imm);
+        if (&decoded == &block.instructions.back())
+        {
+            require_or(set == instructionSet::set8bit, return false);
+            switch (opcode)
+            {
+            /// JR e, JR cc,e
+            case 0x18: case 0x20: case 0x28: case 0x30: case 0x38:
+                return relative == start;
+            /// JP nn, JP cc,nn
+            case 0xC2: case 0xC3: case 0xCA: case 0xD2: case 0xDA:
+                return decoded.imm == start;
+            default:
+                return false;
+            }
+        }
+        if (set == instructionSet::set16bit)
+        {
+            /// BIT b,(HL) and BIT b,A
+            require_or(emu::in_range(opcode, 0x40, 0x80), return false);
+            require_or(((opcode & 0x7) == 6) || (((opcode & 0x7) == 7) && loadedA), return false);
+            continue;
+        }
+        require_or(set == instructionSet::set8bit, return false);
+        switch (opcode)
+        {
+        /// NOP
+        case 0x00:
+            break;
+        /// LD A,(BC), LD A,(DE), LD A,(HL), LDH A,(n), LDH A,(C), LD A,(nn)
+        case 0x0A: case 0x1A: case 0x7E: case 0xF0: case 0xF2: case 0xFA:
+            loadedA = true;
+            break;
+        /// AND A, OR A, CP A, AND n, XOR n, OR n, CP n
+        case 0xA7: case 0xB7: case 0xBF: case 0xE6: case 0xEE: case 0xF6: case 0xFE:
+            require_or(loadedA, return false);
+            break;
+        default:
+            return false;
+        }
+    }
+    return false;
+}
+
+/// @brief Memory only written by the CPU or DMA, IF, and LY only change on a scheduler event. Other IO registers
+///        change between events, or have side effects when read.
+static constexpr bool
+isPollable(uint16_t address)
+{
+    return !emu::in_range(address, 0xFF00, 0xFF80) || address == 0xFF0F || address == 0xFF44;
+}
+
+/// @brief Only memory that changes through `GameboyMemory::write` can be cached, OAM and IO are excluded.
+static constexpr bool
+isCacheable(uint16_t address)
+{
+    return address < 0xFE00 || emu::in_range(address, 0xFF80, 0xFFFF);
+}
 
-CentralProcessor::CentralProcessor(std::shared_ptr<GameboyMemory> memory): _memory(memory)
+CentralProcessor::CentralProcessor(std::shared_ptr<GameboyMemory> memory): _memory(memory), _blockCache(kMemoryMapSize)
 {
-    _instructions8bit = new GameboyInstructionSet8bit;
-    _instructions16bit = new GameboyInstructionSet16bit;
-    _stopInstruction = new GameboyInstructionSetStop;
+    _memory->setCodeWriteCallback([this](uint8_t page) { invalidateCodePage(page); });
+    /// Blocks of the old bank stay cached, but the one running may not be what is mapped now.
+    _memory->setBankSwitchCallback([this]() { _block = nullptr; });
 }
 
 CentralProcessor::~CentralProcessor()
-{ 
-    delete _instructions8bit;
-    delete _instructions16bit;
-    delete _stopInstruction;
+{
+    _memory->setCodeWriteCallback(nullptr);
+    _memory->setBankSwitchCallback(nullptr);
 }
 
 void 
@@ -27,110 +140,381 @@ CentralProcessor::reset()
     _registers.bc = 0;
     _registers.de = 0;
     _registers.hl = 0;
-    _registers.af = 0;
+    _registers.setAF(0);
     _registers.stackPointer = 0xFFFE;
     _registers.programCounter = 0;
 }
 
+void
+CentralProcessor::resetPostBoot()
+{
+    _registers.bc = 0x0013;
+    _registers.de = 0x00D8;
+    _registers.hl = 0x014D;
+    /// Z, H and C set.
+    _registers.setAF(0x01B0);
+    _registers.stackPointer = 0xFFFE;
+    _registers.programCounter = 0x0100;
+    _block = nullptr;
+}
+
 void
 CentralProcessor::wake()
 {
     _power = true;
 }
 
-void
-CentralProcessor::printInstructions()
+bool
+CentralProcessor::setBackend(backend newBackend)
 {
-    if (_instructions8bit)
+    if (newBackend == backend::recompiler && !_compiler)
     {
-        _instructions8bit->printAll();
+        require_or(jit::BlockCompiler::isSupported(), log_error("Recompiler is not supported on this host!"); return false);
+        _compiler.reset(new jit::BlockCompiler(*this));
+        require_or(_compiler->isValid(), _compiler.reset(); return false);
     }
-    if (_instructions16bit)
+    require_or(newBackend != backend::threaded || ThreadedInterpreter::isSupported(), 
+               log_error("Threaded interpreter is not supported by this compiler!"); return false);
+    _backend = newBackend;
+    _block = nullptr;
+    return true;
+}
+
+void
+CentralProcessor::setLazyFlags(bool enable)
+{
+    _registers.lazyFlags = enable;
+    _registers.resolveFlags();
+}
+
+void
+CentralProcessor::printInstructions()
+{
+    GameboyInstructionSet8bit::printAll();
+    GameboyInstructionSet16bit::printAll();
+    GameboyInstructionSetStop::printAll();
+}
+
+void 
+CentralProcessor::printState(CentralProcessor::printStateOption opt)
+{
+    require_or(opt != printStateOption::none, return);
+    _trace.forEach(InstructionTrace::kRecords, [opt](const detail::cpu::traceRecord &record) {
+        InstructionTrace::print(record, opt == printStateOption::full);
+    });
+}
+
+bool
+CentralProcessor::streamTrace(const char *filename, uint32_t records)
+{
+    return _trace.startStreaming(filename, records);
+}
+
+const ::emu::gameboy::instruction::instruction *
+CentralProcessor::getNextInstruction()
+{
+    require_or(!checkForInterrupt(), return &kIntDelay);
+    require_or(_halt == false, return &kHaltDelay);
+    auto decoded = fetchInstruction();
+    _registers.programCounter += decoded->length;
+    _operand = decoded->imm;
+    return decoded->descriptor;
+}
+
+uint32_t
+CentralProcessor::runCompiledBlock(::emu::Scheduler &scheduler)
+{
+    assert(_compiler);
+    uint64_t start = scheduler.getCycleCount();
+    const ::emu::gameboy::instruction::instruction *instruction = checkForInterrupt() ? &kIntDelay : nullptr;
+    uint16_t address = _registers.programCounter;
+    bool inBlock = _block && (_blockIndex < _block->instructions.size()) &&
+                   (_block->instructions[_blockIndex].address == address);
+    if (!instruction && !_halt && !inBlock && isCacheable(address) && !_memory->isBusLocked(address >> 8))
     {
-        _instructions16bit->printAll();
+        auto block = lookupBlock(address);
+        if (block->compiled == nullptr)
+        {
+            block->compiled = _compiler->compile(*block);
+        }
+        if (block->compiled == nullptr)
+        {
+            /// Code cache is full, start over.
+            _compiler->flush();
+            for (auto &cached: _blockCache)
+            {
+                require_or(cached, continue);
+                cached->compiled = nullptr;
+            }
+            block->compiled = _compiler->compile(*block);
+            assert(block->compiled);
+        }
+        _block = block;
+        _blockStartCycle = _mCycleCount;
+        _branchPenalty = 0;
+        uint64_t instructions = _instructionCount;
+        block->compiled(this, &scheduler);
+        /// The block may be invalidated while it runs, then `_block` is null and the block mustn't be touched.
+        /// Otherwise the interpreter picks up where it stopped.
+        _blockIndex = _instructionCount - instructions;
+        if (_blockIndex > 0)
+        {
+            _mCycleCount += _branchPenalty;
+            scheduler.advance(_branchPenalty);
+            return static_cast<uint32_t>(scheduler.getCycleCount() - start);
+        }
+        /// An event is due before the first instruction.
     }
-    if (_stopInstruction)
+    if (instruction == nullptr)
     {
-        _stopInstruction->printAll();
+        instruction = getNextInstruction();
     }
+    scheduler.advance(instruction->getCycles());
+    scheduler.advance(executeNextInstruction(instruction));
+    return static_cast<uint32_t>(scheduler.getCycleCount() - start);
 }
 
-void 
-CentralProcessor::printState(CentralProcessor::printStateOption opt)
+uint32_t
+CentralProcessor::runThreaded(::emu::Scheduler &scheduler, uint32_t budget)
+{
+    assert(_backend == backend::threaded && budget);
+    return ThreadedInterpreter::run(*this, scheduler, budget);
+}
+
+uint8_t 
+CentralProcessor::executeNextInstruction(const ::emu::gameboy::instruction::instruction *instruction)
 {
-    std::function<void (std::shared_ptr<DebugObject::Record>)> printFn; 
-    switch (opt)
+    _branchPenalty = 0;
+    _instructionCount++;
+    /// Each set dispatches on the opcode through a switch, the operand was decoded with the instruction.
+    switch (instruction->getSet())
     {
-    case printStateOption::none:
-        printFn = [](__unused std::shared_ptr<DebugObject::Record>){};
+    case instructionSet::set8bit:
+        GameboyInstructionSet8bit::execute(*this, instruction->getOpcode(), _operand);
         break;
-    case printStateOption::compact:
-        printFn = [](std::shared_ptr<DebugObject::Record> obj) { 
-            printf("0x%04x:  %s \n", obj->registerState.programCounter, obj->nameBuffer); 
-        };
+    case instructionSet::set16bit:
+        GameboyInstructionSet16bit::execute(*this, instruction->getOpcode(), _operand);
         break;
-    case printStateOption::full:
-        printFn = [](std::shared_ptr<DebugObject::Record> obj) {
-            auto &reg = obj->registerState;
-            printf("%s:\n", obj->nameBuffer);
-            printf("\tProgram Counter = 0x%X, Stack Pointer = 0x%X\n"
-                   "\tRegister b = 0x%X, Register c = 0x%X\n"
-                   "\tRegister d = 0x%X, Register e = 0x%X\n"
-                   "\tRegister h = 0x%X, Register h = 0x%X\n"
-                   "\tRegister a = 0x%X, fZero %u, fSubtract %u, fCarry %u, fHalfCarry %u\n",
-                   reg.programCounter, reg.stackPointer, reg.b, reg.c, reg.d, reg.e, reg.h, reg.l,
-                   reg.a, reg.f.zero, reg.f.subtract, reg.f.carry, reg.f.halfCarry);
-        };
+    case instructionSet::stop:
+        GameboyInstructionSetStop::execute(*this, instruction->getOpcode(), _operand);
+        break;
+    case instructionSet::fused:
+        /// Each instruction of the sequence accounts for its own M-cycles, only the last may branch.
+        GameboyInstructionSetFused::execute(*this, instruction->getOpcode());
+        _mCycleCount += _branchPenalty;
+        return _branchPenalty;
+    case instructionSet::none:
+        _trace.record(_registers, _registers.programCounter, static_cast<uint8_t>(instructionSet::none), 
+                      instruction->getOpcode(), 0, _mCycleCount);
         break;
     }
-    while (auto obj = _debugOject.getNextRecord())
+    _mCycleCount += instruction->getCycles() + _branchPenalty;
+    return _branchPenalty;
+}
+
+uint32_t
+CentralProcessor::getIdleLoopCycles() const
+{
+    require_or(_block && _block->idleLoop && _blockIndex == _block->instructions.size(), return 0);
+    require_or(_registers.programCounter == _block->instructions.front().address, return 0);
+    /// A pending interrupt is taken before the loop runs again.
+    require_or(_interruptState != interruptState::enabled ||
+               (_memory->getInterruptEnable()->value & _memory->getIORegisters()->interruptFlag) == 0, return 0);
+    for (auto &decoded: _block->instructions)
     {
-        printFn(obj);
+        std::optional<uint16_t> address;
+        uint8_t opcode = decoded.descriptor->getOpcode();
+        if (decoded.descriptor->getSet() == instructionSet::set16bit)
+        {
+            /// BIT b,(HL)
+            address = ((opcode & 0x7) == 6) ? std::optional<uint16_t>(_registers.hl) : std::nullopt;
+        }
+        else
+        {
+            switch (opcode)
+            {
+            case 0x0A:
+                address = _registers.bc;
+                break;
+            case 0x1A:
+                address = _registers.de;
+                break;
+            case 0x7E:
+                address = _registers.hl;
+                break;
+            case 0xF0:
+                address = 0xFF00 | static_cast<uint8_t>(decoded.imm);
+                break;
+            case 0xF2:
+                address = 0xFF00 | _registers.c;
+                break;
+            case 0xFA:
+                address = decoded.imm;
+                break;
+            }
+        }
+        require_or(!address || isPollable(*address), return 0);
     }
+    return static_cast<uint32_t>(_mCycleCount - _blockStartCycle);
 }
 
-const ::emu::gameboy::instruction::instruction *
-CentralProcessor::getNextInstruction()
+uint64_t
+CentralProcessor::skipIdleLoop(uint64_t iterations)
 {
-    require_or(!checkForInterrupt(), return &kIntDelay);
-    require_or(_halt == false, return &kHaltDelay);
-    /// Get next opcode from program counter.
-    /// If the instruction at the program counter, this is opcode, otherwise prefix code.
-    uint8_t opcodeOrPrefix = readProgramCounter();
+    assert(getIdleLoopCycles());
+    uint64_t mCycles = iterations * (_mCycleCount - _blockStartCycle);
+    _instructionCount += iterations * _block->instructions.size();
+    _mCycleCount += mCycles;
+    _blockStartCycle += mCycles;
+    return mCycles;
+}
+
+uint32_t
+CentralProcessor::idle(uint32_t mCycles)
+{
+    assert(_halt);
+    mCycles = std::max<uint32_t>(mCycles, kHaltMCycles);
+    /// One trace record and instruction for the whole stretch.
+    executeNextInstruction(&kHaltDelay);
+    _mCycleCount += mCycles - kHaltMCycles;
+    return mCycles;
+}
+
+const CentralProcessor::decodedInstruction *
+CentralProcessor::fetchInstruction()
+{
+    uint16_t address = _registers.programCounter;
+    /// Fast path, continue through the current block.
+    if (!_block || _blockIndex >= _block->instructions.size() || _block->instructions[_blockIndex].address != address)
+    {
+        require_or(enterBlock(address), return &_uncachedInstruction);
+    }
+    auto &fused = _block->fused[_blockIndex];
+    if (_fusion && fused.descriptor)
+    {
+        _blockIndex += GameboyInstructionSetFused::getLength(fused.descriptor->getOpcode());
+        return &fused;
+    }
+    return &_block->instructions[_blockIndex++];
+}
+
+/// @brief Start running the block at `address`, nullptr if the address can't be cached and was decoded into 
+///        `_uncachedInstruction` instead.
+CentralProcessor::decodedBlock *
+CentralProcessor::enterBlock(uint16_t address)
+{
+    /// While OAM DMA locks the bus the CPU fetches 0xFF, which must not be cached in place of the code.
+    if (!isCacheable(address) || _memory->isBusLocked(address >> 8))
+    {
+        _block = nullptr;
+        decodeInstruction(address, _uncachedInstruction);
+        return nullptr;
+    }
+    auto block = lookupBlock(address);
+    _block = block;
+    _blockIndex = 0;
+    _blockStartCycle = _mCycleCount;
+    return block;
+}
+
+CentralProcessor::decodedBlock *
+CentralProcessor::lookupBlock(uint16_t address)
+{
+    uint16_t bank = _memory->getBankNumber(address);
+    auto &cached = _blockCache[address];
+    return (cached && cached->bank == bank) ? cached.get() : decodeBlock(bank, address);
+}
+
+bool
+CentralProcessor::decodeInstruction(uint16_t address, decodedInstruction &decoded) const
+{
+    /// If the instruction at the address is not a prefix code, this is the opcode.
+    uint8_t opcodeOrPrefix = _memory->read(address);
+    decoded.address = address;
+    decoded.length = sizeof(uint8_t);
     switch (opcodeOrPrefix)
     {
     case GameboyInstructionSet16bit::kInstructionSetCode:
-        return _instructions16bit->getInstruction(readProgramCounter());
+        decoded.descriptor = GameboyInstructionSet16bit::getInstruction(_memory->read(address + 1));
+        decoded.length++;
+        break;
     case GameboyInstructionSetStop::kInstructionSetCode:
-        return _stopInstruction->getInstruction(readProgramCounter());
+        /// STOP is always followed by a byte which is ignored.
+        decoded.descriptor = GameboyInstructionSetStop::getInstruction(0);
+        decoded.length++;
+        break;
     default:
-        assert(static_cast<uint16_t>(opcodeOrPrefix) < GameboyInstructionSet8bit::kInstructionArraySize);
-        return _instructions8bit->getInstruction(opcodeOrPrefix);
+        decoded.descriptor = GameboyInstructionSet8bit::getInstruction(opcodeOrPrefix);
+        break;
     }
+    /// Get operand following the opcode.
+    decoded.imm = 0;
+    if (decoded.descriptor->getImmediateSize() >= sizeof(uint8_t))
+    {
+        decoded.imm = _memory->read(address + decoded.length);
+    }
+    if (decoded.descriptor->getImmediateSize() == sizeof(uint16_t))
+    {
+        decoded.imm |= (static_cast<uint16_t>(_memory->read(address + decoded.length + 1)) << 8);
+    }
+    decoded.length += decoded.descriptor->getImmediateSize();
+    return decoded.descriptor->getName() != nullptr;
 }
 
-uint8_t 
-CentralProcessor::executeNextInstruction(const ::emu::gameboy::instruction::instruction *instruction)
+CentralProcessor::decodedBlock *
+CentralProcessor::decodeBlock(uint16_t bank, uint16_t address)
 {
-    /// Get operand from program counter.
-    std::optional<uint16_t> operand;
-    if (instruction->getImmediateSize() >= sizeof(uint8_t))
+    uint16_t start = address;
+    auto &block = _blockCache[start];
+    block.reset(new decodedBlock);
+    block->bank = bank;
+    decodedInstruction decoded;
+    /// The first instruction is always executed, so it is decoded even if invalid.
+    bool valid = decodeInstruction(address, decoded);
+    while (true)
     {
-        operand.emplace(static_cast<uint16_t>(readProgramCounter()));
+        block->instructions.push_back(decoded);
+        /// Watch every page the instruction is encoded in.
+        for (uint32_t page = address >> 8; page <= (address + decoded.length - 1U) >> 8; page++)
+        {
+            auto &starts = _blocksByPage[page & 0xFF];
+            if (std::find(starts.begin(), starts.end(), start) == starts.end())
+            {
+                starts.push_back(start);
+            }
+            _memory->watchCodePage(page & 0xFF);
+        }
+        uint32_t next = address + decoded.length;
+        require_or(valid, break);
+        require_or(block->instructions.size() < decodedBlock::kMaxInstructions, break);
+        require_or(decoded.descriptor->getSet() != instructionSet::stop, break);
+        require_or(decoded.descriptor->getSet() != instructionSet::set8bit || 
+                   !kBlockTerminators[decoded.descriptor->getOpcode()], break);
+        require_or(!writesInterruptRegisters(decoded), break);
+        /// Don't run past the end of memory, or across a 16KB bank boundary.
+        require_or(next < kMemoryMapSize && ((next ^ address) & 0xC000) == 0 && isCacheable(next), break);
+        address = static_cast<uint16_t>(next);
+        require_or(decodeInstruction(address, decoded), break);
     }
-    if (instruction->getImmediateSize() == sizeof(uint16_t))
+    block->idleLoop = isIdleLoop(*block);
+    size_t count = block->instructions.size();
+    block->fused.resize(count);
+    for (size_t i = 0; i < count; i++)
     {
-        *operand |= (static_cast<uint16_t>(readProgramCounter()) << 8);
+        GameboyInstructionSetFused::fuse(&block->instructions[i], count - i, block->fused[i]);
     }
-    
-    if (_registers.programCounter == 50123)
+    return block.get();
+}
+
+void
+CentralProcessor::invalidateCodePage(uint8_t page)
+{
+    for (auto start: _blocksByPage[page])
     {
-        log_error();
+        _blockCache[start].reset();
     }
-
-    _debugOject.insertRecord(instruction->getName(), _registers, operand);
-    instruction->invoke(*this, operand);
-    return _branchPenalty;
+    _blocksByPage[page].clear();
+    _block = nullptr;
 }
 
 bool
@@ -163,7 +547,26 @@ CentralProcessor::checkForInterrupt()
     // execute `call <vector>`
     pushToStack(_registers.programCounter);
     _registers.programCounter = interrupt_vector;
-    _debugOject.insertRecord("INT", _registers);
+    _trace.record(_registers, _registers.programCounter, static_cast<uint8_t>(instructionSet::none), 
+                  static_cast<uint8_t>(traceEvent::interrupt), interrupt_vector, _mCycleCount);
+    return true;
+}
+
+/**
+ * @brief Whether a fused sequence can go on to its next instruction, which takes `mCycles` before it executes.
+ *
+ * The interpreter would take an interrupt, or let components run, in between two instructions. Rather than do either
+ * the sequence stops and leaves the rest to run on their own. The previous instruction may also have overwritten the
+ * block it ran from.
+ */
+bool
+CentralProcessor::continueFused(uint8_t mCycles)
+{
+    require_or(_block, return false);
+    require_or(_interruptState != interruptState::enabled ||
+               (_memory->getInterruptEnable()->value & _memory->getIORegisters()->interruptFlag) == 0, return false);
+    require_or(!_clock || _clock(mCycles), return false);
+    _instructionCount++;
     return true;
 }
 
@@ -9,1261 +9,1289 @@
  *
  */
 #include "cpu_instr.h"
+#include "Scheduler.hpp"
+
+/// Describe an opcode and open the definition of its action, `cpu` and `imm` are in scope of the body.
+#define OPCODE(_set, _op, _name, _cycles, ...)                                                                          \
+    template<> constexpr instruction _set::describe<_op>()                                                              \
+    {                                                                                                                   \
+        return instruction(_name, _set::kInstructionSet, _op, _cycles __VA_OPT__(,) __VA_ARGS__);                       \
+    }                                                                                                                   \
+    template<> void _set::action<_op>(__unused CentralProcessor &cpu, __unused uint16_t imm)
+
+#define OPCODE8(_op, _name, _cycles, ...) OPCODE(GameboyInstructionSet8bit, _op, _name, _cycles, ##__VA_ARGS__)
+#define OPCODE16(_op, _name, _cycles, ...) OPCODE(GameboyInstructionSet16bit, _op, _name, _cycles, ##__VA_ARGS__)
+#define OPCODE_STOP(_op, _name, _cycles, ...) OPCODE(GameboyInstructionSetStop, _op, _name, _cycles, ##__VA_ARGS__)
+
+/// Expand to a `case` per opcode, each calling its own `invoke<Opcode>` directly.
+#define __OPCODE_CASE(_op) case (_op): invoke<(_op)>(cpu, imm); break;
+#define __OPCODE_CASE4(_op) __OPCODE_CASE(_op) __OPCODE_CASE(_op + 1) __OPCODE_CASE(_op + 2) __OPCODE_CASE(_op + 3)
+#define __OPCODE_CASE16(_op) __OPCODE_CASE4(_op) __OPCODE_CASE4(_op + 4) __OPCODE_CASE4(_op + 8) __OPCODE_CASE4(_op + 12)
+#define __OPCODE_CASE64(_op) __OPCODE_CASE16(_op) __OPCODE_CASE16(_op + 16) __OPCODE_CASE16(_op + 32) __OPCODE_CASE16(_op + 48)
+#define OPCODE_CASES_256() __OPCODE_CASE64(0) __OPCODE_CASE64(64) __OPCODE_CASE64(128) __OPCODE_CASE64(192)
 
-#define __OPCODE_ARGS0(_cpu)       ::emu::gameboy::CentralProcessor &_cpu, __unused ::std::optional<uint16_t>
-#define __OPCODE_ARGS1(_cpu, _imm) ::emu::gameboy::CentralProcessor &_cpu, ::std::optional<uint16_t> _imm
-
-#define OPCODE_ARGS(_cpu, ...) CONCAT(__OPCODE_ARGS, __ARG_CNT(__VA_ARGS__))(_cpu, ##__VA_ARGS__)
-
-using namespace std;
-using namespace emu::gameboy::instruction;
 using namespace emu::gameboy::detail::cpu;
 
-GameboyInstructionSet8bit::GameboyInstructionSet8bit(): InstructionSet(kInstructionArraySize)
-{
-    initMoveImmediateGroup();
-    initMoveRegisterGroup();
-    initLoadHLGroup();
-    initStoreHLGroup();
-    initLoadAGroup();
-    initStoreAGroup();
-    initMoveImmediate16bitGroup();
-    initLoadStoreSpecial();
-    initPushGroup();
-    initPopGroup();
-    initAddGroup();
-    initAdcGroup();
-    initSubGroup();
-    initSbcGroup();
-    initAndGroup();
-    initOrGroup();
-    initXorGroup();
-    initCpGroup();
-    initIncGroup();
-    initDecGroup();
-    initAdd16bitGroup();
-    initInc16bitGroup();
-    initDec16bitGroup();
-    initDaa();
-    initCpl();
-    initCcf();
-    initScf();
-    initNop();
-    initHalt();
-    initInterruptControlGroup();
-    initRotateAGroup();
-    initJpGroup();
-    initJrGroup();
-    initCallGroup();
-    initRstGroup();
-    initReturnGroup();
+namespace emu::gameboy::instruction {
+static constexpr uint8_t truncate(uint16_t value) { return static_cast<uint8_t>(value & 0xFF); };
+static constexpr uint16_t extend(uint8_t value) { return static_cast<uint16_t>(value); }
+static constexpr int16_t sign_extend(uint8_t value) { return static_cast<int16_t>(static_cast<int8_t>(value)); }
+
+/// @brief Move a numerical value into a register.
+static constexpr auto mv_imm = [](uint8_t& reg, uint16_t imm) { reg = truncate(imm); };
+OPCODE8(0x3E, "LD A,%x", 2, sizeof(uint8_t)) { mv_imm(cpu._registers.a, imm); }
+OPCODE8(0x06, "LD B,%x", 2, sizeof(uint8_t)) { mv_imm(cpu._registers.b, imm); }
+OPCODE8(0x0E, "LD C,%x", 2, sizeof(uint8_t)) { mv_imm(cpu._registers.c, imm); }
+OPCODE8(0x16, "LD D,%x", 2, sizeof(uint8_t)) { mv_imm(cpu._registers.d, imm); }
+OPCODE8(0x1E, "LD E,%x", 2, sizeof(uint8_t)) { mv_imm(cpu._registers.e, imm); }
+OPCODE8(0x26, "LD H,%x", 2, sizeof(uint8_t)) { mv_imm(cpu._registers.h, imm); }
+OPCODE8(0x2E, "LD L,%x", 2, sizeof(uint8_t)) { mv_imm(cpu._registers.l, imm); }
+
+/// @brief Move the contents of a register into another.
+static constexpr auto mv = [](uint8_t &dst, uint8_t src) { dst = src; };
+OPCODE8(0x7F, "LD A,A", 1) { mv(cpu._registers.a, cpu._registers.a); }
+OPCODE8(0x78, "LD A,B", 1) { mv(cpu._registers.a, cpu._registers.b); }
+OPCODE8(0x79, "LD A,C", 1) { mv(cpu._registers.a, cpu._registers.c); }
+OPCODE8(0x7A, "LD A,D", 1) { mv(cpu._registers.a, cpu._registers.d); }
+OPCODE8(0x7B, "LD A,E", 1) { mv(cpu._registers.a, cpu._registers.e); }
+OPCODE8(0x7C, "LD A,H", 1) { mv(cpu._registers.a, cpu._registers.h); }
+OPCODE8(0x7D, "LD A,L", 1) { mv(cpu._registers.a, cpu._registers.l); }
+OPCODE8(0x40, "LD B,B", 1) { mv(cpu._registers.b, cpu._registers.b); }
+OPCODE8(0x41, "LD B,C", 1) { mv(cpu._registers.b, cpu._registers.c); }
+OPCODE8(0x42, "LD B,D", 1) { mv(cpu._registers.b, cpu._registers.d); }
+OPCODE8(0x43, "LD B,E", 1) { mv(cpu._registers.b, cpu._registers.e); }
+OPCODE8(0x44, "LD B,H", 1) { mv(cpu._registers.b, cpu._registers.h); }
+OPCODE8(0x45, "LD B,L", 1) { mv(cpu._registers.b, cpu._registers.l); }
+OPCODE8(0x48, "LD C,B", 1) { mv(cpu._registers.c, cpu._registers.b); }
+OPCODE8(0x49, "LD C,C", 1) { mv(cpu._registers.c, cpu._registers.c); }
+OPCODE8(0x4A, "LD C,D", 1) { mv(cpu._registers.c, cpu._registers.d); }
+OPCODE8(0x4B, "LD C,E", 1) { mv(cpu._registers.c, cpu._registers.e); }
+OPCODE8(0x4C, "LD C,H", 1) { mv(cpu._registers.c, cpu._registers.h); }
+OPCODE8(0x4D, "LD C,L", 1) { mv(cpu._registers.c, cpu._registers.l); }
+OPCODE8(0x50, "LD D,B", 1) { mv(cpu._registers.d, cpu._registers.b); }
+OPCODE8(0x51, "LD D,C", 1) { mv(cpu._registers.d, cpu._registers.c); }
+OPCODE8(0x52, "LD D,D", 1) { mv(cpu._registers.d, cpu._registers.d); }
+OPCODE8(0x53, "LD D,E", 1) { mv(cpu._registers.d, cpu._registers.e); }
+OPCODE8(0x54, "LD D,H", 1) { mv(cpu._registers.d, cpu._registers.h); }
+OPCODE8(0x55, "LD D,L", 1) { mv(cpu._registers.d, cpu._registers.l); }
+OPCODE8(0x58, "LD E,B", 1) { mv(cpu._registers.e, cpu._registers.b); }
+OPCODE8(0x59, "LD E,C", 1) { mv(cpu._registers.e, cpu._registers.c); }
+OPCODE8(0x5A, "LD E,D", 1) { mv(cpu._registers.e, cpu._registers.d); }
+OPCODE8(0x5B, "LD E,E", 1) { mv(cpu._registers.e, cpu._registers.e); }
+OPCODE8(0x5C, "LD E,H", 1) { mv(cpu._registers.e, cpu._registers.h); }
+OPCODE8(0x5D, "LD E,L", 1) { mv(cpu._registers.e, cpu._registers.l); }
+OPCODE8(0x60, "LD H,B", 1) { mv(cpu._registers.h, cpu._registers.b); }
+OPCODE8(0x61, "LD H,C", 1) { mv(cpu._registers.h, cpu._registers.c); }
+OPCODE8(0x62, "LD H,D", 1) { mv(cpu._registers.h, cpu._registers.d); }
+OPCODE8(0x63, "LD H,E", 1) { mv(cpu._registers.h, cpu._registers.e); }
+OPCODE8(0x64, "LD H,H", 1) { mv(cpu._registers.h, cpu._registers.h); }
+OPCODE8(0x65, "LD H,L", 1) { mv(cpu._registers.h, cpu._registers.l); }
+OPCODE8(0x68, "LD L,B", 1) { mv(cpu._registers.l, cpu._registers.b); }
+OPCODE8(0x69, "LD L,C", 1) { mv(cpu._registers.l, cpu._registers.c); }
+OPCODE8(0x6A, "LD L,D", 1) { mv(cpu._registers.l, cpu._registers.d); }
+OPCODE8(0x6B, "LD L,E", 1) { mv(cpu._registers.l, cpu._registers.e); }
+OPCODE8(0x6C, "LD L,H", 1) { mv(cpu._registers.l, cpu._registers.h); }
+OPCODE8(0x6D, "LD L,L", 1) { mv(cpu._registers.l, cpu._registers.l); }
+OPCODE8(0x47, "LD B,A", 1) { mv(cpu._registers.b, cpu._registers.a); }
+OPCODE8(0x4F, "LD C,A", 1) { mv(cpu._registers.c, cpu._registers.a); }
+OPCODE8(0x57, "LD D,A", 1) { mv(cpu._registers.d, cpu._registers.a); }
+OPCODE8(0x5F, "LD E,A", 1) { mv(cpu._registers.e, cpu._registers.a); }
+OPCODE8(0x67, "LD H,A", 1) { mv(cpu._registers.h, cpu._registers.a); }
+OPCODE8(0x6F, "LD L,A", 1) { mv(cpu._registers.l, cpu._registers.a); }
+
+/// @brief Read memory at the address in HL, and write the value to a register.
+static constexpr auto ld_hl = [](CentralProcessor& cpu, uint8_t& dst) { dst = cpu.getMemoryManager()->read(cpu.getRegisters().hl); };
+OPCODE8(0x7E, "LD A,(HL)", 2) { ld_hl(cpu, cpu._registers.a); }
+OPCODE8(0x46, "LD B,(HL)", 2) { ld_hl(cpu, cpu._registers.b); }
+OPCODE8(0x4E, "LD C,(HL)", 2) { ld_hl(cpu, cpu._registers.c); }
+OPCODE8(0x56, "LD D,(HL)", 2) { ld_hl(cpu, cpu._registers.d); }
+OPCODE8(0x5E, "LD E,(HL)", 2) { ld_hl(cpu, cpu._registers.e); }
+OPCODE8(0x66, "LD H,(HL)", 2) { ld_hl(cpu, cpu._registers.h); }
+OPCODE8(0x6E, "LD L,(HL)", 2) { ld_hl(cpu, cpu._registers.l); }
+
+/// @brief Write the value in a register to the address stored in HL.
+static constexpr auto st_hl = [](CentralProcessor& cpu, uint8_t src) { cpu.getMemoryManager()->write(cpu.getRegisters().hl, src); };
+OPCODE8(0x77, "LD (HL),A", 2) { st_hl(cpu, cpu._registers.a); }
+OPCODE8(0x70, "LD (HL),B", 2) { st_hl(cpu, cpu._registers.b); }
+OPCODE8(0x71, "LD (HL),C", 2) { st_hl(cpu, cpu._registers.c); }
+OPCODE8(0x72, "LD (HL),D", 2) { st_hl(cpu, cpu._registers.d); }
+OPCODE8(0x73, "LD (HL),E", 2) { st_hl(cpu, cpu._registers.e); }
+OPCODE8(0x74, "LD (HL),H", 2) { st_hl(cpu, cpu._registers.h); }
+OPCODE8(0x75, "LD (HL),L", 2) { st_hl(cpu, cpu._registers.l); }
+OPCODE8(0x36, "LD (HL),%x", 3, sizeof(uint8_t)) { st_hl(cpu, truncate(imm)); }
+
+/// @brief Read memory and store the result in register A.
+static constexpr auto ld_a = [](CentralProcessor& cpu, uint16_t src) { cpu.getRegisters().a = cpu.getMemoryManager()->read(src); };
+OPCODE8(0x0A, "LD A,(BC)", 2) { ld_a(cpu, cpu._registers.bc); }
+OPCODE8(0x1A, "LD A,(DE)", 2) { ld_a(cpu, cpu._registers.de); }
+OPCODE8(0xFA, "LD A,(%x)", 4, sizeof(uint16_t)) { ld_a(cpu, imm); }
+
+/// @brief Write the value in register A to memory.
+static constexpr auto st_a = [](CentralProcessor& cpu, uint16_t dst) { cpu.getMemoryManager()->write(dst, cpu.getRegisters().a); };
+OPCODE8(0x02, "LD (BC),A", 2) { st_a(cpu, cpu._registers.bc); }
+OPCODE8(0x12, "LD (DE),A", 2) { st_a(cpu, cpu._registers.de); }
+OPCODE8(0xEA, "LD (%x),A", 4, sizeof(uint16_t)) { st_a(cpu, imm); }
+
+/// @brief Move an integer value into a wide register.
+static constexpr auto mv16 = [](uint16_t& dst, uint16_t imm) { dst = imm; };
+OPCODE8(0x01, "LD BC,%x", 3, sizeof(uint16_t)) { mv16(cpu._registers.bc, imm); }
+OPCODE8(0x11, "LD DE,%x", 3, sizeof(uint16_t)) { mv16(cpu._registers.de, imm); }
+OPCODE8(0x21, "LD HL,%x", 3, sizeof(uint16_t)) { mv16(cpu._registers.hl, imm); }
+OPCODE8(0x31, "LD SP,%x", 3, sizeof(uint16_t)) { mv16(cpu._registers.stackPointer, imm); }
+
+/// @brief Special load/store instructions.
+OPCODE8(0x3A, "LDD A,(HL)", 2) {
+    cpu._registers.a = cpu.getMemoryManager()->read(cpu._registers.hl--);
 }
-
-void
-GameboyInstructionSet8bit::initMoveImmediateGroup()
-{
-    static constexpr auto mv = [](uint8_t& reg, optional<uint16_t> imm) { reg = truncate(*imm); };
-    static constexpr uint8_t sz = sizeof(uint8_t);
-    _instructions[0x3E] = instruction("LD A,%x", [](OPCODE_ARGS(cpu, imm)) { mv(cpu._registers.a, imm); }, 2, sz);
-    _instructions[0x06] = instruction("LD B,%x", [](OPCODE_ARGS(cpu, imm)) { mv(cpu._registers.b, imm); }, 2, sz);
-    _instructions[0x0E] = instruction("LD C,%x", [](OPCODE_ARGS(cpu, imm)) { mv(cpu._registers.c, imm); }, 2, sz);
-    _instructions[0x16] = instruction("LD D,%x", [](OPCODE_ARGS(cpu, imm)) { mv(cpu._registers.d, imm); }, 2, sz);
-    _instructions[0x1E] = instruction("LD E,%x", [](OPCODE_ARGS(cpu, imm)) { mv(cpu._registers.e, imm); }, 2, sz);
-    _instructions[0x26] = instruction("LD H,%x", [](OPCODE_ARGS(cpu, imm)) { mv(cpu._registers.h, imm); }, 2, sz);
-    _instructions[0x2E] = instruction("LD L,%x", [](OPCODE_ARGS(cpu, imm)) { mv(cpu._registers.l, imm); }, 2, sz);
+OPCODE8(0x2A, "LDI A,(HL)", 2) {
+    cpu._registers.a = cpu.getMemoryManager()->read(cpu._registers.hl++);
 }
-
-void
-GameboyInstructionSet8bit::initMoveRegisterGroup()
-{
-    static constexpr auto mv = [](uint8_t &dst, uint8_t src) { dst = src; };
-    _instructions[0x7F] = instruction("LD A,A", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.a, cpu._registers.a); }, 1);
-    _instructions[0x78] = instruction("LD A,B", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.a, cpu._registers.b); }, 1);
-    _instructions[0x79] = instruction("LD A,C", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.a, cpu._registers.c); }, 1);
-    _instructions[0x7A] = instruction("LD A,D", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.a, cpu._registers.d); }, 1);
-    _instructions[0x7B] = instruction("LD A,E", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.a, cpu._registers.e); }, 1);
-    _instructions[0x7C] = instruction("LD A,H", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.a, cpu._registers.h); }, 1);
-    _instructions[0x7D] = instruction("LD A,L", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.a, cpu._registers.l); }, 1);
-    _instructions[0x40] = instruction("LD B,B", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.b, cpu._registers.b); }, 1);
-    _instructions[0x41] = instruction("LD B,C", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.b, cpu._registers.c); }, 1);
-    _instructions[0x42] = instruction("LD B,D", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.b, cpu._registers.d); }, 1);
-    _instructions[0x43] = instruction("LD B,E", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.b, cpu._registers.e); }, 1);
-    _instructions[0x44] = instruction("LD B,H", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.b, cpu._registers.h); }, 1);
-    _instructions[0x45] = instruction("LD B,L", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.b, cpu._registers.l); }, 1);
-    _instructions[0x48] = instruction("LD C,B", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.c, cpu._registers.b); }, 1);
-    _instructions[0x49] = instruction("LD C,C", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.c, cpu._registers.c); }, 1);
-    _instructions[0x4A] = instruction("LD C,D", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.c, cpu._registers.d); }, 1);
-    _instructions[0x4B] = instruction("LD C,E", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.c, cpu._registers.e); }, 1);
-    _instructions[0x4C] = instruction("LD C,H", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.c, cpu._registers.h); }, 1);
-    _instructions[0x4D] = instruction("LD C,L", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.c, cpu._registers.l); }, 1);
-    _instructions[0x50] = instruction("LD D,B", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.d, cpu._registers.b); }, 1);
-    _instructions[0x51] = instruction("LD D,C", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.d, cpu._registers.c); }, 1);
-    _instructions[0x52] = instruction("LD D,D", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.d, cpu._registers.d); }, 1);
-    _instructions[0x53] = instruction("LD D,E", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.d, cpu._registers.e); }, 1);
-    _instructions[0x54] = instruction("LD D,H", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.d, cpu._registers.h); }, 1);
-    _instructions[0x55] = instruction("LD D,L", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.d, cpu._registers.l); }, 1);
-    _instructions[0x58] = instruction("LD E,B", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.e, cpu._registers.b); }, 1);
-    _instructions[0x59] = instruction("LD E,C", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.e, cpu._registers.c); }, 1);
-    _instructions[0x5A] = instruction("LD E,D", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.e, cpu._registers.d); }, 1);
-    _instructions[0x5B] = instruction("LD E,E", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.e, cpu._registers.e); }, 1);
-    _instructions[0x5C] = instruction("LD E,H", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.e, cpu._registers.h); }, 1);
-    _instructions[0x5D] = instruction("LD E,L", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.e, cpu._registers.l); }, 1);
-    _instructions[0x60] = instruction("LD H,B", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.h, cpu._registers.b); }, 1);
-    _instructions[0x61] = instruction("LD H,C", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.h, cpu._registers.c); }, 1);
-    _instructions[0x62] = instruction("LD H,D", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.h, cpu._registers.d); }, 1);
-    _instructions[0x63] = instruction("LD H,E", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.h, cpu._registers.e); }, 1);
-    _instructions[0x64] = instruction("LD H,H", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.h, cpu._registers.h); }, 1);
-    _instructions[0x65] = instruction("LD H,L", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.h, cpu._registers.l); }, 1);
-    _instructions[0x68] = instruction("LD L,B", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.l, cpu._registers.b); }, 1);
-    _instructions[0x69] = instruction("LD L,C", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.l, cpu._registers.c); }, 1);
-    _instructions[0x6A] = instruction("LD L,D", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.l, cpu._registers.d); }, 1);
-    _instructions[0x6B] = instruction("LD L,E", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.l, cpu._registers.e); }, 1);
-    _instructions[0x6C] = instruction("LD L,H", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.l, cpu._registers.h); }, 1);
-    _instructions[0x6D] = instruction("LD L,L", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.l, cpu._registers.l); }, 1);
-    _instructions[0x47] = instruction("LD B,A", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.b, cpu._registers.a); }, 1);
-    _instructions[0x4F] = instruction("LD C,A", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.c, cpu._registers.a); }, 1);
-    _instructions[0x57] = instruction("LD D,A", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.d, cpu._registers.a); }, 1);
-    _instructions[0x5F] = instruction("LD E,A", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.e, cpu._registers.a); }, 1);
-    _instructions[0x67] = instruction("LD H,A", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.h, cpu._registers.a); }, 1);
-    _instructions[0x6F] = instruction("LD L,A", [](OPCODE_ARGS(cpu)) { mv(cpu._registers.l, cpu._registers.a); }, 1);
+OPCODE8(0xE2, "LD (C),A", 2) {
+    cpu.getMemoryManager()->write(0xFF00 + extend(cpu._registers.c), cpu._registers.a);
 }
-
-void
-GameboyInstructionSet8bit::initLoadHLGroup()
-{
-    static constexpr auto ld = [](CentralProcessor& cpu, uint8_t& dst) { dst = cpu.getMemoryManager()->read(cpu._registers.hl); };
-    _instructions[0x7E] = instruction("LD A,(HL)", [](OPCODE_ARGS(cpu)) { ld(cpu, cpu._registers.a); }, 2);
-    _instructions[0x46] = instruction("LD B,(HL)", [](OPCODE_ARGS(cpu)) { ld(cpu, cpu._registers.b); }, 2);
-    _instructions[0x4E] = instruction("LD C,(HL)", [](OPCODE_ARGS(cpu)) { ld(cpu, cpu._registers.c); }, 2);
-    _instructions[0x56] = instruction("LD D,(HL)", [](OPCODE_ARGS(cpu)) { ld(cpu, cpu._registers.d); }, 2);
-    _instructions[0x5E] = instruction("LD E,(HL)", [](OPCODE_ARGS(cpu)) { ld(cpu, cpu._registers.e); }, 2);
-    _instructions[0x66] = instruction("LD H,(HL)", [](OPCODE_ARGS(cpu)) { ld(cpu, cpu._registers.h); }, 2);
-    _instructions[0x6E] = instruction("LD L,(HL)", [](OPCODE_ARGS(cpu)) { ld(cpu, cpu._registers.l); }, 2);
+OPCODE8(0xF2, "LD A,(C)", 2) {
+    cpu._registers.a = cpu.getMemoryManager()->read(0xFF00 + extend(cpu._registers.c));
 }
-
-void
-GameboyInstructionSet8bit::initStoreHLGroup()
-{
-    static constexpr auto st = [](CentralProcessor& cpu, uint8_t src) { cpu.getMemoryManager()->write(cpu._registers.hl, src); };
-    _instructions[0x77] = instruction("LD (HL),A", [](OPCODE_ARGS(cpu)) { st(cpu, cpu._registers.a); }, 2);
-    _instructions[0x70] = instruction("LD (HL),B", [](OPCODE_ARGS(cpu)) { st(cpu, cpu._registers.b); }, 2);
-    _instructions[0x71] = instruction("LD (HL),C", [](OPCODE_ARGS(cpu)) { st(cpu, cpu._registers.c); }, 2);
-    _instructions[0x72] = instruction("LD (HL),D", [](OPCODE_ARGS(cpu)) { st(cpu, cpu._registers.d); }, 2);
-    _instructions[0x73] = instruction("LD (HL),E", [](OPCODE_ARGS(cpu)) { st(cpu, cpu._registers.e); }, 2);
-    _instructions[0x74] = instruction("LD (HL),H", [](OPCODE_ARGS(cpu)) { st(cpu, cpu._registers.h); }, 2);
-    _instructions[0x75] = instruction("LD (HL),L", [](OPCODE_ARGS(cpu)) { st(cpu, cpu._registers.l); }, 2);
-    _instructions[0x36] = instruction("LD (HL),%x", [](OPCODE_ARGS(cpu, imm)) { st(cpu, truncate(*imm)); }, 3,
-                                      sizeof(uint8_t));
+OPCODE8(0x32, "LDD (HL),A", 2) {
+    cpu.getMemoryManager()->write(cpu._registers.hl--, cpu._registers.a);
 }
-
-void
-GameboyInstructionSet8bit::initLoadAGroup()
-{
-    static constexpr auto ld = [](CentralProcessor& cpu, uint16_t src) { cpu._registers.a = cpu.getMemoryManager()->read(src); };
-    _instructions[0x0A] = instruction("LD A,(BC)", [](OPCODE_ARGS(cpu)) { ld(cpu, cpu._registers.bc); }, 2);
-    _instructions[0x1A] = instruction("LD A,(DE)", [](OPCODE_ARGS(cpu)) { ld(cpu, cpu._registers.de); }, 2);
-    _instructions[0xFA] = instruction("LD A,(%x)", [](OPCODE_ARGS(cpu, imm)) { ld(cpu, *imm); }, 4, 
-                                      sizeof(uint16_t));
+OPCODE8(0x22, "LDI (HL),A", 2) {
+    cpu.getMemoryManager()->write(cpu._registers.hl++, cpu._registers.a);
 }
-
-void
-GameboyInstructionSet8bit::initStoreAGroup()
-{
-    static constexpr auto st = [](CentralProcessor& cpu, uint16_t dst) { cpu.getMemoryManager()->write(dst, cpu._registers.a); };
-    _instructions[0x02] = instruction("LD (BC),A", [](OPCODE_ARGS(cpu)) { st(cpu, cpu._registers.bc); }, 2);
-    _instructions[0x12] = instruction("LD (DE),A", [](OPCODE_ARGS(cpu)) { st(cpu, cpu._registers.de); }, 2);
-    _instructions[0xEA] = instruction("LD (%x),A", [](OPCODE_ARGS(cpu, imm)) { st(cpu, *imm); }, 4, 
-                                      sizeof(uint16_t));
+OPCODE8(0xE0, "LDH (%x),A", 3, sizeof(uint8_t)) {
+    cpu.getMemoryManager()->write(0xFF00 + truncate(imm), cpu._registers.a);
 }
-
-void
-GameboyInstructionSet8bit::initMoveImmediate16bitGroup()
-{
-    static constexpr auto mv = [](uint16_t& dst, uint16_t imm) { dst = imm; };
-    static constexpr uint8_t sz = sizeof(uint16_t);
-    _instructions[0x01] = instruction("LD BC,%x", [](OPCODE_ARGS(cpu, imm)) { mv(cpu._registers.bc, *imm); }, 3, sz);
-    _instructions[0x11] = instruction("LD DE,%x", [](OPCODE_ARGS(cpu, imm)) { mv(cpu._registers.de, *imm); }, 3, sz);
-    _instructions[0x21] = instruction("LD HL,%x", [](OPCODE_ARGS(cpu, imm)) { mv(cpu._registers.hl, *imm); }, 3, sz);
-    _instructions[0x31] = instruction("LD SP,%x", [](OPCODE_ARGS(cpu, imm)) { mv(cpu._registers.stackPointer, *imm); }, 3, sz);
+OPCODE8(0xF0, "LDH A,(%x)", 3, sizeof(uint8_t)) {
+    cpu._registers.a = cpu.getMemoryManager()->read(0xFF00 + truncate(imm));
 }
-
-void
-GameboyInstructionSet8bit::initLoadStoreSpecial()
-{
-    _instructions[0x3A] = instruction("LDD A,(HL)", [](OPCODE_ARGS(cpu)) { 
-        cpu._registers.a = cpu.getMemoryManager()->read(cpu._registers.hl--);
-    }, 2);
-    _instructions[0x2A] = instruction("LDI A,(HL)", [](OPCODE_ARGS(cpu)) { 
-        cpu._registers.a = cpu.getMemoryManager()->read(cpu._registers.hl++);
-    }, 2);
-    _instructions[0xE2] = instruction("LD (C),A", [](OPCODE_ARGS(cpu)) { 
-        cpu.getMemoryManager()->write(0xFF00 + extend(cpu._registers.c), cpu._registers.a);
-    }, 2);
-    _instructions[0xF2] = instruction("LD A,(C)", [](OPCODE_ARGS(cpu)) {
-        cpu._registers.a = cpu.getMemoryManager()->read(0xFF00 + extend(cpu._registers.c));
-    }, 2);
-    _instructions[0x32] = instruction("LDD (HL),A", [](OPCODE_ARGS(cpu)) {
-        cpu.getMemoryManager()->write(cpu._registers.hl--, cpu._registers.a);
-    }, 2);
-    _instructions[0x22] = instruction("LDI (HL),A", [](OPCODE_ARGS(cpu)) {
-        cpu.getMemoryManager()->write(cpu._registers.hl++, cpu._registers.a);
-    }, 2);
-    _instructions[0xE0] = instruction("LDH (%x),A", [](OPCODE_ARGS(cpu, imm)) {
-        cpu.getMemoryManager()->write(0xFF00 + truncate(*imm), cpu._registers.a);
-    }, 3, sizeof(uint8_t));
-    _instructions[0xF0] = instruction("LDH A,(%x)", [](OPCODE_ARGS(cpu, imm)) {
-        cpu._registers.a = cpu.getMemoryManager()->read(0xFF00 + truncate(*imm));
-    }, 3, sizeof(uint8_t));
-    _instructions[0xF9] = instruction("LD SP,HL", [](OPCODE_ARGS(cpu)) {
-        cpu._registers.stackPointer = cpu._registers.hl;
-    }, 2);
-    _instructions[0x08] = instruction("LD (%x),SP", [](OPCODE_ARGS(cpu, imm)) {
-        cpu.getMemoryManager()->write(*imm, cpu._registers.stackPointer);
-    }, 5, sizeof(uint16_t));
-    _instructions[0xF8] = instruction("LDHL SP,%x", [](OPCODE_ARGS(cpu, imm)) {
-        auto &flags = cpu._registers.f;
-        uint8_t immByte = truncate(*imm);
-        uint8_t lowNibbleSum = (truncate(cpu._registers.stackPointer) & 0xF) + (immByte & 0xF);
-        flags.halfCarry = static_cast<bool>(lowNibbleSum >> 4);
-        flags.carry = add_overflow(truncate(cpu._registers.stackPointer), immByte);
-        flags.subtract = false;
-        flags.zero = false;
-        cpu._registers.hl = cpu._registers.stackPointer + sign_extend(immByte);
-    }, 3, sizeof(uint8_t));
+OPCODE8(0xF9, "LD SP,HL", 2) {
+    cpu._registers.stackPointer = cpu._registers.hl;
 }
-
-void
-GameboyInstructionSet8bit::initPushGroup()
-{
-    static constexpr auto push = [](CentralProcessor& cpu, uint16_t value) {
-        cpu.pushToStack(value);
-    };
-    _instructions[0xF5] = instruction("PUSH AF", [](OPCODE_ARGS(cpu)) { push(cpu, cpu._registers.af & 0xFFF0); }, 4);
-    _instructions[0xC5] = instruction("PUSH BC", [](OPCODE_ARGS(cpu)) { push(cpu, cpu._registers.bc); }, 4);
-    _instructions[0xD5] = instruction("PUSH DE", [](OPCODE_ARGS(cpu)) { push(cpu, cpu._registers.de); }, 4);
-    _instructions[0xE5] = instruction("PUSH HL", [](OPCODE_ARGS(cpu)) { push(cpu, cpu._registers.hl); }, 4);
+OPCODE8(0x08, "LD (%x),SP", 5, sizeof(uint16_t)) {
+    cpu.getMemoryManager()->write(imm, cpu._registers.stackPointer);
 }
-
-void
-GameboyInstructionSet8bit::initPopGroup()
-{
-    static constexpr auto pop = [](CentralProcessor& cpu) -> uint16_t {
-        return cpu.popFromStack();
-    };
-    _instructions[0xF1] = instruction("POP AF", [](OPCODE_ARGS(cpu)) { cpu._registers.af = pop(cpu) & 0xFFF0; }, 3);
-    _instructions[0xC1] = instruction("POP BC", [](OPCODE_ARGS(cpu)) { cpu._registers.bc = pop(cpu); }, 3);
-    _instructions[0xD1] = instruction("POP DE", [](OPCODE_ARGS(cpu)) { cpu._registers.de = pop(cpu); }, 3);
-    _instructions[0xE1] = instruction("POP HL", [](OPCODE_ARGS(cpu)) { cpu._registers.hl = pop(cpu); }, 3);
+OPCODE8(0xF8, "LDHL SP,%x", 3, sizeof(uint8_t)) {
+    auto &flags = cpu._registers.getFlags();
+    uint8_t immByte = truncate(imm);
+    uint8_t lowNibbleSum = (truncate(cpu._registers.stackPointer) & 0xF) + (immByte & 0xF);
+    flags.halfCarry = static_cast<bool>(lowNibbleSum >> 4);
+    flags.carry = add_overflow(truncate(cpu._registers.stackPointer), immByte);
+    flags.subtract = false;
+    flags.zero = false;
+    cpu._registers.hl = cpu._registers.stackPointer + sign_extend(immByte);
 }
 
-void
-GameboyInstructionSet8bit::initAddGroup()
-{
-    static constexpr auto add = [](CentralProcessor& cpu, uint8_t value) {
-        auto &flags = cpu._registers.f;
-        uint8_t lowNibbleSum = (cpu._registers.a & 0xF) + (value & 0xF);
-        flags.halfCarry = static_cast<bool>(lowNibbleSum >> 4);
-        flags.carry = add_overflow(cpu._registers.a, value, &cpu._registers.a);
-        flags.zero = !cpu._registers.a;
-        flags.subtract = false;
-    };
-    _instructions[0x87] = instruction("ADD A,A", [](OPCODE_ARGS(cpu)) { add(cpu, cpu._registers.a); }, 1);
-    _instructions[0x80] = instruction("ADD A,B", [](OPCODE_ARGS(cpu)) { add(cpu, cpu._registers.b); }, 1);
-    _instructions[0x81] = instruction("ADD A,C", [](OPCODE_ARGS(cpu)) { add(cpu, cpu._registers.c); }, 1);
-    _instructions[0x82] = instruction("ADD A,D", [](OPCODE_ARGS(cpu)) { add(cpu, cpu._registers.d); }, 1);
-    _instructions[0x83] = instruction("ADD A,E", [](OPCODE_ARGS(cpu)) { add(cpu, cpu._registers.e); }, 1);
-    _instructions[0x84] = instruction("ADD A,H", [](OPCODE_ARGS(cpu)) { add(cpu, cpu._registers.h); }, 1);
-    _instructions[0x85] = instruction("ADD A,L", [](OPCODE_ARGS(cpu)) { add(cpu, cpu._registers.l); }, 1);
-    _instructions[0xC6] = instruction("ADD A,%x", [](OPCODE_ARGS(cpu, imm)) { add(cpu, truncate(*imm)); }, 2, 
-                                      sizeof(uint8_t));
-    _instructions[0x86] = instruction("ADD A,(HL)", [](OPCODE_ARGS(cpu, imm)) { 
-        add(cpu, cpu.getMemoryManager()->read(cpu._registers.hl)); 
-    }, 2);
+/// @brief Push a value onto the stack.
+static constexpr auto push = [](CentralProcessor& cpu, uint16_t value) {
+    cpu.pushToStack(value);
+};
+OPCODE8(0xF5, "PUSH AF", 4) { push(cpu, cpu._registers.getAF() & 0xFFF0); }
+OPCODE8(0xC5, "PUSH BC", 4) { push(cpu, cpu._registers.bc); }
+OPCODE8(0xD5, "PUSH DE", 4) { push(cpu, cpu._registers.de); }
+OPCODE8(0xE5, "PUSH HL", 4) { push(cpu, cpu._registers.hl); }
+
+/// @brief Pop a value off the stack.
+static constexpr auto pop = [](CentralProcessor& cpu) -> uint16_t {
+    return cpu.popFromStack();
+};
+OPCODE8(0xF1, "POP AF", 3) { cpu._registers.setAF(pop(cpu) & 0xFFF0); }
+OPCODE8(0xC1, "POP BC", 3) { cpu._registers.bc = pop(cpu); }
+OPCODE8(0xD1, "POP DE", 3) { cpu._registers.de = pop(cpu); }
+OPCODE8(0xE1, "POP HL", 3) { cpu._registers.hl = pop(cpu); }
+
+/// @brief Add a value to register A and set flags.
+static constexpr auto add = [](CentralProcessor& cpu, uint8_t value) {
+    auto &reg = cpu.getRegisters();
+    uint16_t result = reg.a + value;
+    reg.deferFlags(registers::flagOperation::add, reg.a ^ value, result);
+    reg.a = truncate(result);
+};
+OPCODE8(0x87, "ADD A,A", 1) { add(cpu, cpu._registers.a); }
+OPCODE8(0x80, "ADD A,B", 1) { add(cpu, cpu._registers.b); }
+OPCODE8(0x81, "ADD A,C", 1) { add(cpu, cpu._registers.c); }
+OPCODE8(0x82, "ADD A,D", 1) { add(cpu, cpu._registers.d); }
+OPCODE8(0x83, "ADD A,E", 1) { add(cpu, cpu._registers.e); }
+OPCODE8(0x84, "ADD A,H", 1) { add(cpu, cpu._registers.h); }
+OPCODE8(0x85, "ADD A,L", 1) { add(cpu, cpu._registers.l); }
+OPCODE8(0xC6, "ADD A,%x", 2, sizeof(uint8_t)) { add(cpu, truncate(imm)); }
+OPCODE8(0x86, "ADD A,(HL)", 2) {
+    add(cpu, cpu.getMemoryManager()->read(cpu._registers.hl));
 }
 
-void
-GameboyInstructionSet8bit::initAdcGroup()
-{
-    static constexpr auto adc = [](CentralProcessor& cpu, uint8_t value) {
-        auto &flags = cpu._registers.f;
-        uint8_t lowNibbleSum = (cpu._registers.a & 0xF) + (value & 0xF) + flags.carry;
-        flags.halfCarry = static_cast<bool>(lowNibbleSum >> 4);
-        flags.carry = add3_overflow(cpu._registers.a, value, flags.carry, &cpu._registers.a);
-        flags.zero = !cpu._registers.a;
-        flags.subtract = false;
-    };
-    _instructions[0x8F] = instruction("ADC A,A", [](OPCODE_ARGS(cpu)) { adc(cpu, cpu._registers.a); }, 1);
-    _instructions[0x88] = instruction("ADC A,B", [](OPCODE_ARGS(cpu)) { adc(cpu, cpu._registers.b); }, 1);
-    _instructions[0x89] = instruction("ADC A,C", [](OPCODE_ARGS(cpu)) { adc(cpu, cpu._registers.c); }, 1);
-    _instructions[0x8A] = instruction("ADC A,D", [](OPCODE_ARGS(cpu)) { adc(cpu, cpu._registers.d); }, 1);
-    _instructions[0x8B] = instruction("ADC A,E", [](OPCODE_ARGS(cpu)) { adc(cpu, cpu._registers.e); }, 1);
-    _instructions[0x8C] = instruction("ADC A,H", [](OPCODE_ARGS(cpu)) { adc(cpu, cpu._registers.h); }, 1);
-    _instructions[0x8D] = instruction("ADC A,L", [](OPCODE_ARGS(cpu)) { adc(cpu, cpu._registers.l); }, 1);
-    _instructions[0xCE] = instruction("ADC A,%x", [](OPCODE_ARGS(cpu, imm)) { adc(cpu, truncate(*imm)); }, 2, 
-                                      sizeof(uint8_t));
-    _instructions[0x8E] = instruction("ADC A,(HL)", [](OPCODE_ARGS(cpu, imm)) {
-        adc(cpu, cpu.getMemoryManager()->read(cpu._registers.hl)); 
-    }, 2);
+/// @brief Add a value (plus carry) to register A and set flags.
+static constexpr auto adc = [](CentralProcessor& cpu, uint8_t value) {
+    auto &reg = cpu.getRegisters();
+    uint16_t result = reg.a + value + reg.carry();
+    reg.deferFlags(registers::flagOperation::add, reg.a ^ value, result);
+    reg.a = truncate(result);
+};
+OPCODE8(0x8F, "ADC A,A", 1) { adc(cpu, cpu._registers.a); }
+OPCODE8(0x88, "ADC A,B", 1) { adc(cpu, cpu._registers.b); }
+OPCODE8(0x89, "ADC A,C", 1) { adc(cpu, cpu._registers.c); }
+OPCODE8(0x8A, "ADC A,D", 1) { adc(cpu, cpu._registers.d); }
+OPCODE8(0x8B, "ADC A,E", 1) { adc(cpu, cpu._registers.e); }
+OPCODE8(0x8C, "ADC A,H", 1) { adc(cpu, cpu._registers.h); }
+OPCODE8(0x8D, "ADC A,L", 1) { adc(cpu, cpu._registers.l); }
+OPCODE8(0xCE, "ADC A,%x", 2, sizeof(uint8_t)) { adc(cpu, truncate(imm)); }
+OPCODE8(0x8E, "ADC A,(HL)", 2) {
+    adc(cpu, cpu.getMemoryManager()->read(cpu._registers.hl));
 }
 
-void
-GameboyInstructionSet8bit::initSubGroup()
-{
-    static constexpr auto sub = [](CentralProcessor& cpu, uint8_t value) {
-        auto &flags = cpu._registers.f;
-        uint8_t lowNibbleDiff = (cpu._registers.a & 0xF) - (value & 0xF);
-        flags.halfCarry = static_cast<bool>(lowNibbleDiff >> 4);
-        flags.carry = sub_overflow(cpu._registers.a, value, &cpu._registers.a);
-        flags.zero = !cpu._registers.a;
-        flags.subtract = true;
-    };
-    _instructions[0x97] = instruction("SUB A,A", [](OPCODE_ARGS(cpu)) { sub(cpu, cpu._registers.a); }, 1);
-    _instructions[0x90] = instruction("SUB A,B", [](OPCODE_ARGS(cpu)) { sub(cpu, cpu._registers.b); }, 1);
-    _instructions[0x91] = instruction("SUB A,C", [](OPCODE_ARGS(cpu)) { sub(cpu, cpu._registers.c); }, 1);
-    _instructions[0x92] = instruction("SUB A,D", [](OPCODE_ARGS(cpu)) { sub(cpu, cpu._registers.d); }, 1);
-    _instructions[0x93] = instruction("SUB A,E", [](OPCODE_ARGS(cpu)) { sub(cpu, cpu._registers.e); }, 1);
-    _instructions[0x94] = instruction("SUB A,H", [](OPCODE_ARGS(cpu)) { sub(cpu, cpu._registers.h); }, 1);
-    _instructions[0x95] = instruction("SUB A,L", [](OPCODE_ARGS(cpu)) { sub(cpu, cpu._registers.l); }, 1);
-    _instructions[0xD6] = instruction("SUB A,%x", [](OPCODE_ARGS(cpu, imm)) { sub(cpu, truncate(*imm)); }, 2, 
-                                      sizeof(uint8_t));
-    _instructions[0x96] = instruction("SUB A,(HL)", [](OPCODE_ARGS(cpu)) { 
-        sub(cpu, cpu.getMemoryManager()->read(cpu._registers.hl)); 
-    }, 2);
-}
-
-void
-GameboyInstructionSet8bit::initSbcGroup()
-{
-    static constexpr auto sbc = [](CentralProcessor& cpu, uint8_t value) {
-        auto &flags = cpu._registers.f;
-        uint8_t lowNibbleDiff = (cpu._registers.a & 0xF) - (value & 0xF) - flags.carry;
-        flags.halfCarry = static_cast<bool>(lowNibbleDiff >> 4);
-        flags.carry = sub3_overflow(cpu._registers.a, value, flags.carry, &cpu._registers.a);
-        flags.zero = !cpu._registers.a;
-        flags.subtract = true;
-    };
-    _instructions[0x9F] = instruction("SBC A,A", [](OPCODE_ARGS(cpu)) { sbc(cpu, cpu._registers.a); }, 1);
-    _instructions[0x98] = instruction("SBC A,B", [](OPCODE_ARGS(cpu)) { sbc(cpu, cpu._registers.b); }, 1);
-    _instructions[0x99] = instruction("SBC A,C", [](OPCODE_ARGS(cpu)) { sbc(cpu, cpu._registers.c); }, 1);
-    _instructions[0x9A] = instruction("SBC A,D", [](OPCODE_ARGS(cpu)) { sbc(cpu, cpu._registers.d); }, 1);
-    _instructions[0x9B] = instruction("SBC A,E", [](OPCODE_ARGS(cpu)) { sbc(cpu, cpu._registers.e); }, 1);
-    _instructions[0x9C] = instruction("SBC A,H", [](OPCODE_ARGS(cpu)) { sbc(cpu, cpu._registers.h); }, 1);
-    _instructions[0x9D] = instruction("SBC A,L", [](OPCODE_ARGS(cpu)) { sbc(cpu, cpu._registers.l); }, 1);
-    _instructions[0xDE] = instruction("SBC A,%x", [](OPCODE_ARGS(cpu, imm)) { sbc(cpu, truncate(*imm)); }, 2, 
-                                      sizeof(uint8_t));
-    _instructions[0x9E] = instruction("SBC A,(HL)", [](OPCODE_ARGS(cpu)) { 
-        sbc(cpu, cpu.getMemoryManager()->read(cpu._registers.hl));
-    }, 2);
-}
-
-void
-GameboyInstructionSet8bit::initAndGroup()
-{
-    static constexpr auto and_a = [](CentralProcessor& cpu, uint8_t value) {
-        cpu._registers.a &= value;
-        cpu._registers.setFlags(0, 1, 0, !cpu._registers.a);
-    };
-    _instructions[0xA7] = instruction("AND A,A", [](OPCODE_ARGS(cpu)) { and_a(cpu, cpu._registers.a); }, 1);
-    _instructions[0xA0] = instruction("AND A,B", [](OPCODE_ARGS(cpu)) { and_a(cpu, cpu._registers.b); }, 1);
-    _instructions[0xA1] = instruction("AND A,C", [](OPCODE_ARGS(cpu)) { and_a(cpu, cpu._registers.c); }, 1);
-    _instructions[0xA2] = instruction("AND A,D", [](OPCODE_ARGS(cpu)) { and_a(cpu, cpu._registers.d); }, 1);
-    _instructions[0xA3] = instruction("AND A,E", [](OPCODE_ARGS(cpu)) { and_a(cpu, cpu._registers.e); }, 1);
-    _instructions[0xA4] = instruction("AND A,H", [](OPCODE_ARGS(cpu)) { and_a(cpu, cpu._registers.h); }, 1);
-    _instructions[0xA5] = instruction("AND A,L", [](OPCODE_ARGS(cpu)) { and_a(cpu, cpu._registers.l); }, 1);
-    _instructions[0xE6] = instruction("AND A,%x", [](OPCODE_ARGS(cpu, imm)) { and_a(cpu, truncate(*imm)); }, 2, 
-                                      sizeof(uint8_t));
-    _instructions[0xA6] = instruction("AND A,(HL)", [](OPCODE_ARGS(cpu)) { 
-        and_a(cpu, cpu.getMemoryManager()->read(cpu._registers.hl)); 
-    }, 2);
+/// @brief Subtract a value from register A and set flags.
+static constexpr auto sub = [](CentralProcessor& cpu, uint8_t value) {
+    auto &reg = cpu.getRegisters();
+    uint16_t result = reg.a - value;
+    reg.deferFlags(registers::flagOperation::subtract, reg.a ^ value, result);
+    reg.a = truncate(result);
+};
+OPCODE8(0x97, "SUB A,A", 1) { sub(cpu, cpu._registers.a); }
+OPCODE8(0x90, "SUB A,B", 1) { sub(cpu, cpu._registers.b); }
+OPCODE8(0x91, "SUB A,C", 1) { sub(cpu, cpu._registers.c); }
+OPCODE8(0x92, "SUB A,D", 1) { sub(cpu, cpu._registers.d); }
+OPCODE8(0x93, "SUB A,E", 1) { sub(cpu, cpu._registers.e); }
+OPCODE8(0x94, "SUB A,H", 1) { sub(cpu, cpu._registers.h); }
+OPCODE8(0x95, "SUB A,L", 1) { sub(cpu, cpu._registers.l); }
+OPCODE8(0xD6, "SUB A,%x", 2, sizeof(uint8_t)) { sub(cpu, truncate(imm)); }
+OPCODE8(0x96, "SUB A,(HL)", 2) {
+    sub(cpu, cpu.getMemoryManager()->read(cpu._registers.hl));
 }
 
-void
-GameboyInstructionSet8bit::initOrGroup()
-{
-    static constexpr auto or_a = [](CentralProcessor& cpu, uint8_t value) {
-        cpu._registers.a |= value;
-        cpu._registers.setFlags(0, 0, 0, !cpu._registers.a);
-    };
-    _instructions[0xB7] = instruction("OR A,A", [](OPCODE_ARGS(cpu)) { or_a(cpu, cpu._registers.a); }, 1);
-    _instructions[0xB0] = instruction("OR A,B", [](OPCODE_ARGS(cpu)) { or_a(cpu, cpu._registers.b); }, 1);
-    _instructions[0xB1] = instruction("OR A,C", [](OPCODE_ARGS(cpu)) { or_a(cpu, cpu._registers.c); }, 1);
-    _instructions[0xB2] = instruction("OR A,D", [](OPCODE_ARGS(cpu)) { or_a(cpu, cpu._registers.d); }, 1);
-    _instructions[0xB3] = instruction("OR A,E", [](OPCODE_ARGS(cpu)) { or_a(cpu, cpu._registers.e); }, 1);
-    _instructions[0xB4] = instruction("OR A,H", [](OPCODE_ARGS(cpu)) { or_a(cpu, cpu._registers.h); }, 1);
-    _instructions[0xB5] = instruction("OR A,L", [](OPCODE_ARGS(cpu)) { or_a(cpu, cpu._registers.l); }, 1);
-    _instructions[0xF6] = instruction("OR A,%x", [](OPCODE_ARGS(cpu, imm)) { or_a(cpu, truncate(*imm)); }, 2, 
-                                      sizeof(uint8_t));
-    _instructions[0xB6] = instruction("OR A,(HL)", [](OPCODE_ARGS(cpu)) { 
-        or_a(cpu, cpu.getMemoryManager()->read(cpu._registers.hl)); 
-    }, 2);
+/// @brief Subtract a value (minus carry) from register A and set flags.
+static constexpr auto sbc = [](CentralProcessor& cpu, uint8_t value) {
+    auto &reg = cpu.getRegisters();
+    uint16_t result = reg.a - value - reg.carry();
+    reg.deferFlags(registers::flagOperation::subtract, reg.a ^ value, result);
+    reg.a = truncate(result);
+};
+OPCODE8(0x9F, "SBC A,A", 1) { sbc(cpu, cpu._registers.a); }
+OPCODE8(0x98, "SBC A,B", 1) { sbc(cpu, cpu._registers.b); }
+OPCODE8(0x99, "SBC A,C", 1) { sbc(cpu, cpu._registers.c); }
+OPCODE8(0x9A, "SBC A,D", 1) { sbc(cpu, cpu._registers.d); }
+OPCODE8(0x9B, "SBC A,E", 1) { sbc(cpu, cpu._registers.e); }
+OPCODE8(0x9C, "SBC A,H", 1) { sbc(cpu, cpu._registers.h); }
+OPCODE8(0x9D, "SBC A,L", 1) { sbc(cpu, cpu._registers.l); }
+OPCODE8(0xDE, "SBC A,%x", 2, sizeof(uint8_t)) { sbc(cpu, truncate(imm)); }
+OPCODE8(0x9E, "SBC A,(HL)", 2) {
+    sbc(cpu, cpu.getMemoryManager()->read(cpu._registers.hl));
 }
 
-void
-GameboyInstructionSet8bit::initXorGroup()
-{
-    static constexpr auto xor_a = [](CentralProcessor& cpu, uint8_t value) {
-        cpu._registers.a ^= value;
-        cpu._registers.setFlags(0, 0, 0, !cpu._registers.a);
-    };
-    _instructions[0xAF] = instruction("XOR A,A", [](OPCODE_ARGS(cpu)) { xor_a(cpu, cpu._registers.a); }, 1);
-    _instructions[0xA8] = instruction("XOR A,B", [](OPCODE_ARGS(cpu)) { xor_a(cpu, cpu._registers.b); }, 1);
-    _instructions[0xA9] = instruction("XOR A,C", [](OPCODE_ARGS(cpu)) { xor_a(cpu, cpu._registers.c); }, 1);
-    _instructions[0xAA] = instruction("XOR A,D", [](OPCODE_ARGS(cpu)) { xor_a(cpu, cpu._registers.d); }, 1);
-    _instructions[0xAB] = instruction("XOR A,E", [](OPCODE_ARGS(cpu)) { xor_a(cpu, cpu._registers.e); }, 1);
-    _instructions[0xAC] = instruction("XOR A,H", [](OPCODE_ARGS(cpu)) { xor_a(cpu, cpu._registers.h); }, 1);
-    _instructions[0xAD] = instruction("XOR A,L", [](OPCODE_ARGS(cpu)) { xor_a(cpu, cpu._registers.l); }, 1);
-    _instructions[0xEE] = instruction("XOR A,%x", [](OPCODE_ARGS(cpu, imm)) { xor_a(cpu, truncate(*imm)); }, 2, 
-                                      sizeof(uint8_t));
-    _instructions[0xAE] = instruction("XOR A,(HL)", [](OPCODE_ARGS(cpu)) { 
-        xor_a(cpu, cpu.getMemoryManager()->read(cpu._registers.hl)); 
-    }, 2);
+/// @brief Perform logical AND with register A and another value.
+static constexpr auto and_a = [](CentralProcessor& cpu, uint8_t value) {
+    cpu.getRegisters().a &= value;
+    cpu.getRegisters().deferFlags(registers::flagOperation::bitwiseAnd, 0, cpu.getRegisters().a);
+};
+OPCODE8(0xA7, "AND A,A", 1) { and_a(cpu, cpu._registers.a); }
+OPCODE8(0xA0, "AND A,B", 1) { and_a(cpu, cpu._registers.b); }
+OPCODE8(0xA1, "AND A,C", 1) { and_a(cpu, cpu._registers.c); }
+OPCODE8(0xA2, "AND A,D", 1) { and_a(cpu, cpu._registers.d); }
+OPCODE8(0xA3, "AND A,E", 1) { and_a(cpu, cpu._registers.e); }
+OPCODE8(0xA4, "AND A,H", 1) { and_a(cpu, cpu._registers.h); }
+OPCODE8(0xA5, "AND A,L", 1) { and_a(cpu, cpu._registers.l); }
+OPCODE8(0xE6, "AND A,%x", 2, sizeof(uint8_t)) { and_a(cpu, truncate(imm)); }
+OPCODE8(0xA6, "AND A,(HL)", 2) {
+    and_a(cpu, cpu.getMemoryManager()->read(cpu._registers.hl));
 }
 
-void
-GameboyInstructionSet8bit::initCpGroup()
-{
-    static constexpr auto cp = [](CentralProcessor& cpu, uint8_t value) {
-        auto &flags = cpu._registers.f;
-        uint8_t lowNibbleDiff = (cpu._registers.a & 0xF) - (value & 0xF);
-        flags.halfCarry = static_cast<bool>(lowNibbleDiff >> 4);
-        uint8_t retval = 0;
-        flags.carry = sub_overflow(cpu._registers.a, value, &retval);
-        flags.zero = !retval;
-        flags.subtract = true;
-    };
-    _instructions[0xBF] = instruction("CP A,A", [](OPCODE_ARGS(cpu)) { cp(cpu, cpu._registers.a); }, 1);
-    _instructions[0xB8] = instruction("CP A,B", [](OPCODE_ARGS(cpu)) { cp(cpu, cpu._registers.b); }, 1);
-    _instructions[0xB9] = instruction("CP A,C", [](OPCODE_ARGS(cpu)) { cp(cpu, cpu._registers.c); }, 1);
-    _instructions[0xBA] = instruction("CP A,D", [](OPCODE_ARGS(cpu)) { cp(cpu, cpu._registers.d); }, 1);
-    _instructions[0xBB] = instruction("CP A,E", [](OPCODE_ARGS(cpu)) { cp(cpu, cpu._registers.e); }, 1);
-    _instructions[0xBC] = instruction("CP A,H", [](OPCODE_ARGS(cpu)) { cp(cpu, cpu._registers.h); }, 1);
-    _instructions[0xBD] = instruction("CP A,L", [](OPCODE_ARGS(cpu)) { cp(cpu, cpu._registers.l); }, 1);
-    _instructions[0xFE] = instruction("CP A,%x", [](OPCODE_ARGS(cpu, imm)) { cp(cpu, truncate(*imm)); }, 2, 
-                                      sizeof(uint8_t));
-    _instructions[0xBE] = instruction("CP A,(HL)", [](OPCODE_ARGS(cpu)) {
-        cp(cpu, cpu.getMemoryManager()->read(cpu._registers.hl));
-    }, 2);
+/// @brief Perform logical OR with register A and another value.
+static constexpr auto or_a = [](CentralProcessor& cpu, uint8_t value) {
+    cpu.getRegisters().a |= value;
+    cpu.getRegisters().deferFlags(registers::flagOperation::bitwiseOr, 0, cpu.getRegisters().a);
+};
+OPCODE8(0xB7, "OR A,A", 1) { or_a(cpu, cpu._registers.a); }
+OPCODE8(0xB0, "OR A,B", 1) { or_a(cpu, cpu._registers.b); }
+OPCODE8(0xB1, "OR A,C", 1) { or_a(cpu, cpu._registers.c); }
+OPCODE8(0xB2, "OR A,D", 1) { or_a(cpu, cpu._registers.d); }
+OPCODE8(0xB3, "OR A,E", 1) { or_a(cpu, cpu._registers.e); }
+OPCODE8(0xB4, "OR A,H", 1) { or_a(cpu, cpu._registers.h); }
+OPCODE8(0xB5, "OR A,L", 1) { or_a(cpu, cpu._registers.l); }
+OPCODE8(0xF6, "OR A,%x", 2, sizeof(uint8_t)) { or_a(cpu, truncate(imm)); }
+OPCODE8(0xB6, "OR A,(HL)", 2) {
+    or_a(cpu, cpu.getMemoryManager()->read(cpu._registers.hl));
 }
 
-void
-GameboyInstructionSet8bit::initIncGroup()
-{
-    static constexpr auto inc = [](CentralProcessor& cpu, uint8_t& value) {
-        auto &flags = cpu._registers.f;
-        flags.halfCarry = static_cast<uint8_t>((value & 0xF) == 0xF);
-        value += 1;
-        flags.subtract = false;
-        flags.zero = !value;
-    };
-    _instructions[0x3C] = instruction("INC A", [](OPCODE_ARGS(cpu)) { inc(cpu, cpu._registers.a); }, 1);
-    _instructions[0x04] = instruction("INC B", [](OPCODE_ARGS(cpu)) { inc(cpu, cpu._registers.b); }, 1);
-    _instructions[0x0C] = instruction("INC C", [](OPCODE_ARGS(cpu)) { inc(cpu, cpu._registers.c); }, 1);
-    _instructions[0x14] = instruction("INC D", [](OPCODE_ARGS(cpu)) { inc(cpu, cpu._registers.d); }, 1);
-    _instructions[0x1C] = instruction("INC E", [](OPCODE_ARGS(cpu)) { inc(cpu, cpu._registers.e); }, 1);
-    _instructions[0x24] = instruction("INC H", [](OPCODE_ARGS(cpu)) { inc(cpu, cpu._registers.h); }, 1);
-    _instructions[0x2C] = instruction("INC L", [](OPCODE_ARGS(cpu)) { inc(cpu, cpu._registers.l); }, 1);
-    _instructions[0x34] = instruction("INC (HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t memval = cpu.getMemoryManager()->read(cpu._registers.hl);
-        inc(cpu, memval);
-        cpu.getMemoryManager()->write(cpu._registers.hl, memval); 
-    }, 3);
+/// @brief Perform logical XOR with register A and another value.
+static constexpr auto xor_a = [](CentralProcessor& cpu, uint8_t value) {
+    cpu.getRegisters().a ^= value;
+    cpu.getRegisters().deferFlags(registers::flagOperation::bitwiseOr, 0, cpu.getRegisters().a);
+};
+OPCODE8(0xAF, "XOR A,A", 1) { xor_a(cpu, cpu._registers.a); }
+OPCODE8(0xA8, "XOR A,B", 1) { xor_a(cpu, cpu._registers.b); }
+OPCODE8(0xA9, "XOR A,C", 1) { xor_a(cpu, cpu._registers.c); }
+OPCODE8(0xAA, "XOR A,D", 1) { xor_a(cpu, cpu._registers.d); }
+OPCODE8(0xAB, "XOR A,E", 1) { xor_a(cpu, cpu._registers.e); }
+OPCODE8(0xAC, "XOR A,H", 1) { xor_a(cpu, cpu._registers.h); }
+OPCODE8(0xAD, "XOR A,L", 1) { xor_a(cpu, cpu._registers.l); }
+OPCODE8(0xEE, "XOR A,%x", 2, sizeof(uint8_t)) { xor_a(cpu, truncate(imm)); }
+OPCODE8(0xAE, "XOR A,(HL)", 2) {
+    xor_a(cpu, cpu.getMemoryManager()->read(cpu._registers.hl));
 }
 
-void
-GameboyInstructionSet8bit::initDecGroup()
-{
-    static constexpr auto dec = [](CentralProcessor& cpu, uint8_t& value) {
-        auto &flags = cpu._registers.f;
-        flags.halfCarry = static_cast<uint8_t>((value & 0xF) == 0);
-        value -= 1;
-        flags.subtract = true;
-        flags.zero = !value;
-    };
-    _instructions[0x3D] = instruction("DEC A", [](OPCODE_ARGS(cpu)) { dec(cpu, cpu._registers.a); }, 1);
-    _instructions[0x05] = instruction("DEC B", [](OPCODE_ARGS(cpu)) { dec(cpu, cpu._registers.b); }, 1);
-    _instructions[0x0D] = instruction("DEC C", [](OPCODE_ARGS(cpu)) { dec(cpu, cpu._registers.c); }, 1);
-    _instructions[0x15] = instruction("DEC D", [](OPCODE_ARGS(cpu)) { dec(cpu, cpu._registers.d); }, 1);
-    _instructions[0x1D] = instruction("DEC E", [](OPCODE_ARGS(cpu)) { dec(cpu, cpu._registers.e); }, 1);
-    _instructions[0x25] = instruction("DEC H", [](OPCODE_ARGS(cpu)) { dec(cpu, cpu._registers.h); }, 1);
-    _instructions[0x2D] = instruction("DEC L", [](OPCODE_ARGS(cpu)) { dec(cpu, cpu._registers.l); }, 1);
-    _instructions[0x35] = instruction("DEC (HL)", [](OPCODE_ARGS(cpu)) { 
-        uint8_t memval = cpu.getMemoryManager()->read(cpu._registers.hl);
-        dec(cpu, memval);
-        cpu.getMemoryManager()->write(cpu._registers.hl, memval); 
-    }, 3);
+/// @brief Compare register A with another value, sets flags and discards result.
+static constexpr auto cp = [](CentralProcessor& cpu, uint8_t value) {
+    auto &reg = cpu.getRegisters();
+    reg.deferFlags(registers::flagOperation::subtract, reg.a ^ value, reg.a - value);
+};
+OPCODE8(0xBF, "CP A,A", 1) { cp(cpu, cpu._registers.a); }
+OPCODE8(0xB8, "CP A,B", 1) { cp(cpu, cpu._registers.b); }
+OPCODE8(0xB9, "CP A,C", 1) { cp(cpu, cpu._registers.c); }
+OPCODE8(0xBA, "CP A,D", 1) { cp(cpu, cpu._registers.d); }
+OPCODE8(0xBB, "CP A,E", 1) { cp(cpu, cpu._registers.e); }
+OPCODE8(0xBC, "CP A,H", 1) { cp(cpu, cpu._registers.h); }
+OPCODE8(0xBD, "CP A,L", 1) { cp(cpu, cpu._registers.l); }
+OPCODE8(0xFE, "CP A,%x", 2, sizeof(uint8_t)) { cp(cpu, truncate(imm)); }
+OPCODE8(0xBE, "CP A,(HL)", 2) {
+    cp(cpu, cpu.getMemoryManager()->read(cpu._registers.hl));
 }
 
-void
-GameboyInstructionSet8bit::initAdd16bitGroup()
-{
-    static constexpr auto add_hl = [](CentralProcessor& cpu, uint16_t value) {
-        auto &flags = cpu._registers.f;
-        uint16_t lowSum = (cpu._registers.hl & 0xFFF) + (value & 0xFFF);
-        flags.halfCarry = static_cast<bool>(lowSum >> 12);
-        flags.carry = add_overflow(cpu._registers.hl, value, &cpu._registers.hl);
-        flags.subtract = false;
-    };
-    _instructions[0x09] = instruction("ADD HL,BC", [](OPCODE_ARGS(cpu)) { add_hl(cpu, cpu._registers.bc); }, 2);
-    _instructions[0x19] = instruction("ADD HL,DE", [](OPCODE_ARGS(cpu)) { add_hl(cpu, cpu._registers.de); }, 2);
-    _instructions[0x29] = instruction("ADD HL,HL", [](OPCODE_ARGS(cpu)) { add_hl(cpu, cpu._registers.hl); }, 2);
-    _instructions[0x39] = instruction("ADD HL,SP", [](OPCODE_ARGS(cpu)) { add_hl(cpu, cpu._registers.stackPointer); }, 2);
-    _instructions[0xE8] = instruction("ADD SP,%x", [](OPCODE_ARGS(cpu, imm)) {
-        auto &flags = cpu._registers.f;
-        uint8_t immByte = truncate(*imm);
-        uint16_t lowNibbleSum = (cpu._registers.stackPointer & 0xF) + (immByte & 0xF);
-        flags.halfCarry = static_cast<bool>(lowNibbleSum >> 4);
-        flags.carry = add_overflow(truncate(cpu._registers.stackPointer), immByte);
-        flags.subtract = false;
-        flags.zero = false;
-        cpu._registers.stackPointer += sign_extend(immByte);
-    }, 4, sizeof(uint8_t));
+/// @brief Increment an 8-bit register value, carry is left unchanged.
+static constexpr auto inc = [](CentralProcessor& cpu, uint8_t& value) {
+    auto &reg = cpu.getRegisters();
+    uint8_t result = value + 1;
+    reg.deferFlags(registers::flagOperation::add, value ^ 1, result | (reg.carry() << 8));
+    value = result;
+};
+OPCODE8(0x3C, "INC A", 1) { inc(cpu, cpu._registers.a); }
+OPCODE8(0x04, "INC B", 1) { inc(cpu, cpu._registers.b); }
+OPCODE8(0x0C, "INC C", 1) { inc(cpu, cpu._registers.c); }
+OPCODE8(0x14, "INC D", 1) { inc(cpu, cpu._registers.d); }
+OPCODE8(0x1C, "INC E", 1) { inc(cpu, cpu._registers.e); }
+OPCODE8(0x24, "INC H", 1) { inc(cpu, cpu._registers.h); }
+OPCODE8(0x2C, "INC L", 1) { inc(cpu, cpu._registers.l); }
+OPCODE8(0x34, "INC (HL)", 3) {
+    uint8_t memval = cpu.getMemoryManager()->read(cpu._registers.hl);
+    inc(cpu, memval);
+    cpu.getMemoryManager()->write(cpu._registers.hl, memval);
 }
 
-void
-GameboyInstructionSet8bit::initInc16bitGroup()
-{
-    _instructions[0x03] = instruction("INC BC", [](OPCODE_ARGS(cpu)) { cpu._registers.bc++; }, 2);
-    _instructions[0x13] = instruction("INC DE", [](OPCODE_ARGS(cpu)) { cpu._registers.de++; }, 2);
-    _instructions[0x23] = instruction("INC HL", [](OPCODE_ARGS(cpu)) { cpu._registers.hl++; }, 2);
-    _instructions[0x33] = instruction("INC SP", [](OPCODE_ARGS(cpu)) { cpu._registers.stackPointer++; }, 2);
+/// @brief decrement an 8-bit register value, carry is left unchanged.
+static constexpr auto dec = [](CentralProcessor& cpu, uint8_t& value) {
+    auto &reg = cpu.getRegisters();
+    uint8_t result = value - 1;
+    reg.deferFlags(registers::flagOperation::subtract, value ^ 1, result | (reg.carry() << 8));
+    value = result;
+};
+OPCODE8(0x3D, "DEC A", 1) { dec(cpu, cpu._registers.a); }
+OPCODE8(0x05, "DEC B", 1) { dec(cpu, cpu._registers.b); }
+OPCODE8(0x0D, "DEC C", 1) { dec(cpu, cpu._registers.c); }
+OPCODE8(0x15, "DEC D", 1) { dec(cpu, cpu._registers.d); }
+OPCODE8(0x1D, "DEC E", 1) { dec(cpu, cpu._registers.e); }
+OPCODE8(0x25, "DEC H", 1) { dec(cpu, cpu._registers.h); }
+OPCODE8(0x2D, "DEC L", 1) { dec(cpu, cpu._registers.l); }
+OPCODE8(0x35, "DEC (HL)", 3) {
+    uint8_t memval = cpu.getMemoryManager()->read(cpu._registers.hl);
+    dec(cpu, memval);
+    cpu.getMemoryManager()->write(cpu._registers.hl, memval);
 }
 
-void
-GameboyInstructionSet8bit::initDec16bitGroup()
-{
-    _instructions[0x0B] = instruction("DEC BC", [](OPCODE_ARGS(cpu)) { cpu._registers.bc--; }, 2);
-    _instructions[0x1B] = instruction("DEC DE", [](OPCODE_ARGS(cpu)) { cpu._registers.de--; }, 2);
-    _instructions[0x2B] = instruction("DEC HL", [](OPCODE_ARGS(cpu)) { cpu._registers.hl--; }, 2);
-    _instructions[0x3B] = instruction("DEC SP", [](OPCODE_ARGS(cpu)) { cpu._registers.stackPointer--; }, 2);
+/// @brief Perform 16-bit addition.
+static constexpr auto add_hl = [](CentralProcessor& cpu, uint16_t value) {
+    auto &flags = cpu.getRegisters().getFlags();
+    uint16_t lowSum = (cpu.getRegisters().hl & 0xFFF) + (value & 0xFFF);
+    flags.halfCarry = static_cast<bool>(lowSum >> 12);
+    flags.carry = add_overflow(cpu.getRegisters().hl, value, &cpu.getRegisters().hl);
+    flags.subtract = false;
+};
+OPCODE8(0x09, "ADD HL,BC", 2) { add_hl(cpu, cpu._registers.bc); }
+OPCODE8(0x19, "ADD HL,DE", 2) { add_hl(cpu, cpu._registers.de); }
+OPCODE8(0x29, "ADD HL,HL", 2) { add_hl(cpu, cpu._registers.hl); }
+OPCODE8(0x39, "ADD HL,SP", 2) { add_hl(cpu, cpu._registers.stackPointer); }
+OPCODE8(0xE8, "ADD SP,%x", 4, sizeof(uint8_t)) {
+    auto &flags = cpu._registers.getFlags();
+    uint8_t immByte = truncate(imm);
+    uint16_t lowNibbleSum = (cpu._registers.stackPointer & 0xF) + (immByte & 0xF);
+    flags.halfCarry = static_cast<bool>(lowNibbleSum >> 4);
+    flags.carry = add_overflow(truncate(cpu._registers.stackPointer), immByte);
+    flags.subtract = false;
+    flags.zero = false;
+    cpu._registers.stackPointer += sign_extend(immByte);
 }
 
-void
-GameboyInstructionSet8bit::initDaa()
-{
-    static constexpr auto daa = [](OPCODE_ARGS(cpu)) {
-        flags &flags = cpu._registers.f;
-        /// Borrowed from https://forums.nesdev.org/viewtopic.php?t=15944
-        if (flags.subtract == false)
+/// @brief Increment a 16-bit register.
+OPCODE8(0x03, "INC BC", 2) { cpu._registers.bc++; }
+OPCODE8(0x13, "INC DE", 2) { cpu._registers.de++; }
+OPCODE8(0x23, "INC HL", 2) { cpu._registers.hl++; }
+OPCODE8(0x33, "INC SP", 2) { cpu._registers.stackPointer++; }
+
+/// @brief Decrement a 16-bit register.
+OPCODE8(0x0B, "DEC BC", 2) { cpu._registers.bc--; }
+OPCODE8(0x1B, "DEC DE", 2) { cpu._registers.de--; }
+OPCODE8(0x2B, "DEC HL", 2) { cpu._registers.hl--; }
+OPCODE8(0x3B, "DEC SP", 2) { cpu._registers.stackPointer--; }
+
+/// @brief Perform decimal adjust on register A.
+OPCODE8(0x27, "DAA", 1) {
+    flags &flags = cpu._registers.getFlags();
+    /// Borrowed from https://forums.nesdev.org/viewtopic.php?t=15944
+    if (flags.subtract == false)
+    {
+        if (flags.carry || cpu._registers.a > 0x99)
         {
-            if (flags.carry || cpu._registers.a > 0x99)
-            {
-                cpu._registers.a += 0x60; 
-                flags.carry = static_cast<uint8_t>(true);
-            }
-            if (flags.halfCarry || (cpu._registers.a & 0x0f) > 0x09)
-                cpu._registers.a += 0x6;
+            cpu._registers.a += 0x60;
+            flags.carry = static_cast<uint8_t>(true);
         }
-        else
-        {
-            if (flags.carry)
-                cpu._registers.a -= 0x60;
-            if (flags.halfCarry)
-                cpu._registers.a -= 0x6;
-        };
-        flags.zero = static_cast<uint8_t>(cpu._registers.a == 0);
-        flags.halfCarry = static_cast<uint8_t>(false);
+        if (flags.halfCarry || (cpu._registers.a & 0x0f) > 0x09)
+            cpu._registers.a += 0x6;
+    }
+    else
+    {
+        if (flags.carry)
+            cpu._registers.a -= 0x60;
+        if (flags.halfCarry)
+            cpu._registers.a -= 0x6;
     };
-    _instructions[0x27] = instruction("DAA", daa, 1);
+    flags.zero = static_cast<uint8_t>(cpu._registers.a == 0);
+    flags.halfCarry = static_cast<uint8_t>(false);
 }
 
-void
-GameboyInstructionSet8bit::initCpl()
-{
-    _instructions[0x2F] = instruction("CPL", [](OPCODE_ARGS(cpu)) {
-        flags &flags = cpu._registers.f;
-        cpu._registers.a = ~cpu._registers.a;
-        flags.subtract = true;
-        flags.halfCarry = true;
-    }, 1);
+/// @brief Complement register A.
+OPCODE8(0x2F, "CPL", 1) {
+    flags &flags = cpu._registers.getFlags();
+    cpu._registers.a = ~cpu._registers.a;
+    flags.subtract = true;
+    flags.halfCarry = true;
 }
 
-void
-GameboyInstructionSet8bit::initCcf()
-{
-    _instructions[0x3F] = instruction("CCF", [](OPCODE_ARGS(cpu)) {
-        flags &flags = cpu._registers.f;
-        flags.carry = ~flags.carry;
-        flags.subtract = false;
-        flags.halfCarry = false;
-    }, 1);
+/// @brief Complement the carry flag.
+OPCODE8(0x3F, "CCF", 1) {
+    flags &flags = cpu._registers.getFlags();
+    flags.carry = ~flags.carry;
+    flags.subtract = false;
+    flags.halfCarry = false;
 }
 
-void
-GameboyInstructionSet8bit::initScf()
-{
-    _instructions[0x37] = instruction("SCF", [](OPCODE_ARGS(cpu)) {
-        flags &flags = cpu._registers.f;
-        flags.carry = true;
-        flags.subtract = false;
-        flags.halfCarry = false;
-    }, 1);
+/// @brief Set the carry flag.
+OPCODE8(0x37, "SCF", 1) {
+    flags &flags = cpu._registers.getFlags();
+    flags.carry = true;
+    flags.subtract = false;
+    flags.halfCarry = false;
 }
 
-void
-GameboyInstructionSet8bit::initNop()
-{
-    /// @todo Need to implement this
-    _instructions[0x00] = instruction("NOP", [](OPCODE_ARGS(cpu)) {  }, 1);
+/// @brief No operation.
+/// @todo Need to implement this
+OPCODE8(0x00, "NOP", 1) {  }
+
+/// @brief Halt the CPU until an interrupt is raised.
+OPCODE8(0x76, "HALT", 1) {
+    cpu._halt = true;
 }
 
-void
-GameboyInstructionSet8bit::initHalt()
-{
-    _instructions[0x76] = instruction("HALT", [](OPCODE_ARGS(cpu)) { 
-        cpu._halt = true; }, 1);
+/// @brief Enable/disable interrupt handling.
+OPCODE8(0xF3, "DI", 1) {
+    cpu.setInterruptState(CentralProcessor::interruptState::disabled);
+}
+OPCODE8(0xFB, "EI", 1) {
+    cpu.setInterruptState(CentralProcessor::interruptState::enabled);
 }
 
-void
-GameboyInstructionSet8bit::initInterruptControlGroup()
-{
-    _instructions[0xF3] = instruction("DI", [](OPCODE_ARGS(cpu)) { 
-        cpu.setInterruptState(CentralProcessor::interruptState::disabled); 
-    }, 1);
-    _instructions[0xFB] = instruction("EI", [](OPCODE_ARGS(cpu)) {
-        cpu.setInterruptState(CentralProcessor::interruptState::enabled);
-    }, 1);
+/// @brief Perform left/right bit rotations on register A.
+OPCODE8(0x07, "RLCA", 1) {
+    bool carry = static_cast<bool>(cpu._registers.a & 0x80);
+    cpu._registers.a = (cpu._registers.a << 1) | carry;
+    cpu._registers.setFlags(carry, 0, 0, 0);
+}
+OPCODE8(0x17, "RLA", 1) {
+    bool carry = static_cast<bool>(cpu._registers.a & 0x80);
+    cpu._registers.a = (cpu._registers.a << 1) | cpu._registers.carry();
+    cpu._registers.setFlags(carry, 0, 0, 0);
+}
+OPCODE8(0x0F, "RRCA", 1) {
+    bool carry = static_cast<bool>(cpu._registers.a & 0x1);
+    cpu._registers.a = (cpu._registers.a >> 1) | (carry << 7);
+    cpu._registers.setFlags(carry, 0, 0, 0);
+}
+OPCODE8(0x1F, "RRA", 1) {
+    bool carry = static_cast<bool>(cpu._registers.a & 0x1);
+    cpu._registers.a = (cpu._registers.a >> 1) | (cpu._registers.carry() << 7);
+    cpu._registers.setFlags(carry, 0, 0, 0);
 }
 
-void
-GameboyInstructionSet8bit::initRotateAGroup()
-{
-    _instructions[0x07] = instruction("RLCA", [](OPCODE_ARGS(cpu)) {
-        cpu._registers.f.carry = static_cast<bool>(cpu._registers.a & 0x80);
-        cpu._registers.a = (cpu._registers.a << 1) | cpu._registers.f.carry;
-        cpu._registers.setFlags(cpu._registers.f.carry, 0, 0, 0);
-    }, 1);
-    _instructions[0x17] = instruction("RLA", [](OPCODE_ARGS(cpu)) {
-        bool carry = static_cast<bool>(cpu._registers.a & 0x80);
-        cpu._registers.a = (cpu._registers.a << 1) | cpu._registers.f.carry;
-        cpu._registers.f.carry = carry;
-        cpu._registers.setFlags(cpu._registers.f.carry, 0, 0, 0);
-    }, 1);
-    _instructions[0x0F] = instruction("RRCA", [](OPCODE_ARGS(cpu)) {
-        cpu._registers.f.carry = static_cast<bool>(cpu._registers.a & 0x1);
-        cpu._registers.a = (cpu._registers.a >> 1) | (cpu._registers.f.carry << 7);
-        cpu._registers.setFlags(cpu._registers.f.carry, 0, 0, 0);
-     }, 1);
-    _instructions[0x1F] = instruction("RRA", [](OPCODE_ARGS(cpu)) {
-        bool carry = static_cast<bool>(cpu._registers.a & 0x1);
-        cpu._registers.a = (cpu._registers.a >> 1) | (cpu._registers.f.carry << 7);
-        cpu._registers.f.carry = carry;
-        cpu._registers.setFlags(cpu._registers.f.carry, 0, 0, 0);
-     }, 1);
+/// @brief Jump to an absolute address.
+static constexpr uint8_t kJpInstructionBranchPenalty = 1;
+static constexpr auto jp = [](CentralProcessor &cpu, uint16_t relativeAddress, bool condition = true) {
+    require_or(condition, return);
+    cpu.getRegisters().programCounter = relativeAddress;
+    cpu.setBranchPenalty(kJpInstructionBranchPenalty);
+};
+OPCODE8(0xC3, "JP %x", 3, sizeof(uint16_t)) { jp(cpu, imm); }
+OPCODE8(0xC2, "JP NZ,%x", 3, sizeof(uint16_t)) { jp(cpu, imm, !cpu._registers.zero());  }
+OPCODE8(0xCA, "JP Z,%x", 3, sizeof(uint16_t)) { jp(cpu, imm, cpu._registers.zero());   }
+OPCODE8(0xD2, "JP NC,%x", 3, sizeof(uint16_t)) { jp(cpu, imm, !cpu._registers.carry()); }
+OPCODE8(0xDA, "JP C,%x", 3, sizeof(uint16_t)) { jp(cpu, imm, cpu._registers.carry());  }
+OPCODE8(0xE9, "JP HL", 1) { cpu._registers.programCounter = cpu._registers.hl; }
+
+/// @brief Jump relative to the program counter.
+static constexpr uint8_t kJrInstructionBranchPenalty = 1;
+static constexpr auto jr = [] (CentralProcessor& cpu, uint16_t rel_address, bool condition) {
+    require_or(condition, return);
+    cpu.getRegisters().programCounter += sign_extend(truncate(rel_address));
+    cpu.setBranchPenalty(kJrInstructionBranchPenalty);
+};
+OPCODE8(0x18, "JR %x", 2, sizeof(uint8_t)) { jr(cpu, imm, true); }
+OPCODE8(0x20, "JR NZ,%x", 2, sizeof(uint8_t)) { jr(cpu, imm, !cpu._registers.zero());  }
+OPCODE8(0x28, "JR Z,%x", 2, sizeof(uint8_t)) { jr(cpu, imm, cpu._registers.zero());   }
+OPCODE8(0x30, "JR NC,%x", 2, sizeof(uint8_t)) { jr(cpu, imm, !cpu._registers.carry()); }
+OPCODE8(0x38, "JR C,%x", 2, sizeof(uint8_t)) { jr(cpu, imm, cpu._registers.carry());  }
+
+/// @brief Push the program counter and jump to an absolute address.
+static constexpr uint8_t kCallInstructionBranchPenalty = 3;
+static constexpr auto call = [](CentralProcessor& cpu, uint16_t imm, bool condition = true) {
+    require_or(condition, return);
+    cpu.pushToStack(cpu.getRegisters().programCounter);
+    cpu.getRegisters().programCounter = imm;
+    cpu.setBranchPenalty(kCallInstructionBranchPenalty);
+};
+OPCODE8(0xCD, "CALL %x", 3, sizeof(uint16_t)) { call(cpu, imm); }
+OPCODE8(0xC4, "CALL NZ,%x", 3, sizeof(uint16_t)) { call(cpu, imm, !cpu._registers.zero());  }
+OPCODE8(0xCC, "CALL Z,%x", 3, sizeof(uint16_t)) { call(cpu, imm, cpu._registers.zero());   }
+OPCODE8(0xD4, "CALL NC,%x", 3, sizeof(uint16_t)) { call(cpu, imm, !cpu._registers.carry()); }
+OPCODE8(0xDC, "CALL C,%x", 3, sizeof(uint16_t)) { call(cpu, imm, cpu._registers.carry());  }
+
+/// @brief Push the program counter and jump to a fixed reset vector.
+static constexpr auto reset = [](CentralProcessor& cpu, uint16_t vector) {
+    cpu.pushToStack(cpu.getRegisters().programCounter);
+    cpu.getRegisters().programCounter = vector;
+};
+OPCODE8(0xC7, "RST 00H", 4) { reset(cpu, 0x00);  }
+OPCODE8(0xCF, "RST 08H", 4) { reset(cpu, 0x08);  }
+OPCODE8(0xD7, "RST 10H", 4) { reset(cpu, 0x10);  }
+OPCODE8(0xDF, "RST 18H", 4) { reset(cpu, 0x18);  }
+OPCODE8(0xE7, "RST 20H", 4) { reset(cpu, 0x20);  }
+OPCODE8(0xEF, "RST 28H", 4) { reset(cpu, 0x28);  }
+OPCODE8(0xF7, "RST 30H", 4) { reset(cpu, 0x30);  }
+OPCODE8(0xFF, "RST 38H", 4) { reset(cpu, 0x38);  }
+
+/// @brief Pop the program counter off the stack.
+static constexpr uint8_t kReturnInstructionBranchPenalty = 3;
+static constexpr auto ret = [](CentralProcessor& cpu, bool condition = true) {
+    require_or(condition, return);
+    cpu.getRegisters().programCounter = cpu.popFromStack();
+    cpu.setBranchPenalty(kReturnInstructionBranchPenalty);
+};
+static constexpr auto reti = [](CentralProcessor& cpu) {
+    cpu.setInterruptState(CentralProcessor::interruptState::enabled);
+    cpu.getRegisters().programCounter = cpu.popFromStack();
+};
+OPCODE8(0xC9, "RET", 1) { ret(cpu); }
+OPCODE8(0xC0, "RET NZ", 2) { ret(cpu, !cpu._registers.zero());  }
+OPCODE8(0xC8, "RET Z", 2) { ret(cpu, cpu._registers.zero());   }
+OPCODE8(0xD0, "RET NC", 2) { ret(cpu, !cpu._registers.carry()); }
+OPCODE8(0xD8, "RET C", 2) { ret(cpu, cpu._registers.carry());  }
+OPCODE8(0xD9, "RETI", 4) { reti(cpu); }
+
+/// @brief Swap the upper and lower nibbles of a value.
+static constexpr auto swap = [](CentralProcessor& cpu, uint8_t &value) {
+    value = ((value & 0xF0) >> 4) | ((value & 0x0F) << 4);
+    cpu.getRegisters().setFlags(0, 0, 0, !value);
+};
+OPCODE16(0x37, "SWAP A", 2) { swap(cpu, cpu._registers.a); }
+OPCODE16(0x30, "SWAP B", 2) { swap(cpu, cpu._registers.b); }
+OPCODE16(0x31, "SWAP C", 2) { swap(cpu, cpu._registers.c); }
+OPCODE16(0x32, "SWAP D", 2) { swap(cpu, cpu._registers.d); }
+OPCODE16(0x33, "SWAP E", 2) { swap(cpu, cpu._registers.e); }
+OPCODE16(0x34, "SWAP H", 2) { swap(cpu, cpu._registers.h); }
+OPCODE16(0x35, "SWAP L", 2) { swap(cpu, cpu._registers.l); }
+OPCODE16(0x36, "SWAP (HL)", 4) {
+    uint8_t value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    swap(cpu, value);
+    cpu.getMemoryManager()->write(cpu._registers.hl, value);
 }
 
-void
-GameboyInstructionSet8bit::initJpGroup()
-{
-    static constexpr uint8_t kJpInstructionBranchPenalty = 1;
-    static constexpr auto jp = [](CentralProcessor &cpu, uint16_t relativeAddress, bool condition = true) {
-        require_or(condition, return);
-        cpu._registers.programCounter = relativeAddress;
-        cpu._branchPenalty = kJpInstructionBranchPenalty;
-    };
-    static constexpr uint8_t sz = sizeof(uint16_t);
-    _instructions[0xC3] = instruction("JP %x",    [](OPCODE_ARGS(cpu, imm)) { jp(cpu, *imm); }, 3, sz);
-    _instructions[0xC2] = instruction("JP NZ,%x", [](OPCODE_ARGS(cpu, imm)) { jp(cpu, *imm, !cpu._registers.f.zero);  }, 3, sz);
-    _instructions[0xCA] = instruction("JP Z,%x",  [](OPCODE_ARGS(cpu, imm)) { jp(cpu, *imm, cpu._registers.f.zero);   }, 3, sz);
-    _instructions[0xD2] = instruction("JP NC,%x", [](OPCODE_ARGS(cpu, imm)) { jp(cpu, *imm, !cpu._registers.f.carry); }, 3, sz);
-    _instructions[0xDA] = instruction("JP C,%x",  [](OPCODE_ARGS(cpu, imm)) { jp(cpu, *imm, cpu._registers.f.carry);  }, 3, sz);
-    _instructions[0xE9] = instruction("JP HL", [](OPCODE_ARGS(cpu)) { cpu._registers.programCounter = cpu._registers.hl; }, 1);
+/// @brief Rotate a value left, bit 7 into carry.
+static constexpr auto rlc = [](CentralProcessor& cpu, uint8_t &value) {
+    bool carry = static_cast<bool>(value & 0x80);
+    value = (value << 1) | carry;
+    cpu.getRegisters().setFlags(carry, 0, 0, !value);
+};
+OPCODE16(0x07, "RLC A", 2) { rlc(cpu, cpu._registers.a); }
+OPCODE16(0x00, "RLC B", 2) { rlc(cpu, cpu._registers.b); }
+OPCODE16(0x01, "RLC C", 2) { rlc(cpu, cpu._registers.c); }
+OPCODE16(0x02, "RLC D", 2) { rlc(cpu, cpu._registers.d); }
+OPCODE16(0x03, "RLC E", 2) { rlc(cpu, cpu._registers.e); }
+OPCODE16(0x04, "RLC H", 2) { rlc(cpu, cpu._registers.h); }
+OPCODE16(0x05, "RLC L", 2) { rlc(cpu, cpu._registers.l); }
+OPCODE16(0x06, "RLC (HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    rlc(cpu, mem_value);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
 }
 
-void
-GameboyInstructionSet8bit::initJrGroup()
-{
-    static constexpr uint8_t kJrInstructionBranchPenalty = 1;
-    static constexpr auto jr = [] (CentralProcessor& cpu, uint16_t rel_address, bool condition) {
-        require_or(condition, return);
-        cpu._registers.programCounter += sign_extend(truncate(rel_address));
-        cpu._branchPenalty = kJrInstructionBranchPenalty;
-    };
-    static constexpr uint8_t sz = sizeof(uint8_t);
-    _instructions[0x18] = instruction("JR %x",    [](OPCODE_ARGS(cpu, imm)) { jr(cpu, *imm, true); }, 2, sz);
-    _instructions[0x20] = instruction("JR NZ,%x", [](OPCODE_ARGS(cpu, imm)) { jr(cpu, *imm, !cpu._registers.f.zero);  }, 2, sz);
-    _instructions[0x28] = instruction("JR Z,%x",  [](OPCODE_ARGS(cpu, imm)) { jr(cpu, *imm, cpu._registers.f.zero);   }, 2, sz);
-    _instructions[0x30] = instruction("JR NC,%x", [](OPCODE_ARGS(cpu, imm)) { jr(cpu, *imm, !cpu._registers.f.carry); }, 2, sz);
-    _instructions[0x38] = instruction("JR C,%x",  [](OPCODE_ARGS(cpu, imm)) { jr(cpu, *imm, cpu._registers.f.carry);  }, 2, sz);
+/// @brief Rotate a value left through carry.
+static constexpr auto rl = [](CentralProcessor& cpu, uint8_t &value) {
+    bool carry = static_cast<bool>(value & 0x80);
+    value = (value << 1) | cpu.getRegisters().carry();
+    cpu.getRegisters().setFlags(carry, 0, 0, !value);
+};
+OPCODE16(0x17, "RL A", 2) { rl(cpu, cpu._registers.a); }
+OPCODE16(0x10, "RL B", 2) { rl(cpu, cpu._registers.b); }
+OPCODE16(0x11, "RL C", 2) { rl(cpu, cpu._registers.c); }
+OPCODE16(0x12, "RL D", 2) { rl(cpu, cpu._registers.d); }
+OPCODE16(0x13, "RL E", 2) { rl(cpu, cpu._registers.e); }
+OPCODE16(0x14, "RL H", 2) { rl(cpu, cpu._registers.h); }
+OPCODE16(0x15, "RL L", 2) { rl(cpu, cpu._registers.l); }
+OPCODE16(0x16, "RL (HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    rl(cpu, mem_value);
+    cpu._registers.setFlags(cpu._registers.carry(), 0, 0, !mem_value);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
 }
 
-void
-GameboyInstructionSet8bit::initCallGroup()
-{
-    static constexpr uint8_t kCallInstructionBranchPenalty = 3;
-    static constexpr auto call = [](CentralProcessor& cpu, uint16_t imm, bool condition = true) {
-        require_or(condition, return);
-        cpu.pushToStack(cpu._registers.programCounter);
-        cpu._registers.programCounter = imm;
-        cpu._branchPenalty = kCallInstructionBranchPenalty;
-    };
-    static constexpr uint8_t sz = sizeof(uint16_t);
-    _instructions[0xCD] = instruction("CALL %x", [](OPCODE_ARGS(cpu, imm)) { call(cpu, *imm); }, 3, sz);
-    _instructions[0xC4] = instruction("CALL NZ,%x", [](OPCODE_ARGS(cpu, imm)) { call(cpu, *imm, !cpu._registers.f.zero);  }, 3, sz);
-    _instructions[0xCC] = instruction("CALL Z,%x",  [](OPCODE_ARGS(cpu, imm)) { call(cpu, *imm, cpu._registers.f.zero);   }, 3, sz);
-    _instructions[0xD4] = instruction("CALL NC,%x", [](OPCODE_ARGS(cpu, imm)) { call(cpu, *imm, !cpu._registers.f.carry); }, 3, sz);
-    _instructions[0xDC] = instruction("CALL C,%x",  [](OPCODE_ARGS(cpu, imm)) { call(cpu, *imm, cpu._registers.f.carry);  }, 3, sz);
+/// @brief Rotate a value right, bit 0 into carry.
+static constexpr auto rrc = [](CentralProcessor& cpu, uint8_t &value) {
+    bool carry = static_cast<bool>(value & 0x1);
+    value = (value >> 1) | (carry << 7);
+    cpu.getRegisters().setFlags(carry, 0, 0, !value);
+};
+OPCODE16(0x0F, "RRC A", 2) { rrc(cpu, cpu._registers.a); }
+OPCODE16(0x08, "RRC B", 2) { rrc(cpu, cpu._registers.b); }
+OPCODE16(0x09, "RRC C", 2) { rrc(cpu, cpu._registers.c); }
+OPCODE16(0x0A, "RRC D", 2) { rrc(cpu, cpu._registers.d); }
+OPCODE16(0x0B, "RRC E", 2) { rrc(cpu, cpu._registers.e); }
+OPCODE16(0x0C, "RRC H", 2) { rrc(cpu, cpu._registers.h); }
+OPCODE16(0x0D, "RRC L", 2) { rrc(cpu, cpu._registers.l); }
+OPCODE16(0x0E, "RRC (HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    rrc(cpu, mem_value);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
 }
 
-void
-GameboyInstructionSet8bit::initRstGroup()
-{
-    static constexpr auto reset = [](CentralProcessor& cpu, uint16_t vector) {
-        cpu.pushToStack(cpu._registers.programCounter);
-        cpu._registers.programCounter = vector;
-    };
-    _instructions[0xC7] = instruction("RST 00H", [](OPCODE_ARGS(cpu, imm)) { reset(cpu, 0x00);  }, 4);
-    _instructions[0xCF] = instruction("RST 08H", [](OPCODE_ARGS(cpu, imm)) { reset(cpu, 0x08);  }, 4);
-    _instructions[0xD7] = instruction("RST 10H", [](OPCODE_ARGS(cpu, imm)) { reset(cpu, 0x10);  }, 4);
-    _instructions[0xDF] = instruction("RST 18H", [](OPCODE_ARGS(cpu, imm)) { reset(cpu, 0x18);  }, 4);
-    _instructions[0xE7] = instruction("RST 20H", [](OPCODE_ARGS(cpu, imm)) { reset(cpu, 0x20);  }, 4);
-    _instructions[0xEF] = instruction("RST 28H", [](OPCODE_ARGS(cpu, imm)) { reset(cpu, 0x28);  }, 4);
-    _instructions[0xF7] = instruction("RST 30H", [](OPCODE_ARGS(cpu, imm)) { reset(cpu, 0x30);  }, 4);
-    _instructions[0xFF] = instruction("RST 38H", [](OPCODE_ARGS(cpu, imm)) { reset(cpu, 0x38);  }, 4);
+/// @brief Rotate a value right through carry.
+static constexpr auto rr = [](CentralProcessor& cpu, uint8_t &value) {
+    bool carry = static_cast<bool>(value & 0x1);
+    value = (value >> 1) | (cpu.getRegisters().carry() << 7);
+    cpu.getRegisters().setFlags(carry, 0, 0, !value);
+};
+OPCODE16(0x1F, "RR A", 2) { rr(cpu, cpu._registers.a); }
+OPCODE16(0x18, "RR B", 2) { rr(cpu, cpu._registers.b); }
+OPCODE16(0x19, "RR C", 2) { rr(cpu, cpu._registers.c); }
+OPCODE16(0x1A, "RR D", 2) { rr(cpu, cpu._registers.d); }
+OPCODE16(0x1B, "RR E", 2) { rr(cpu, cpu._registers.e); }
+OPCODE16(0x1C, "RR H", 2) { rr(cpu, cpu._registers.h); }
+OPCODE16(0x1D, "RR L", 2) { rr(cpu, cpu._registers.l); }
+OPCODE16(0x1E, "RR (HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    rr(cpu, mem_value);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
 }
 
-void
-GameboyInstructionSet8bit::initReturnGroup()
-{
-    static constexpr uint8_t kReturnInstructionBranchPenalty = 3;
-    static auto ret = [](CentralProcessor& cpu, bool condition = true) {
-        require_or(condition, return);
-        cpu._registers.programCounter = cpu.popFromStack();
-        cpu._branchPenalty = kReturnInstructionBranchPenalty;
-    };
-    _instructions[0xC9] = instruction("RET",  [](OPCODE_ARGS(cpu)) { ret(cpu); }, 1);
-    _instructions[0xC0] = instruction("RET NZ", [](OPCODE_ARGS(cpu, imm)) { ret(cpu, !cpu._registers.f.zero);  }, 2);
-    _instructions[0xC8] = instruction("RET Z",  [](OPCODE_ARGS(cpu, imm)) { ret(cpu, cpu._registers.f.zero);   }, 2);
-    _instructions[0xD0] = instruction("RET NC", [](OPCODE_ARGS(cpu, imm)) { ret(cpu, !cpu._registers.f.carry); }, 2);
-    _instructions[0xD8] = instruction("RET C",  [](OPCODE_ARGS(cpu, imm)) { ret(cpu, cpu._registers.f.carry);  }, 2);
-    
-    static constexpr auto reti = [](CentralProcessor& cpu) {
-        cpu.setInterruptState(CentralProcessor::interruptState::enabled);
-        cpu._registers.programCounter = cpu.popFromStack();
-    };
-    _instructions[0xD9] = instruction("RETI",  [](OPCODE_ARGS(cpu)) { reti(cpu); }, 4);
+/// @brief Shift a value left into carry.
+static constexpr auto sla = [](CentralProcessor& cpu, uint8_t &value) {
+    bool carry = static_cast<bool>(value & 0x80);
+    value = (value << 1) & 0xFE;
+    cpu.getRegisters().setFlags(carry, 0, 0, !value);
+};
+OPCODE16(0x27, "SLA A", 2) { sla(cpu, cpu._registers.a); }
+OPCODE16(0x20, "SLA B", 2) { sla(cpu, cpu._registers.b); }
+OPCODE16(0x21, "SLA C", 2) { sla(cpu, cpu._registers.c); }
+OPCODE16(0x22, "SLA D", 2) { sla(cpu, cpu._registers.d); }
+OPCODE16(0x23, "SLA E", 2) { sla(cpu, cpu._registers.e); }
+OPCODE16(0x24, "SLA H", 2) { sla(cpu, cpu._registers.h); }
+OPCODE16(0x25, "SLA L", 2) { sla(cpu, cpu._registers.l); }
+OPCODE16(0x26, "SLA (HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    sla(cpu, mem_value);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
 }
 
-GameboyInstructionSet16bit::GameboyInstructionSet16bit(): InstructionSet(kInstructionArraySize)
-{
-    initSwapGroup();
-    initRlcGroup();
-    initRlGroup();
-    initRrcGroup();
-    initRrGroup();
-    initSlaGroup();
-    initSraGroup();
-    initSrlGroup();
-    initBitGroup();
-    initSetGroup();
-    initResGroup();
+/// @brief Arithmetic shift a value right into carry.
+static constexpr auto sra = [](CentralProcessor& cpu, uint8_t &value) {
+    bool carry = static_cast<bool>(value & 0x1);
+    value = ((value >> 1) & 0x7F) | (value & 0x80);
+    cpu.getRegisters().setFlags(carry, 0, 0, !value);
+};
+OPCODE16(0x2F, "SRA A", 2) { sra(cpu, cpu._registers.a); }
+OPCODE16(0x28, "SRA B", 2) { sra(cpu, cpu._registers.b); }
+OPCODE16(0x29, "SRA C", 2) { sra(cpu, cpu._registers.c); }
+OPCODE16(0x2A, "SRA D", 2) { sra(cpu, cpu._registers.d); }
+OPCODE16(0x2B, "SRA E", 2) { sra(cpu, cpu._registers.e); }
+OPCODE16(0x2C, "SRA H", 2) { sra(cpu, cpu._registers.h); }
+OPCODE16(0x2D, "SRA L", 2) { sra(cpu, cpu._registers.l); }
+OPCODE16(0x2E, "SRA (HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    sra(cpu, mem_value);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
 }
 
-void
-GameboyInstructionSet16bit::initSwapGroup()
-{
-    static constexpr auto swap = [](CentralProcessor& cpu, uint8_t &value) {
-        value = ((value & 0xF0) >> 4) | ((value & 0x0F) << 4);
-        cpu._registers.setFlags(0, 0, 0, !value);
-    };
-    _instructions[0x37] = instruction("SWAP A", [](OPCODE_ARGS(cpu)) { swap(cpu, cpu._registers.a); }, 2);
-    _instructions[0x30] = instruction("SWAP B", [](OPCODE_ARGS(cpu)) { swap(cpu, cpu._registers.b); }, 2);
-    _instructions[0x31] = instruction("SWAP C", [](OPCODE_ARGS(cpu)) { swap(cpu, cpu._registers.c); }, 2);
-    _instructions[0x32] = instruction("SWAP D", [](OPCODE_ARGS(cpu)) { swap(cpu, cpu._registers.d); }, 2);
-    _instructions[0x33] = instruction("SWAP E", [](OPCODE_ARGS(cpu)) { swap(cpu, cpu._registers.e); }, 2);
-    _instructions[0x34] = instruction("SWAP H", [](OPCODE_ARGS(cpu)) { swap(cpu, cpu._registers.h); }, 2);
-    _instructions[0x35] = instruction("SWAP L", [](OPCODE_ARGS(cpu)) { swap(cpu, cpu._registers.l); }, 2);
-    _instructions[0x36] = instruction("SWAP (HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        swap(cpu, value);
-        cpu.getMemoryManager()->write(cpu._registers.hl, value);
-    }, 4);
+/// @brief Logical shift a value right into carry.
+static constexpr auto srl = [](CentralProcessor& cpu, uint8_t &value) {
+    bool carry = static_cast<bool>(value & 0x1);
+    value = (value >> 1) & 0x7F;
+    cpu.getRegisters().setFlags(carry, 0, 0, !value);
+};
+OPCODE16(0x3F, "SRL A", 2) { srl(cpu, cpu._registers.a); }
+OPCODE16(0x38, "SRL B", 2) { srl(cpu, cpu._registers.b); }
+OPCODE16(0x39, "SRL C", 2) { srl(cpu, cpu._registers.c); }
+OPCODE16(0x3A, "SRL D", 2) { srl(cpu, cpu._registers.d); }
+OPCODE16(0x3B, "SRL E", 2) { srl(cpu, cpu._registers.e); }
+OPCODE16(0x3C, "SRL H", 2) { srl(cpu, cpu._registers.h); }
+OPCODE16(0x3D, "SRL L", 2) { srl(cpu, cpu._registers.l); }
+OPCODE16(0x3E, "SRL (HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    srl(cpu, mem_value);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
 }
 
-void
-GameboyInstructionSet16bit::initRlcGroup()
-{
-    static constexpr auto rlc = [](CentralProcessor& cpu, uint8_t &value) {
-        cpu._registers.f.carry = static_cast<bool>(value & 0x80);
-        value = (value << 1) | cpu._registers.f.carry;
-        cpu._registers.setFlags(cpu._registers.f.carry, 0, 0, !value);
-    };
-    _instructions[0x07] = instruction("RLC A", [](OPCODE_ARGS(cpu)) { rlc(cpu, cpu._registers.a); }, 2);
-    _instructions[0x00] = instruction("RLC B", [](OPCODE_ARGS(cpu)) { rlc(cpu, cpu._registers.b); }, 2);
-    _instructions[0x01] = instruction("RLC C", [](OPCODE_ARGS(cpu)) { rlc(cpu, cpu._registers.c); }, 2);
-    _instructions[0x02] = instruction("RLC D", [](OPCODE_ARGS(cpu)) { rlc(cpu, cpu._registers.d); }, 2);
-    _instructions[0x03] = instruction("RLC E", [](OPCODE_ARGS(cpu)) { rlc(cpu, cpu._registers.e); }, 2);
-    _instructions[0x04] = instruction("RLC H", [](OPCODE_ARGS(cpu)) { rlc(cpu, cpu._registers.h); }, 2);
-    _instructions[0x05] = instruction("RLC L", [](OPCODE_ARGS(cpu)) { rlc(cpu, cpu._registers.l); }, 2);
-    _instructions[0x06] = instruction("RLC (HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        rlc(cpu, mem_value);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
+/// @brief Test a bit of a value.
+static constexpr auto bit = [](CentralProcessor& cpu, uint8_t &value, uint8_t bit) {
+    cpu.getRegisters().setFlags(cpu.getRegisters().carry(), 1, 0, !get_bit(value, bit));
+};
+OPCODE16(0x47, "BIT 0,A", 2) { bit(cpu, cpu._registers.a, 0); }
+OPCODE16(0x40, "BIT 0,B", 2) { bit(cpu, cpu._registers.b, 0); }
+OPCODE16(0x41, "BIT 0,C", 2) { bit(cpu, cpu._registers.c, 0); }
+OPCODE16(0x42, "BIT 0,D", 2) { bit(cpu, cpu._registers.d, 0); }
+OPCODE16(0x43, "BIT 0,E", 2) { bit(cpu, cpu._registers.e, 0); }
+OPCODE16(0x44, "BIT 0,H", 2) { bit(cpu, cpu._registers.h, 0); }
+OPCODE16(0x45, "BIT 0,L", 2) { bit(cpu, cpu._registers.l, 0); }
+OPCODE16(0x46, "BIT 0,(HL)", 3) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    bit(cpu, mem_value, 0);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0x4F, "BIT 1,A", 2) { bit(cpu, cpu._registers.a, 1); }
+OPCODE16(0x48, "BIT 1,B", 2) { bit(cpu, cpu._registers.b, 1); }
+OPCODE16(0x49, "BIT 1,C", 2) { bit(cpu, cpu._registers.c, 1); }
+OPCODE16(0x4A, "BIT 1,D", 2) { bit(cpu, cpu._registers.d, 1); }
+OPCODE16(0x4B, "BIT 1,E", 2) { bit(cpu, cpu._registers.e, 1); }
+OPCODE16(0x4C, "BIT 1,H", 2) { bit(cpu, cpu._registers.h, 1); }
+OPCODE16(0x4D, "BIT 1,L", 2) { bit(cpu, cpu._registers.l, 1); }
+OPCODE16(0x4E, "BIT 1,(HL)", 3) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    bit(cpu, mem_value, 1);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0x57, "BIT 2,A", 2) { bit(cpu, cpu._registers.a, 2); }
+OPCODE16(0x50, "BIT 2,B", 2) { bit(cpu, cpu._registers.b, 2); }
+OPCODE16(0x51, "BIT 2,C", 2) { bit(cpu, cpu._registers.c, 2); }
+OPCODE16(0x52, "BIT 2,D", 2) { bit(cpu, cpu._registers.d, 2); }
+OPCODE16(0x53, "BIT 2,E", 2) { bit(cpu, cpu._registers.e, 2); }
+OPCODE16(0x54, "BIT 2,H", 2) { bit(cpu, cpu._registers.h, 2); }
+OPCODE16(0x55, "BIT 2,L", 2) { bit(cpu, cpu._registers.l, 2); }
+OPCODE16(0x56, "BIT 2,(HL)", 3) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    bit(cpu, mem_value, 2);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0x5F, "BIT 3,A", 2) { bit(cpu, cpu._registers.a, 3); }
+OPCODE16(0x58, "BIT 3,B", 2) { bit(cpu, cpu._registers.b, 3); }
+OPCODE16(0x59, "BIT 3,C", 2) { bit(cpu, cpu._registers.c, 3); }
+OPCODE16(0x5A, "BIT 3,D", 2) { bit(cpu, cpu._registers.d, 3); }
+OPCODE16(0x5B, "BIT 3,E", 2) { bit(cpu, cpu._registers.e, 3); }
+OPCODE16(0x5C, "BIT 3,H", 2) { bit(cpu, cpu._registers.h, 3); }
+OPCODE16(0x5D, "BIT 3,L", 2) { bit(cpu, cpu._registers.l, 3); }
+OPCODE16(0x5E, "BIT 3,(HL)", 3) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    bit(cpu, mem_value, 3);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0x67, "BIT 4,A", 2) { bit(cpu, cpu._registers.a, 4); }
+OPCODE16(0x60, "BIT 4,B", 2) { bit(cpu, cpu._registers.b, 4); }
+OPCODE16(0x61, "BIT 4,C", 2) { bit(cpu, cpu._registers.c, 4); }
+OPCODE16(0x62, "BIT 4,D", 2) { bit(cpu, cpu._registers.d, 4); }
+OPCODE16(0x63, "BIT 4,E", 2) { bit(cpu, cpu._registers.e, 4); }
+OPCODE16(0x64, "BIT 4,H", 2) { bit(cpu, cpu._registers.h, 4); }
+OPCODE16(0x65, "BIT 4,L", 2) { bit(cpu, cpu._registers.l, 4); }
+OPCODE16(0x66, "BIT 4,(HL)", 3) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    bit(cpu, mem_value, 4);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0x6F, "BIT 5,A", 2) { bit(cpu, cpu._registers.a, 5); }
+OPCODE16(0x68, "BIT 5,B", 2) { bit(cpu, cpu._registers.b, 5); }
+OPCODE16(0x69, "BIT 5,C", 2) { bit(cpu, cpu._registers.c, 5); }
+OPCODE16(0x6A, "BIT 5,D", 2) { bit(cpu, cpu._registers.d, 5); }
+OPCODE16(0x6B, "BIT 5,E", 2) { bit(cpu, cpu._registers.e, 5); }
+OPCODE16(0x6C, "BIT 5,H", 2) { bit(cpu, cpu._registers.h, 5); }
+OPCODE16(0x6D, "BIT 5,L", 2) { bit(cpu, cpu._registers.l, 5); }
+OPCODE16(0x6E, "BIT 5,(HL)", 3) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    bit(cpu, mem_value, 5);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0x77, "BIT 6,A", 2) { bit(cpu, cpu._registers.a, 6); }
+OPCODE16(0x70, "BIT 6,B", 2) { bit(cpu, cpu._registers.b, 6); }
+OPCODE16(0x71, "BIT 6,C", 2) { bit(cpu, cpu._registers.c, 6); }
+OPCODE16(0x72, "BIT 6,D", 2) { bit(cpu, cpu._registers.d, 6); }
+OPCODE16(0x73, "BIT 6,E", 2) { bit(cpu, cpu._registers.e, 6); }
+OPCODE16(0x74, "BIT 6,H", 2) { bit(cpu, cpu._registers.h, 6); }
+OPCODE16(0x75, "BIT 6,L", 2) { bit(cpu, cpu._registers.l, 6); }
+OPCODE16(0x76, "BIT 6,(HL)", 3) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    bit(cpu, mem_value, 6);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0x7F, "BIT 7,A", 2) { bit(cpu, cpu._registers.a, 7); }
+OPCODE16(0x78, "BIT 7,B", 2) { bit(cpu, cpu._registers.b, 7); }
+OPCODE16(0x79, "BIT 7,C", 2) { bit(cpu, cpu._registers.c, 7); }
+OPCODE16(0x7A, "BIT 7,D", 2) { bit(cpu, cpu._registers.d, 7); }
+OPCODE16(0x7B, "BIT 7,E", 2) { bit(cpu, cpu._registers.e, 7); }
+OPCODE16(0x7C, "BIT 7,H", 2) { bit(cpu, cpu._registers.h, 7); }
+OPCODE16(0x7D, "BIT 7,L", 2) { bit(cpu, cpu._registers.l, 7); }
+OPCODE16(0x7E, "BIT 7,(HL)", 3) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    bit(cpu, mem_value, 7);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
 }
 
-void
-GameboyInstructionSet16bit::initRlGroup()
-{
-    static constexpr auto rl = [](CentralProcessor& cpu, uint8_t &value) {
-        bool carry = static_cast<bool>(value & 0x80);
-        value = (value << 1) | cpu._registers.f.carry;
-        cpu._registers.f.carry = carry;
-        cpu._registers.setFlags(cpu._registers.f.carry, 0, 0, !value);
-    };
-    _instructions[0x17] = instruction("RL A", [](OPCODE_ARGS(cpu)) { rl(cpu, cpu._registers.a); }, 2);
-    _instructions[0x10] = instruction("RL B", [](OPCODE_ARGS(cpu)) { rl(cpu, cpu._registers.b); }, 2);
-    _instructions[0x11] = instruction("RL C", [](OPCODE_ARGS(cpu)) { rl(cpu, cpu._registers.c); }, 2);
-    _instructions[0x12] = instruction("RL D", [](OPCODE_ARGS(cpu)) { rl(cpu, cpu._registers.d); }, 2);
-    _instructions[0x13] = instruction("RL E", [](OPCODE_ARGS(cpu)) { rl(cpu, cpu._registers.e); }, 2);
-    _instructions[0x14] = instruction("RL H", [](OPCODE_ARGS(cpu)) { rl(cpu, cpu._registers.h); }, 2);
-    _instructions[0x15] = instruction("RL L", [](OPCODE_ARGS(cpu)) { rl(cpu, cpu._registers.l); }, 2);
-    _instructions[0x16] = instruction("RL (HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        rl(cpu, mem_value);
-        cpu._registers.setFlags(cpu._registers.f.carry, 0, 0, !mem_value);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
+/// @brief Set a bit of a value.
+OPCODE16(0xC7, "SET 0,A", 2) { set_bit(cpu._registers.a, 0); }
+OPCODE16(0xC0, "SET 0,B", 2) { set_bit(cpu._registers.b, 0); }
+OPCODE16(0xC1, "SET 0,C", 2) { set_bit(cpu._registers.c, 0); }
+OPCODE16(0xC2, "SET 0,D", 2) { set_bit(cpu._registers.d, 0); }
+OPCODE16(0xC3, "SET 0,E", 2) { set_bit(cpu._registers.e, 0); }
+OPCODE16(0xC4, "SET 0,H", 2) { set_bit(cpu._registers.h, 0); }
+OPCODE16(0xC5, "SET 0,L", 2) { set_bit(cpu._registers.l, 0); }
+OPCODE16(0xC6, "SET 0,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    set_bit(mem_value, 0);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0xCF, "SET 1,A", 2) { set_bit(cpu._registers.a, 1); }
+OPCODE16(0xC8, "SET 1,B", 2) { set_bit(cpu._registers.b, 1); }
+OPCODE16(0xC9, "SET 1,C", 2) { set_bit(cpu._registers.c, 1); }
+OPCODE16(0xCA, "SET 1,D", 2) { set_bit(cpu._registers.d, 1); }
+OPCODE16(0xCB, "SET 1,E", 2) { set_bit(cpu._registers.e, 1); }
+OPCODE16(0xCC, "SET 1,H", 2) { set_bit(cpu._registers.h, 1); }
+OPCODE16(0xCD, "SET 1,L", 2) { set_bit(cpu._registers.l, 1); }
+OPCODE16(0xCE, "SET 1,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    set_bit(mem_value, 1);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0xD7, "SET 2,A", 2) { set_bit(cpu._registers.a, 2); }
+OPCODE16(0xD0, "SET 2,B", 2) { set_bit(cpu._registers.b, 2); }
+OPCODE16(0xD1, "SET 2,C", 2) { set_bit(cpu._registers.c, 2); }
+OPCODE16(0xD2, "SET 2,D", 2) { set_bit(cpu._registers.d, 2); }
+OPCODE16(0xD3, "SET 2,E", 2) { set_bit(cpu._registers.e, 2); }
+OPCODE16(0xD4, "SET 2,H", 2) { set_bit(cpu._registers.h, 2); }
+OPCODE16(0xD5, "SET 2,L", 2) { set_bit(cpu._registers.l, 2); }
+OPCODE16(0xD6, "SET 2,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    set_bit(mem_value, 2);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0xDF, "SET 3,A", 2) { set_bit(cpu._registers.a, 3); }
+OPCODE16(0xD8, "SET 3,B", 2) { set_bit(cpu._registers.b, 3); }
+OPCODE16(0xD9, "SET 3,C", 2) { set_bit(cpu._registers.c, 3); }
+OPCODE16(0xDA, "SET 3,D", 2) { set_bit(cpu._registers.d, 3); }
+OPCODE16(0xDB, "SET 3,E", 2) { set_bit(cpu._registers.e, 3); }
+OPCODE16(0xDC, "SET 3,H", 2) { set_bit(cpu._registers.h, 3); }
+OPCODE16(0xDD, "SET 3,L", 2) { set_bit(cpu._registers.l, 3); }
+OPCODE16(0xDE, "SET 3,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    set_bit(mem_value, 3);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0xE7, "SET 4,A", 2) { set_bit(cpu._registers.a, 4); }
+OPCODE16(0xE0, "SET 4,B", 2) { set_bit(cpu._registers.b, 4); }
+OPCODE16(0xE1, "SET 4,C", 2) { set_bit(cpu._registers.c, 4); }
+OPCODE16(0xE2, "SET 4,D", 2) { set_bit(cpu._registers.d, 4); }
+OPCODE16(0xE3, "SET 4,E", 2) { set_bit(cpu._registers.e, 4); }
+OPCODE16(0xE4, "SET 4,H", 2) { set_bit(cpu._registers.h, 4); }
+OPCODE16(0xE5, "SET 4,L", 2) { set_bit(cpu._registers.l, 4); }
+OPCODE16(0xE6, "SET 4,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    set_bit(mem_value, 4);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0xEF, "SET 5,A", 2) { set_bit(cpu._registers.a, 5); }
+OPCODE16(0xE8, "SET 5,B", 2) { set_bit(cpu._registers.b, 5); }
+OPCODE16(0xE9, "SET 5,C", 2) { set_bit(cpu._registers.c, 5); }
+OPCODE16(0xEA, "SET 5,D", 2) { set_bit(cpu._registers.d, 5); }
+OPCODE16(0xEB, "SET 5,E", 2) { set_bit(cpu._registers.e, 5); }
+OPCODE16(0xEC, "SET 5,H", 2) { set_bit(cpu._registers.h, 5); }
+OPCODE16(0xED, "SET 5,L", 2) { set_bit(cpu._registers.l, 5); }
+OPCODE16(0xEE, "SET 5,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    set_bit(mem_value, 5);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0xF7, "SET 6,A", 2) { set_bit(cpu._registers.a, 6); }
+OPCODE16(0xF0, "SET 6,B", 2) { set_bit(cpu._registers.b, 6); }
+OPCODE16(0xF1, "SET 6,C", 2) { set_bit(cpu._registers.c, 6); }
+OPCODE16(0xF2, "SET 6,D", 2) { set_bit(cpu._registers.d, 6); }
+OPCODE16(0xF3, "SET 6,E", 2) { set_bit(cpu._registers.e, 6); }
+OPCODE16(0xF4, "SET 6,H", 2) { set_bit(cpu._registers.h, 6); }
+OPCODE16(0xF5, "SET 6,L", 2) { set_bit(cpu._registers.l, 6); }
+OPCODE16(0xF6, "SET 6,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    set_bit(mem_value, 6);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0xFF, "SET 7,A", 2) { set_bit(cpu._registers.a, 7); }
+OPCODE16(0xF8, "SET 7,B", 2) { set_bit(cpu._registers.b, 7); }
+OPCODE16(0xF9, "SET 7,C", 2) { set_bit(cpu._registers.c, 7); }
+OPCODE16(0xFA, "SET 7,D", 2) { set_bit(cpu._registers.d, 7); }
+OPCODE16(0xFB, "SET 7,E", 2) { set_bit(cpu._registers.e, 7); }
+OPCODE16(0xFC, "SET 7,H", 2) { set_bit(cpu._registers.h, 7); }
+OPCODE16(0xFD, "SET 7,L", 2) { set_bit(cpu._registers.l, 7); }
+OPCODE16(0xFE, "SET 7,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    set_bit(mem_value, 7);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
 }
 
-void
-GameboyInstructionSet16bit::initRrcGroup()
-{
-    static constexpr auto rrc = [](CentralProcessor& cpu, uint8_t &value) {
-        cpu._registers.f.carry = static_cast<bool>(value & 0x1);
-        value = (value >> 1) | (cpu._registers.f.carry << 7);
-        cpu._registers.setFlags(cpu._registers.f.carry, 0, 0, !value);
-    };
-    _instructions[0x0F] = instruction("RRC A", [](OPCODE_ARGS(cpu)) { rrc(cpu, cpu._registers.a); }, 2);
-    _instructions[0x08] = instruction("RRC B", [](OPCODE_ARGS(cpu)) { rrc(cpu, cpu._registers.b); }, 2);
-    _instructions[0x09] = instruction("RRC C", [](OPCODE_ARGS(cpu)) { rrc(cpu, cpu._registers.c); }, 2);
-    _instructions[0x0A] = instruction("RRC D", [](OPCODE_ARGS(cpu)) { rrc(cpu, cpu._registers.d); }, 2);
-    _instructions[0x0B] = instruction("RRC E", [](OPCODE_ARGS(cpu)) { rrc(cpu, cpu._registers.e); }, 2);
-    _instructions[0x0C] = instruction("RRC H", [](OPCODE_ARGS(cpu)) { rrc(cpu, cpu._registers.h); }, 2);
-    _instructions[0x0D] = instruction("RRC L", [](OPCODE_ARGS(cpu)) { rrc(cpu, cpu._registers.l); }, 2);
-    _instructions[0x0E] = instruction("RRC (HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        rrc(cpu, mem_value);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
+/// @brief Clear a bit of a value.
+OPCODE16(0x87, "RES 0,A", 2) { clear_bit(cpu._registers.a, 0); }
+OPCODE16(0x80, "RES 0,B", 2) { clear_bit(cpu._registers.b, 0); }
+OPCODE16(0x81, "RES 0,C", 2) { clear_bit(cpu._registers.c, 0); }
+OPCODE16(0x82, "RES 0,D", 2) { clear_bit(cpu._registers.d, 0); }
+OPCODE16(0x83, "RES 0,E", 2) { clear_bit(cpu._registers.e, 0); }
+OPCODE16(0x84, "RES 0,H", 2) { clear_bit(cpu._registers.h, 0); }
+OPCODE16(0x85, "RES 0,L", 2) { clear_bit(cpu._registers.l, 0); }
+OPCODE16(0x86, "RES 0,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    clear_bit(mem_value, 0);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
 }
+OPCODE16(0x8F, "RES 1,A", 2) { clear_bit(cpu._registers.a, 1); }
+OPCODE16(0x88, "RES 1,B", 2) { clear_bit(cpu._registers.b, 1); }
+OPCODE16(0x89, "RES 1,C", 2) { clear_bit(cpu._registers.c, 1); }
+OPCODE16(0x8A, "RES 1,D", 2) { clear_bit(cpu._registers.d, 1); }
+OPCODE16(0x8B, "RES 1,E", 2) { clear_bit(cpu._registers.e, 1); }
+OPCODE16(0x8C, "RES 1,H", 2) { clear_bit(cpu._registers.h, 1); }
+OPCODE16(0x8D, "RES 1,L", 2) { clear_bit(cpu._registers.l, 1); }
+OPCODE16(0x8E, "RES 1,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    clear_bit(mem_value, 1);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0x97, "RES 2,A", 2) { clear_bit(cpu._registers.a, 2); }
+OPCODE16(0x90, "RES 2,B", 2) { clear_bit(cpu._registers.b, 2); }
+OPCODE16(0x91, "RES 2,C", 2) { clear_bit(cpu._registers.c, 2); }
+OPCODE16(0x92, "RES 2,D", 2) { clear_bit(cpu._registers.d, 2); }
+OPCODE16(0x93, "RES 2,E", 2) { clear_bit(cpu._registers.e, 2); }
+OPCODE16(0x94, "RES 2,H", 2) { clear_bit(cpu._registers.h, 2); }
+OPCODE16(0x95, "RES 2,L", 2) { clear_bit(cpu._registers.l, 2); }
+OPCODE16(0x96, "RES 2,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    clear_bit(mem_value, 2);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0x9F, "RES 3,A", 2) { clear_bit(cpu._registers.a, 3); }
+OPCODE16(0x98, "RES 3,B", 2) { clear_bit(cpu._registers.b, 3); }
+OPCODE16(0x99, "RES 3,C", 2) { clear_bit(cpu._registers.c, 3); }
+OPCODE16(0x9A, "RES 3,D", 2) { clear_bit(cpu._registers.d, 3); }
+OPCODE16(0x9B, "RES 3,E", 2) { clear_bit(cpu._registers.e, 3); }
+OPCODE16(0x9C, "RES 3,H", 2) { clear_bit(cpu._registers.h, 3); }
+OPCODE16(0x9D, "RES 3,L", 2) { clear_bit(cpu._registers.l, 3); }
+OPCODE16(0x9E, "RES 3,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    clear_bit(mem_value, 3);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0xA7, "RES 4,A", 2) { clear_bit(cpu._registers.a, 4); }
+OPCODE16(0xA0, "RES 4,B", 2) { clear_bit(cpu._registers.b, 4); }
+OPCODE16(0xA1, "RES 4,C", 2) { clear_bit(cpu._registers.c, 4); }
+OPCODE16(0xA2, "RES 4,D", 2) { clear_bit(cpu._registers.d, 4); }
+OPCODE16(0xA3, "RES 4,E", 2) { clear_bit(cpu._registers.e, 4); }
+OPCODE16(0xA4, "RES 4,H", 2) { clear_bit(cpu._registers.h, 4); }
+OPCODE16(0xA5, "RES 4,L", 2) { clear_bit(cpu._registers.l, 4); }
+OPCODE16(0xA6, "RES 4,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    clear_bit(mem_value, 4);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0xAF, "RES 5,A", 2) { clear_bit(cpu._registers.a, 5); }
+OPCODE16(0xA8, "RES 5,B", 2) { clear_bit(cpu._registers.b, 5); }
+OPCODE16(0xA9, "RES 5,C", 2) { clear_bit(cpu._registers.c, 5); }
+OPCODE16(0xAA, "RES 5,D", 2) { clear_bit(cpu._registers.d, 5); }
+OPCODE16(0xAB, "RES 5,E", 2) { clear_bit(cpu._registers.e, 5); }
+OPCODE16(0xAC, "RES 5,H", 2) { clear_bit(cpu._registers.h, 5); }
+OPCODE16(0xAD, "RES 5,L", 2) { clear_bit(cpu._registers.l, 5); }
+OPCODE16(0xAE, "RES 5,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    clear_bit(mem_value, 5);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0xB7, "RES 6,A", 2) { clear_bit(cpu._registers.a, 6); }
+OPCODE16(0xB0, "RES 6,B", 2) { clear_bit(cpu._registers.b, 6); }
+OPCODE16(0xB1, "RES 6,C", 2) { clear_bit(cpu._registers.c, 6); }
+OPCODE16(0xB2, "RES 6,D", 2) { clear_bit(cpu._registers.d, 6); }
+OPCODE16(0xB3, "RES 6,E", 2) { clear_bit(cpu._registers.e, 6); }
+OPCODE16(0xB4, "RES 6,H", 2) { clear_bit(cpu._registers.h, 6); }
+OPCODE16(0xB5, "RES 6,L", 2) { clear_bit(cpu._registers.l, 6); }
+OPCODE16(0xB6, "RES 6,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    clear_bit(mem_value, 6);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+OPCODE16(0xBF, "RES 7,A", 2) { clear_bit(cpu._registers.a, 7); }
+OPCODE16(0xB8, "RES 7,B", 2) { clear_bit(cpu._registers.b, 7); }
+OPCODE16(0xB9, "RES 7,C", 2) { clear_bit(cpu._registers.c, 7); }
+OPCODE16(0xBA, "RES 7,D", 2) { clear_bit(cpu._registers.d, 7); }
+OPCODE16(0xBB, "RES 7,E", 2) { clear_bit(cpu._registers.e, 7); }
+OPCODE16(0xBC, "RES 7,H", 2) { clear_bit(cpu._registers.h, 7); }
+OPCODE16(0xBD, "RES 7,L", 2) { clear_bit(cpu._registers.l, 7); }
+OPCODE16(0xBE, "RES 7,(HL)", 4) {
+    uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
+    clear_bit(mem_value, 7);
+    cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
+}
+
+OPCODE_STOP(0x00, "STOP", 1) { log_error("Yet to be implemented!"); }
 
 void
-GameboyInstructionSet16bit::initRrGroup()
+GameboyInstructionSet8bit::execute(CentralProcessor &cpu, uint8_t opcode, uint16_t imm)
 {
-    static constexpr auto rr = [](CentralProcessor& cpu, uint8_t &value) {
-        bool carry = static_cast<bool>(value & 0x1);
-        value = (value >> 1) | (cpu._registers.f.carry << 7);
-        cpu._registers.f.carry = carry;
-        cpu._registers.setFlags(cpu._registers.f.carry, 0, 0, !value);
-    };
-    _instructions[0x1F] = instruction("RR A", [](OPCODE_ARGS(cpu)) { rr(cpu, cpu._registers.a); }, 2);
-    _instructions[0x18] = instruction("RR B", [](OPCODE_ARGS(cpu)) { rr(cpu, cpu._registers.b); }, 2);
-    _instructions[0x19] = instruction("RR C", [](OPCODE_ARGS(cpu)) { rr(cpu, cpu._registers.c); }, 2);
-    _instructions[0x1A] = instruction("RR D", [](OPCODE_ARGS(cpu)) { rr(cpu, cpu._registers.d); }, 2);
-    _instructions[0x1B] = instruction("RR E", [](OPCODE_ARGS(cpu)) { rr(cpu, cpu._registers.e); }, 2);
-    _instructions[0x1C] = instruction("RR H", [](OPCODE_ARGS(cpu)) { rr(cpu, cpu._registers.h); }, 2);
-    _instructions[0x1D] = instruction("RR L", [](OPCODE_ARGS(cpu)) { rr(cpu, cpu._registers.l); }, 2);
-    _instructions[0x1E] = instruction("RR (HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        rr(cpu, mem_value);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
+    switch (opcode)
+    {
+    OPCODE_CASES_256()
+    }
 }
 
 void
-GameboyInstructionSet16bit::initSlaGroup()
+GameboyInstructionSet16bit::execute(CentralProcessor &cpu, uint8_t opcode, uint16_t imm)
 {
-    static constexpr auto sla = [](CentralProcessor& cpu, uint8_t &value) {
-        cpu._registers.f.carry = static_cast<bool>(value & 0x80);
-        value = (value << 1) & 0xFE;
-        cpu._registers.setFlags(cpu._registers.f.carry, 0, 0, !value);
-    };
-    _instructions[0x27] = instruction("SLA A", [](OPCODE_ARGS(cpu)) { sla(cpu, cpu._registers.a); }, 2);
-    _instructions[0x20] = instruction("SLA B", [](OPCODE_ARGS(cpu)) { sla(cpu, cpu._registers.b); }, 2);
-    _instructions[0x21] = instruction("SLA C", [](OPCODE_ARGS(cpu)) { sla(cpu, cpu._registers.c); }, 2);
-    _instructions[0x22] = instruction("SLA D", [](OPCODE_ARGS(cpu)) { sla(cpu, cpu._registers.d); }, 2);
-    _instructions[0x23] = instruction("SLA E", [](OPCODE_ARGS(cpu)) { sla(cpu, cpu._registers.e); }, 2);
-    _instructions[0x24] = instruction("SLA H", [](OPCODE_ARGS(cpu)) { sla(cpu, cpu._registers.h); }, 2);
-    _instructions[0x25] = instruction("SLA L", [](OPCODE_ARGS(cpu)) { sla(cpu, cpu._registers.l); }, 2);
-    _instructions[0x26] = instruction("SLA (HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        sla(cpu, mem_value);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
+    switch (opcode)
+    {
+    OPCODE_CASES_256()
+    }
 }
 
 void
-GameboyInstructionSet16bit::initSraGroup()
+GameboyInstructionSetStop::execute(CentralProcessor &cpu, uint8_t opcode, uint16_t imm)
 {
-    static constexpr auto sra = [](CentralProcessor& cpu, uint8_t &value) {
-        cpu._registers.f.carry = static_cast<bool>(value & 0x1);
-        value = ((value >> 1) & 0x7F) | (value & 0x80);
-        cpu._registers.setFlags(cpu._registers.f.carry, 0, 0, !value);
-    };
-    _instructions[0x2F] = instruction("SRA A", [](OPCODE_ARGS(cpu)) { sra(cpu, cpu._registers.a); }, 2);
-    _instructions[0x28] = instruction("SRA B", [](OPCODE_ARGS(cpu)) { sra(cpu, cpu._registers.b); }, 2);
-    _instructions[0x29] = instruction("SRA C", [](OPCODE_ARGS(cpu)) { sra(cpu, cpu._registers.c); }, 2);
-    _instructions[0x2A] = instruction("SRA D", [](OPCODE_ARGS(cpu)) { sra(cpu, cpu._registers.d); }, 2);
-    _instructions[0x2B] = instruction("SRA E", [](OPCODE_ARGS(cpu)) { sra(cpu, cpu._registers.e); }, 2);
-    _instructions[0x2C] = instruction("SRA H", [](OPCODE_ARGS(cpu)) { sra(cpu, cpu._registers.h); }, 2);
-    _instructions[0x2D] = instruction("SRA L", [](OPCODE_ARGS(cpu)) { sra(cpu, cpu._registers.l); }, 2);
-    _instructions[0x2E] = instruction("SRA (HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        sra(cpu, mem_value);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
+    assert(opcode < kInstructionArraySize);
+    invoke<0x00>(cpu, imm);
 }
 
+/// Sequences found by `tools/fusion_profile` in the games in `games/`, by descending frequency with the longest first
+/// so they're matched before the pairs they start with. Only the last instruction of a sequence may branch.
+#define FUSED_SEQUENCES(_)                                                      \
+    _(0,  "LDH A,(n) / CP A,n / JR NZ,n",       0xF0, 0xFE, 0x20)               \
+    _(1,  "LDH A,(n) / AND A,n / JR NZ,n",      0xF0, 0xE6, 0x20)               \
+    _(2,  "LDD (HL),A / DEC B / JR NZ,n",       0x32, 0x05, 0x20)               \
+    _(3,  "LD A,B / OR A,C / JR NZ,n",          0x78, 0xB1, 0x20)               \
+    _(4,  "LDI A,(HL) / LD (DE),A / INC DE",    0x2A, 0x12, 0x13)               \
+    _(5,  "LD A,(DE) / LDI (HL),A / INC DE",    0x1A, 0x22, 0x13)               \
+    _(6,  "LDH A,(n) / CP A,n",                 0xF0, 0xFE)                     \
+    _(7,  "LDH A,(n) / AND A,n",                0xF0, 0xE6)                     \
+    _(8,  "LDD (HL),A / DEC B",                 0x32, 0x05)                     \
+    _(9,  "DEC B / JR NZ,n",                    0x05, 0x20)                     \
+    _(10, "DEC C / JR NZ,n",                    0x0D, 0x20)                     \
+    _(11, "OR A,C / JR NZ,n",                   0xB1, 0x20)                     \
+    _(12, "CP A,n / JR NZ,n",                   0xFE, 0x20)                     \
+    _(13, "CP A,n / JR Z,n",                    0xFE, 0x28)                     \
+    _(14, "AND A,n / JR NZ,n",                  0xE6, 0x20)                     \
+    _(15, "AND A,A / JR Z,n",                   0xA7, 0x28)                     \
+    _(16, "LD (DE),A / INC DE",                 0x12, 0x13)                     \
+    _(17, "LDI A,(HL) / LD (DE),A",             0x2A, 0x12)                     \
+    _(18, "LD A,(DE) / LDI (HL),A",             0x1A, 0x22)
+
+/// A fused instruction takes the M-cycles of its first instruction, the rest move the clock as they run.
+#define __FUSED_DESCRIBE(_index, _name, _op, ...)                                                                       \
+    { instruction(_name, GameboyInstructionSetFused::kInstructionSet, _index,                                          \
+                  GameboyInstructionSet8bit::describe<_op>().getCycles()),                                              \
+      static_cast<uint8_t>(std::initializer_list<uint8_t>{ _op, __VA_ARGS__ }.size()), { _op, __VA_ARGS__ } },
+const GameboyInstructionSetFused::sequence GameboyInstructionSetFused::kSequences[] = { FUSED_SEQUENCES(__FUSED_DESCRIBE) };
+#undef __FUSED_DESCRIBE
+
+template<uint8_t Opcode, uint8_t... Rest>
 void
-GameboyInstructionSet16bit::initSrlGroup()
+GameboyInstructionSetFused::run(CentralProcessor &cpu, const decodedInstruction *decoded)
 {
-    static constexpr auto srl = [](CentralProcessor& cpu, uint8_t &value) {
-        cpu._registers.f.carry = static_cast<bool>(value & 0x1);
-        value = (value >> 1) & 0x7F;
-        cpu._registers.setFlags(cpu._registers.f.carry, 0, 0, !value);
-    };
-    _instructions[0x3F] = instruction("SRL A", [](OPCODE_ARGS(cpu)) { srl(cpu, cpu._registers.a); }, 2);
-    _instructions[0x38] = instruction("SRL B", [](OPCODE_ARGS(cpu)) { srl(cpu, cpu._registers.b); }, 2);
-    _instructions[0x39] = instruction("SRL C", [](OPCODE_ARGS(cpu)) { srl(cpu, cpu._registers.c); }, 2);
-    _instructions[0x3A] = instruction("SRL D", [](OPCODE_ARGS(cpu)) { srl(cpu, cpu._registers.d); }, 2);
-    _instructions[0x3B] = instruction("SRL E", [](OPCODE_ARGS(cpu)) { srl(cpu, cpu._registers.e); }, 2);
-    _instructions[0x3C] = instruction("SRL H", [](OPCODE_ARGS(cpu)) { srl(cpu, cpu._registers.h); }, 2);
-    _instructions[0x3D] = instruction("SRL L", [](OPCODE_ARGS(cpu)) { srl(cpu, cpu._registers.l); }, 2);
-    _instructions[0x3E] = instruction("SRL (HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        srl(cpu, mem_value);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
+    constexpr instruction kInstruction = GameboyInstructionSet8bit::describe<Opcode>();
+    static_assert(kInstruction.getName(), "Fused an unimplemented opcode");
+    /// Each instruction sees the program counter just past itself, as if it was fetched on its own.
+    cpu._registers.programCounter = decoded->address + decoded->length;
+    GameboyInstructionSet8bit::invoke<Opcode>(cpu, decoded->imm);
+    cpu._mCycleCount += kInstruction.getCycles();
+    if constexpr (sizeof...(Rest) > 0)
+    {
+        constexpr uint8_t kNext = std::array<uint8_t, sizeof...(Rest)>{ Rest... }[0];
+        constexpr uint8_t kNextCycles = GameboyInstructionSet8bit::describe<kNext>().getCycles();
+        /// The rest of the sequence runs on its own, starting from the next instruction in the block.
+        require_or(cpu.continueFused(kNextCycles), cpu._blockIndex -= sizeof...(Rest); return);
+        run<Rest...>(cpu, decoded + 1);
+    }
 }
 
 void
-GameboyInstructionSet16bit::initBitGroup()
+GameboyInstructionSetFused::execute(CentralProcessor &cpu, uint8_t opcode)
 {
-    static constexpr auto bit = [](CentralProcessor& cpu, uint8_t &value, uint8_t bit) {
-        cpu._registers.setFlags(cpu._registers.f.carry, 1, 0, !get_bit(value, bit));
-    };
-    _instructions[0x47] = instruction("BIT 0,A", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.a, 0); }, 2);
-    _instructions[0x40] = instruction("BIT 0,B", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.b, 0); }, 2);
-    _instructions[0x41] = instruction("BIT 0,C", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.c, 0); }, 2);
-    _instructions[0x42] = instruction("BIT 0,D", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.d, 0); }, 2);
-    _instructions[0x43] = instruction("BIT 0,E", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.e, 0); }, 2);
-    _instructions[0x44] = instruction("BIT 0,H", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.h, 0); }, 2);
-    _instructions[0x45] = instruction("BIT 0,L", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.l, 0); }, 2);
-    _instructions[0x46] = instruction("BIT 0,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        bit(cpu, mem_value, 0);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 3);
-    
-    _instructions[0x4F] = instruction("BIT 1,A", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.a, 1); }, 2);
-    _instructions[0x48] = instruction("BIT 1,B", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.b, 1); }, 2);
-    _instructions[0x49] = instruction("BIT 1,C", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.c, 1); }, 2);
-    _instructions[0x4A] = instruction("BIT 1,D", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.d, 1); }, 2);
-    _instructions[0x4B] = instruction("BIT 1,E", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.e, 1); }, 2);
-    _instructions[0x4C] = instruction("BIT 1,H", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.h, 1); }, 2);
-    _instructions[0x4D] = instruction("BIT 1,L", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.l, 1); }, 2);
-    _instructions[0x4E] = instruction("BIT 1,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        bit(cpu, mem_value, 1);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 3);
-
-    _instructions[0x57] = instruction("BIT 2,A", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.a, 2); }, 2);
-    _instructions[0x50] = instruction("BIT 2,B", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.b, 2); }, 2);
-    _instructions[0x51] = instruction("BIT 2,C", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.c, 2); }, 2);
-    _instructions[0x52] = instruction("BIT 2,D", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.d, 2); }, 2);
-    _instructions[0x53] = instruction("BIT 2,E", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.e, 2); }, 2);
-    _instructions[0x54] = instruction("BIT 2,H", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.h, 2); }, 2);
-    _instructions[0x55] = instruction("BIT 2,L", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.l, 2); }, 2);
-    _instructions[0x56] = instruction("BIT 2,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        bit(cpu, mem_value, 2);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 3);
-
-    _instructions[0x5F] = instruction("BIT 3,A", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.a, 3); }, 2);
-    _instructions[0x58] = instruction("BIT 3,B", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.b, 3); }, 2);
-    _instructions[0x59] = instruction("BIT 3,C", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.c, 3); }, 2);
-    _instructions[0x5A] = instruction("BIT 3,D", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.d, 3); }, 2);
-    _instructions[0x5B] = instruction("BIT 3,E", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.e, 3); }, 2);
-    _instructions[0x5C] = instruction("BIT 3,H", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.h, 3); }, 2);
-    _instructions[0x5D] = instruction("BIT 3,L", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.l, 3); }, 2);
-    _instructions[0x5E] = instruction("BIT 3,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        bit(cpu, mem_value, 3);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 3);
-
-    _instructions[0x67] = instruction("BIT 4,A", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.a, 4); }, 2);
-    _instructions[0x60] = instruction("BIT 4,B", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.b, 4); }, 2);
-    _instructions[0x61] = instruction("BIT 4,C", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.c, 4); }, 2);
-    _instructions[0x62] = instruction("BIT 4,D", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.d, 4); }, 2);
-    _instructions[0x63] = instruction("BIT 4,E", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.e, 4); }, 2);
-    _instructions[0x64] = instruction("BIT 4,H", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.h, 4); }, 2);
-    _instructions[0x65] = instruction("BIT 4,L", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.l, 4); }, 2);
-    _instructions[0x66] = instruction("BIT 4,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        bit(cpu, mem_value, 4);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 3);
-
-    _instructions[0x6F] = instruction("BIT 5,A", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.a, 5); }, 2);
-    _instructions[0x68] = instruction("BIT 5,B", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.b, 5); }, 2);
-    _instructions[0x69] = instruction("BIT 5,C", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.c, 5); }, 2);
-    _instructions[0x6A] = instruction("BIT 5,D", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.d, 5); }, 2);
-    _instructions[0x6B] = instruction("BIT 5,E", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.e, 5); }, 2);
-    _instructions[0x6C] = instruction("BIT 5,H", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.h, 5); }, 2);
-    _instructions[0x6D] = instruction("BIT 5,L", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.l, 5); }, 2);
-    _instructions[0x6E] = instruction("BIT 5,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        bit(cpu, mem_value, 5);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 3);
-
-    _instructions[0x77] = instruction("BIT 6,A", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.a, 6); }, 2);
-    _instructions[0x70] = instruction("BIT 6,B", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.b, 6); }, 2);
-    _instructions[0x71] = instruction("BIT 6,C", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.c, 6); }, 2);
-    _instructions[0x72] = instruction("BIT 6,D", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.d, 6); }, 2);
-    _instructions[0x73] = instruction("BIT 6,E", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.e, 6); }, 2);
-    _instructions[0x74] = instruction("BIT 6,H", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.h, 6); }, 2);
-    _instructions[0x75] = instruction("BIT 6,L", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.l, 6); }, 2);
-    _instructions[0x76] = instruction("BIT 6,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        bit(cpu, mem_value, 6);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 3);
-
-    _instructions[0x7F] = instruction("BIT 7,A", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.a, 7); }, 2);
-    _instructions[0x78] = instruction("BIT 7,B", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.b, 7); }, 2);
-    _instructions[0x79] = instruction("BIT 7,C", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.c, 7); }, 2);
-    _instructions[0x7A] = instruction("BIT 7,D", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.d, 7); }, 2);
-    _instructions[0x7B] = instruction("BIT 7,E", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.e, 7); }, 2);
-    _instructions[0x7C] = instruction("BIT 7,H", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.h, 7); }, 2);
-    _instructions[0x7D] = instruction("BIT 7,L", [](OPCODE_ARGS(cpu)) { bit(cpu, cpu._registers.l, 7); }, 2);
-    _instructions[0x7E] = instruction("BIT 7,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        bit(cpu, mem_value, 7);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 3);
+    auto decoded = &cpu._block->instructions[cpu._blockIndex - getLength(opcode)];
+    switch (opcode)
+    {
+#define __FUSED_CASE(_index, _name, ...) case (_index): run<__VA_ARGS__>(cpu, decoded); break;
+    FUSED_SEQUENCES(__FUSED_CASE)
+#undef __FUSED_CASE
+    }
 }
 
-void
-GameboyInstructionSet16bit::initSetGroup()
+bool
+GameboyInstructionSetFused::fuse(const decodedInstruction *decoded, size_t count, decodedInstruction &fused)
 {
-    _instructions[0xC7] = instruction("SET 0,A", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.a, 0); }, 2);
-    _instructions[0xC0] = instruction("SET 0,B", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.b, 0); }, 2);
-    _instructions[0xC1] = instruction("SET 0,C", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.c, 0); }, 2);
-    _instructions[0xC2] = instruction("SET 0,D", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.d, 0); }, 2);
-    _instructions[0xC3] = instruction("SET 0,E", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.e, 0); }, 2);
-    _instructions[0xC4] = instruction("SET 0,H", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.h, 0); }, 2);
-    _instructions[0xC5] = instruction("SET 0,L", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.l, 0); }, 2);
-    _instructions[0xC6] = instruction("SET 0,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        set_bit(mem_value, 0);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0xCF] = instruction("SET 1,A", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.a, 1); }, 2);
-    _instructions[0xC8] = instruction("SET 1,B", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.b, 1); }, 2);
-    _instructions[0xC9] = instruction("SET 1,C", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.c, 1); }, 2);
-    _instructions[0xCA] = instruction("SET 1,D", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.d, 1); }, 2);
-    _instructions[0xCB] = instruction("SET 1,E", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.e, 1); }, 2);
-    _instructions[0xCC] = instruction("SET 1,H", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.h, 1); }, 2);
-    _instructions[0xCD] = instruction("SET 1,L", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.l, 1); }, 2);
-    _instructions[0xCE] = instruction("SET 1,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        set_bit(mem_value, 1);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0xD7] = instruction("SET 2,A", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.a, 2); }, 2);
-    _instructions[0xD0] = instruction("SET 2,B", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.b, 2); }, 2);
-    _instructions[0xD1] = instruction("SET 2,C", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.c, 2); }, 2);
-    _instructions[0xD2] = instruction("SET 2,D", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.d, 2); }, 2);
-    _instructions[0xD3] = instruction("SET 2,E", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.e, 2); }, 2);
-    _instructions[0xD4] = instruction("SET 2,H", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.h, 2); }, 2);
-    _instructions[0xD5] = instruction("SET 2,L", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.l, 2); }, 2);
-    _instructions[0xD6] = instruction("SET 2,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        set_bit(mem_value, 2);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0xDF] = instruction("SET 3,A", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.a, 3); }, 2);
-    _instructions[0xD8] = instruction("SET 3,B", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.b, 3); }, 2);
-    _instructions[0xD9] = instruction("SET 3,C", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.c, 3); }, 2);
-    _instructions[0xDA] = instruction("SET 3,D", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.d, 3); }, 2);
-    _instructions[0xDB] = instruction("SET 3,E", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.e, 3); }, 2);
-    _instructions[0xDC] = instruction("SET 3,H", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.h, 3); }, 2);
-    _instructions[0xDD] = instruction("SET 3,L", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.l, 3); }, 2);
-    _instructions[0xDE] = instruction("SET 3,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        set_bit(mem_value, 3);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0xE7] = instruction("SET 4,A", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.a, 4); }, 2);
-    _instructions[0xE0] = instruction("SET 4,B", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.b, 4); }, 2);
-    _instructions[0xE1] = instruction("SET 4,C", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.c, 4); }, 2);
-    _instructions[0xE2] = instruction("SET 4,D", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.d, 4); }, 2);
-    _instructions[0xE3] = instruction("SET 4,E", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.e, 4); }, 2);
-    _instructions[0xE4] = instruction("SET 4,H", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.h, 4); }, 2);
-    _instructions[0xE5] = instruction("SET 4,L", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.l, 4); }, 2);
-    _instructions[0xE6] = instruction("SET 4,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        set_bit(mem_value, 4);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0xEF] = instruction("SET 5,A", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.a, 5); }, 2);
-    _instructions[0xE8] = instruction("SET 5,B", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.b, 5); }, 2);
-    _instructions[0xE9] = instruction("SET 5,C", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.c, 5); }, 2);
-    _instructions[0xEA] = instruction("SET 5,D", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.d, 5); }, 2);
-    _instructions[0xEB] = instruction("SET 5,E", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.e, 5); }, 2);
-    _instructions[0xEC] = instruction("SET 5,H", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.h, 5); }, 2);
-    _instructions[0xED] = instruction("SET 5,L", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.l, 5); }, 2);
-    _instructions[0xEE] = instruction("SET 5,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        set_bit(mem_value, 5);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0xF7] = instruction("SET 6,A", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.a, 6); }, 2);
-    _instructions[0xF0] = instruction("SET 6,B", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.b, 6); }, 2);
-    _instructions[0xF1] = instruction("SET 6,C", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.c, 6); }, 2);
-    _instructions[0xF2] = instruction("SET 6,D", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.d, 6); }, 2);
-    _instructions[0xF3] = instruction("SET 6,E", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.e, 6); }, 2);
-    _instructions[0xF4] = instruction("SET 6,H", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.h, 6); }, 2);
-    _instructions[0xF5] = instruction("SET 6,L", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.l, 6); }, 2);
-    _instructions[0xF6] = instruction("SET 6,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        set_bit(mem_value, 6);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0xFF] = instruction("SET 7,A", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.a, 7); }, 2);
-    _instructions[0xF8] = instruction("SET 7,B", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.b, 7); }, 2);
-    _instructions[0xF9] = instruction("SET 7,C", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.c, 7); }, 2);
-    _instructions[0xFA] = instruction("SET 7,D", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.d, 7); }, 2);
-    _instructions[0xFB] = instruction("SET 7,E", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.e, 7); }, 2);
-    _instructions[0xFC] = instruction("SET 7,H", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.h, 7); }, 2);
-    _instructions[0xFD] = instruction("SET 7,L", [](OPCODE_ARGS(cpu)) { set_bit(cpu._registers.l, 7); }, 2);
-    _instructions[0xFE] = instruction("SET 7,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        set_bit(mem_value, 7);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
+    for (auto &sequence: kSequences)
+    {
+        require_or(sequence.length <= count, continue);
+        uint8_t matched = 0;
+        while (matched < sequence.length && decoded[matched].descriptor->getSet() == instructionSet::set8bit && 
+               decoded[matched].descriptor->getOpcode() == sequence.opcodes[matched])
+        {
+            matched++;
+        }
+        require_or(matched == sequence.length, continue);
+        fused.descriptor = &sequence.descriptor;
+        fused.address = decoded->address;
+        fused.imm = 0;
+        fused.length = 0;
+        for (uint8_t i = 0; i < sequence.length; i++)
+        {
+            fused.length += decoded[i].length;
+        }
+        return true;
+    }
+    return false;
 }
 
-void
-GameboyInstructionSet16bit::initResGroup()
-{
-    _instructions[0x87] = instruction("RES 0,A", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.a, 0); }, 2);
-    _instructions[0x80] = instruction("RES 0,B", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.b, 0); }, 2);
-    _instructions[0x81] = instruction("RES 0,C", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.c, 0); }, 2);
-    _instructions[0x82] = instruction("RES 0,D", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.d, 0); }, 2);
-    _instructions[0x83] = instruction("RES 0,E", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.e, 0); }, 2);
-    _instructions[0x84] = instruction("RES 0,H", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.h, 0); }, 2);
-    _instructions[0x85] = instruction("RES 0,L", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.l, 0); }, 2);
-    _instructions[0x86] = instruction("RES 0,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        clear_bit(mem_value, 0);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0x8F] = instruction("RES 1,A", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.a, 1); }, 2);
-    _instructions[0x88] = instruction("RES 1,B", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.b, 1); }, 2);
-    _instructions[0x89] = instruction("RES 1,C", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.c, 1); }, 2);
-    _instructions[0x8A] = instruction("RES 1,D", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.d, 1); }, 2);
-    _instructions[0x8B] = instruction("RES 1,E", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.e, 1); }, 2);
-    _instructions[0x8C] = instruction("RES 1,H", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.h, 1); }, 2);
-    _instructions[0x8D] = instruction("RES 1,L", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.l, 1); }, 2);
-    _instructions[0x8E] = instruction("RES 1,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        clear_bit(mem_value, 1);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0x97] = instruction("RES 2,A", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.a, 2); }, 2);
-    _instructions[0x90] = instruction("RES 2,B", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.b, 2); }, 2);
-    _instructions[0x91] = instruction("RES 2,C", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.c, 2); }, 2);
-    _instructions[0x92] = instruction("RES 2,D", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.d, 2); }, 2);
-    _instructions[0x93] = instruction("RES 2,E", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.e, 2); }, 2);
-    _instructions[0x94] = instruction("RES 2,H", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.h, 2); }, 2);
-    _instructions[0x95] = instruction("RES 2,L", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.l, 2); }, 2);
-    _instructions[0x96] = instruction("RES 2,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        clear_bit(mem_value, 2);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0x9F] = instruction("RES 3,A", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.a, 3); }, 2);
-    _instructions[0x98] = instruction("RES 3,B", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.b, 3); }, 2);
-    _instructions[0x99] = instruction("RES 3,C", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.c, 3); }, 2);
-    _instructions[0x9A] = instruction("RES 3,D", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.d, 3); }, 2);
-    _instructions[0x9B] = instruction("RES 3,E", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.e, 3); }, 2);
-    _instructions[0x9C] = instruction("RES 3,H", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.h, 3); }, 2);
-    _instructions[0x9D] = instruction("RES 3,L", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.l, 3); }, 2);
-    _instructions[0x9E] = instruction("RES 3,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        clear_bit(mem_value, 3);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0xA7] = instruction("RES 4,A", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.a, 4); }, 2);
-    _instructions[0xA0] = instruction("RES 4,B", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.b, 4); }, 2);
-    _instructions[0xA1] = instruction("RES 4,C", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.c, 4); }, 2);
-    _instructions[0xA2] = instruction("RES 4,D", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.d, 4); }, 2);
-    _instructions[0xA3] = instruction("RES 4,E", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.e, 4); }, 2);
-    _instructions[0xA4] = instruction("RES 4,H", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.h, 4); }, 2);
-    _instructions[0xA5] = instruction("RES 4,L", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.l, 4); }, 2);
-    _instructions[0xA6] = instruction("RES 4,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        clear_bit(mem_value, 4);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0xAF] = instruction("RES 5,A", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.a, 5); }, 2);
-    _instructions[0xA8] = instruction("RES 5,B", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.b, 5); }, 2);
-    _instructions[0xA9] = instruction("RES 5,C", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.c, 5); }, 2);
-    _instructions[0xAA] = instruction("RES 5,D", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.d, 5); }, 2);
-    _instructions[0xAB] = instruction("RES 5,E", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.e, 5); }, 2);
-    _instructions[0xAC] = instruction("RES 5,H", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.h, 5); }, 2);
-    _instructions[0xAD] = instruction("RES 5,L", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.l, 5); }, 2);
-    _instructions[0xAE] = instruction("RES 5,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        clear_bit(mem_value, 5);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0xB7] = instruction("RES 6,A", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.a, 6); }, 2);
-    _instructions[0xB0] = instruction("RES 6,B", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.b, 6); }, 2);
-    _instructions[0xB1] = instruction("RES 6,C", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.c, 6); }, 2);
-    _instructions[0xB2] = instruction("RES 6,D", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.d, 6); }, 2);
-    _instructions[0xB3] = instruction("RES 6,E", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.e, 6); }, 2);
-    _instructions[0xB4] = instruction("RES 6,H", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.h, 6); }, 2);
-    _instructions[0xB5] = instruction("RES 6,L", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.l, 6); }, 2);
-    _instructions[0xB6] = instruction("RES 6,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        clear_bit(mem_value, 6);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-
-    _instructions[0xBF] = instruction("RES 7,A", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.a, 7); }, 2);
-    _instructions[0xB8] = instruction("RES 7,B", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.b, 7); }, 2);
-    _instructions[0xB9] = instruction("RES 7,C", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.c, 7); }, 2);
-    _instructions[0xBA] = instruction("RES 7,D", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.d, 7); }, 2);
-    _instructions[0xBB] = instruction("RES 7,E", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.e, 7); }, 2);
-    _instructions[0xBC] = instruction("RES 7,H", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.h, 7); }, 2);
-    _instructions[0xBD] = instruction("RES 7,L", [](OPCODE_ARGS(cpu)) { clear_bit(cpu._registers.l, 7); }, 2);
-    _instructions[0xBE] = instruction("RES 7,(HL)", [](OPCODE_ARGS(cpu)) {
-        uint8_t mem_value = cpu.getMemoryManager()->read(cpu._registers.hl);
-        clear_bit(mem_value, 7);
-        cpu.getMemoryManager()->write(cpu._registers.hl, mem_value);
-    }, 4);
-}
-
-GameboyInstructionSetStop::GameboyInstructionSetStop(): InstructionSet(1)
+const std::array<instruction, GameboyInstructionSet8bit::kInstructionArraySize> 
+GameboyInstructionSet8bit::kInstructions = describeAll(std::make_index_sequence<kInstructionArraySize>());
+const std::array<GameboyInstructionSet8bit::handler_t, GameboyInstructionSet8bit::kInstructionArraySize> 
+GameboyInstructionSet8bit::kHandlers = handleAll(std::make_index_sequence<kInstructionArraySize>());
+
+const std::array<instruction, GameboyInstructionSet16bit::kInstructionArraySize> 
+GameboyInstructionSet16bit::kInstructions = describeAll(std::make_index_sequence<kInstructionArraySize>());
+const std::array<GameboyInstructionSet16bit::handler_t, GameboyInstructionSet16bit::kInstructionArraySize> 
+GameboyInstructionSet16bit::kHandlers = handleAll(std::make_index_sequence<kInstructionArraySize>());
+
+const std::array<instruction, GameboyInstructionSetStop::kInstructionArraySize> 
+GameboyInstructionSetStop::kInstructions = describeAll(std::make_index_sequence<kInstructionArraySize>());
+const std::array<GameboyInstructionSetStop::handler_t, GameboyInstructionSetStop::kInstructionArraySize> 
+GameboyInstructionSetStop::kHandlers = handleAll(std::make_index_sequence<kInstructionArraySize>());
+
+#if CPU_THREADED_DISPATCH
+/// Expand `_` once per opcode, as two hex digits so they can be pasted into label names.
+#define __OPCODE_HEX16(_, _hi)                                                                                          \
+    _(_hi##0) _(_hi##1) _(_hi##2) _(_hi##3) _(_hi##4) _(_hi##5) _(_hi##6) _(_hi##7)                                     \
+    _(_hi##8) _(_hi##9) _(_hi##A) _(_hi##B) _(_hi##C) _(_hi##D) _(_hi##E) _(_hi##F)
+#define OPCODES_HEX_256(_)                                                                                              \
+    __OPCODE_HEX16(_, 0) __OPCODE_HEX16(_, 1) __OPCODE_HEX16(_, 2) __OPCODE_HEX16(_, 3)                                 \
+    __OPCODE_HEX16(_, 4) __OPCODE_HEX16(_, 5) __OPCODE_HEX16(_, 6) __OPCODE_HEX16(_, 7)                                 \
+    __OPCODE_HEX16(_, 8) __OPCODE_HEX16(_, 9) __OPCODE_HEX16(_, A) __OPCODE_HEX16(_, B)                                 \
+    __OPCODE_HEX16(_, C) __OPCODE_HEX16(_, D) __OPCODE_HEX16(_, E) __OPCODE_HEX16(_, F)
+
+#define __THREADED_LABEL8(_hex) &&op8_##_hex,
+#define __THREADED_LABEL16(_hex) &&op16_##_hex,
+#define __THREADED_HANDLER8(_hex) op8_##_hex: GameboyInstructionSet8bit::invoke<0x##_hex>(cpu, imm); THREADED_NEXT();
+#define __THREADED_HANDLER16(_hex) op16_##_hex: GameboyInstructionSet16bit::invoke<0x##_hex>(cpu, imm); THREADED_NEXT();
+
+/// Handler of a decoded instruction.
+#define THREADED_LABEL(_decoded)                                                                                        \
+    (((_decoded)->descriptor->getSet() == instructionSet::set8bit) ? kLabels8bit[(_decoded)->descriptor->getOpcode()] : \
+     ((_decoded)->descriptor->getSet() == instructionSet::set16bit) ? kLabels16bit[(_decoded)->descriptor->getOpcode()] \
+                                                                    : kLabelStop)
+
+/// Start the decoded instruction the same way as `getNextInstruction` and `Emulator::Run`, then jump to its handler.
+#define THREADED_DISPATCH()                                                                                             \
+    registers.programCounter += decoded->length;                                                                        \
+    imm = decoded->imm;                                                                                                 \
+    cycles = decoded->descriptor->getCycles();                                                                          \
+    cpu._branchPenalty = 0;                                                                                             \
+    cpu._instructionCount++;                                                                                            \
+    scheduler.advance(cycles);                                                                                          \
+    goto *label
+
+/// Fetch from the current block, anything else (leaving the block, a pending interrupt, halt or the budget running 
+/// out) is handled out of line. The block is looked up every time, an instruction may overwrite it. A block the
+/// interpreter entered has no handlers yet, it is entered again to look them up.
+#define THREADED_FETCH()                                                                                                \
+    if (expect_false(scheduler.getCycleCount() >= deadline)) goto done;                                                 \
+    if (expect_false(cpu._halt || ((cpu._interruptState == CentralProcessor::interruptState::enabled) &&                \
+                                   (interruptEnable & interruptFlag)))) goto interrupt;                                 \
+    block = cpu._block;                                                                                                 \
+    if (expect_false(!block || cpu._blockIndex >= block->threaded.size() ||                                             \
+                     block->instructions[cpu._blockIndex].address != registers.programCounter)) goto enter;             \
+    decoded = &block->instructions[cpu._blockIndex];                                                                    \
+    label = block->threaded[cpu._blockIndex++];                                                                         \
+    THREADED_DISPATCH()
+
+/// Look up the handlers of a block the first time it runs here.
+#define THREADED_RESOLVE(_block)                                                                                        \
+    if ((_block)->threaded.empty())                                                                                     \
+    {                                                                                                                   \
+        for (auto &instruction: (_block)->instructions)                                                                 \
+        {                                                                                                               \
+            (_block)->threaded.push_back(THREADED_LABEL(&instruction));                                                 \
+        }                                                                                                               \
+    }
+
+/// Retire the instruction as `executeNextInstruction` would, then go straight on to the next one.
+#define THREADED_NEXT()                                                                                                 \
+    cpu._mCycleCount += cycles + cpu._branchPenalty;                                                                    \
+    scheduler.advance(cpu._branchPenalty);                                                                              \
+    THREADED_FETCH()
+#endif // CPU_THREADED_DISPATCH
+
+uint32_t
+ThreadedInterpreter::run(CentralProcessor &cpu, ::emu::Scheduler &scheduler, uint32_t budget)
 {
-    _instructions[0x00] = instruction("STOP", [](OPCODE_ARGS(cpu)) { log_error("Yet to be implemented!"); }, 1);
+#if CPU_THREADED_DISPATCH
+    static const void *const kLabels8bit[] = { OPCODES_HEX_256(__THREADED_LABEL8) };
+    static const void *const kLabels16bit[] = { OPCODES_HEX_256(__THREADED_LABEL16) };
+    static const void *const kLabelStop = &&opStop;
+
+    auto &registers = cpu._registers;
+    const uint8_t &interruptEnable = cpu._memory->getInterruptEnable()->value;
+    const uint8_t &interruptFlag = cpu._memory->getIORegisters()->interruptFlag;
+    const uint64_t start = scheduler.getCycleCount();
+    const uint64_t deadline = start + budget;
+    const uint64_t startInstructions = cpu._instructionCount;
+    CentralProcessor::decodedBlock *block = nullptr;
+    const CentralProcessor::decodedInstruction *decoded = nullptr;
+    const void *label = nullptr;
+    uint16_t imm = 0;
+    uint8_t cycles = 0;
+
+    /// Always run at least one instruction.
+    THREADED_FETCH();
+
+OPCODES_HEX_256(__THREADED_HANDLER8)
+OPCODES_HEX_256(__THREADED_HANDLER16)
+opStop:
+    GameboyInstructionSetStop::invoke<0x00>(cpu, imm);
+    THREADED_NEXT();
+
+interrupt:
+    /// Rare, take the interpreter's path through a whole instruction. It may leave the CPU in a block that hasn't 
+    /// run here yet.
+    {
+        auto instruction = cpu.getNextInstruction();
+        require_or(!cpu._halt, goto done);
+        scheduler.advance(instruction->getCycles());
+        scheduler.advance(cpu.executeNextInstruction(instruction));
+    }
+    if (cpu._block)
+    {
+        THREADED_RESOLVE(cpu._block);
+    }
+    THREADED_FETCH();
+
+enter:
+    /// Stop at the start of an idle loop, `Emulator::Run` may fast-forward through it.
+    if (block && block->idleLoop && (cpu._instructionCount != startInstructions) && cpu.getIdleLoopCycles())
+    {
+        goto done;
+    }
+    block = cpu.enterBlock(registers.programCounter);
+    if (block == nullptr)
+    {
+        decoded = &cpu._uncachedInstruction;
+        label = THREADED_LABEL(decoded);
+        THREADED_DISPATCH();
+    }
+    THREADED_RESOLVE(block);
+    decoded = &block->instructions[cpu._blockIndex];
+    label = block->threaded[cpu._blockIndex++];
+    THREADED_DISPATCH();
+
+done:
+    return static_cast<uint32_t>(scheduler.getCycleCount() - start);
+#else
+    (void)cpu;
+    (void)scheduler;
+    (void)budget;
+    assert(false);
+    return 0;
+#endif // CPU_THREADED_DISPATCH
 }
+} // namespace emu::gameboy::instruction
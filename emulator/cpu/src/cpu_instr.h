@@ -14,151 +14,216 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <array>
+#include <utility>
+
 #include "cpu.h"
 #include "mmu.h"
 #include "platform.h"
 
+/// Computed gotos (labels as values) are a GCC extension, also supported by clang.
+#ifndef CPU_THREADED_DISPATCH
+#if defined(__GNUC__)
+#define CPU_THREADED_DISPATCH 1
+#else
+#define CPU_THREADED_DISPATCH 0
+#endif
+#endif
+
 namespace emu::gameboy::instruction {
+/// @brief Common accessors for an instruction set.
+/// Each set describes its opcodes at compile time through `describe<Opcode>()`, and dispatches through a
+/// generated switch in `execute()`, so no opcode goes through a function pointer or heap-allocated table.
+template<typename Set, uint16_t Size>
 class InstructionSet
 {
 public:
-    InstructionSet(uint16_t size): _instructions(new instruction[size]), _instructionsSize(size) { }
-    ~InstructionSet() { delete[] _instructions; }
-    
-    const instruction *getInstruction(uint8_t opcode) const 
+    static constexpr uint16_t kInstructionArraySize = Size;
+    using handler_t = void (*)(CentralProcessor &, uint16_t);
+
+public:
+    static const instruction *getInstruction(uint8_t opcode)
     { 
-        assert(opcode < _instructionsSize); 
-        return &(_instructions[opcode]);
+        assert(opcode < kInstructionArraySize); 
+        return &(Set::kInstructions[opcode]);
     };
     
-    void printAll() const
+    /// @brief Entry point of a single opcode, used by the recompiler to call into the interpreter.
+    static handler_t getHandler(uint8_t opcode)
+    {
+        assert(opcode < kInstructionArraySize);
+        return Set::kHandlers[opcode];
+    }
+    
+    static void printAll()
     {
-        for (uint16_t i = 0; i < _instructionsSize; i++)
+        for (uint16_t i = 0; i < kInstructionArraySize; i++)
         {
-            _instructions[i].print(i);
+            Set::kInstructions[i].print(i);
         }
     }
     
 protected:
-    static uint8_t truncate(uint16_t value) { return static_cast<uint8_t>(value & 0xFF); };
-    static uint16_t extend(uint8_t value) { return static_cast<uint16_t>(value); }
-    static int16_t sign_extend(uint8_t value) { return static_cast<int16_t>(static_cast<int8_t>(value)); }
-    
-protected:
-    instruction *   _instructions = nullptr;
-    size_t          _instructionsSize = 0;
+    template<size_t... Opcodes>
+    static constexpr std::array<instruction, Size> describeAll(std::index_sequence<Opcodes...>)
+    {
+        return {{ Set::template describe<Opcodes>()... }};
+    }
+
+    template<size_t... Opcodes>
+    static constexpr std::array<handler_t, Size> handleAll(std::index_sequence<Opcodes...>)
+    {
+        return {{ &invoke<Opcodes>... }};
+    }
+
+    /// @brief Record the instruction and run its action, `imm` is the operand decoded with the instruction.
+    template<uint8_t Opcode>
+    static void invoke(CentralProcessor &cpu, uint16_t imm)
+    {
+        constexpr instruction kInstruction = Set::template describe<Opcode>();
+        if constexpr (kInstruction.getName() == nullptr)
+        {
+            log_error("Opcode 0x%x not implemented!", Opcode);
+        }
+        else
+        {
+            /// The program counter has already moved past the opcode, prefix and operand.
+            constexpr uint8_t kLength = sizeof(uint8_t) + kInstruction.getImmediateSize() + 
+                                        (Set::kInstructionSet != instructionSet::set8bit);
+            cpu._trace.record(cpu._registers, cpu._registers.programCounter - kLength, 
+                              static_cast<uint8_t>(Set::kInstructionSet), Opcode, imm, cpu._mCycleCount);
+            Set::template action<Opcode>(cpu, imm);
+        }
+    }
 };
 
-class GameboyInstructionSet8bit: public InstructionSet
+class GameboyInstructionSet8bit: public InstructionSet<GameboyInstructionSet8bit, 256>
 {
 public:
-    static constexpr uint16_t kInstructionArraySize = 256;
+    static constexpr instructionSet kInstructionSet = instructionSet::set8bit;
 
 public:
-    GameboyInstructionSet8bit();
-    ~GameboyInstructionSet8bit() { }
-    
+    static void execute(CentralProcessor &cpu, uint8_t opcode, uint16_t imm);
+
 private:
-    /// @brief Move a numerical value into a register.
-    void initMoveImmediateGroup();
-    /// @brief Move the contents of a register into another.
-    void initMoveRegisterGroup();
-    /// @brief Read memory at the address in HL, and write the value to a register.
-    void initLoadHLGroup();
-    /// @brief Write the value in a register to the address stored in HL.
-    void initStoreHLGroup();
-    /// @brief Read memory and store the result in register A. 
-    void initLoadAGroup();
-    /// @brief Write the value in register A to memory.
-    void initStoreAGroup();
-    /// @brief Move an integer value into a wide register.
-    void initMoveImmediate16bitGroup();
-    /// @brief Special load/store instructions. 
-    void initLoadStoreSpecial();
-    /// @brief Push a value onto the stack.
-    void initPushGroup();
-    /// @brief Pop a value off the stack. 
-    void initPopGroup();
-    /// @brief Add a value to register A and set flags. 
-    void initAddGroup();
-    /// @brief Add a value (plus carry) to register A and set flags. 
-    void initAdcGroup();
-    /// @brief Subtract a value from register A and set flags. 
-    void initSubGroup();
-    /// @brief Subtract a value (minus carry) from register A and set flags. 
-    void initSbcGroup();
-    /// @brief Perform logical AND with register A and another value. 
-    void initAndGroup();
-    /// @brief Perform logical OR with register A and another value. 
-    void initOrGroup();
-    /// @brief Perform logical XOR with register A and another value. 
-    void initXorGroup();
-    /// @brief Compare register A with another value, sets flags and discards result. 
-    void initCpGroup();
-    /// @brief Increment an 8-bit register value. 
-    void initIncGroup();
-    /// @brief decrement an 8-bit register value. 
-    void initDecGroup();
-    /// @brief Perform 16-bit addition.
-    void initAdd16bitGroup();
-    /// @brief Increment a 16-bit register.
-    void initInc16bitGroup();
-    /// @brief Decrement a 16-bit register.
-    void initDec16bitGroup();
-    /// @brief Perform decimal adjust on register A.
-    void initDaa();
-    void initCpl();
-    void initCcf();
-    void initScf();
-    void initNop();
-    void initHalt();
-    void initInterruptControlGroup();
-    /// @brief Perform left/right bit rotations on register A.
-    void initRotateAGroup();
-    void initJpGroup();
-    void initJrGroup();
-    void initCallGroup();
-    void initRstGroup();
-    void initReturnGroup();
+    template<uint8_t Opcode>
+    static constexpr instruction describe() { return instruction(nullptr, kInstructionSet, Opcode, 0); }
+    template<uint8_t Opcode>
+    static void action(CentralProcessor &cpu, uint16_t imm);
+
+private:
+    static const std::array<instruction, kInstructionArraySize> kInstructions;
+    static const std::array<handler_t, kInstructionArraySize> kHandlers;
+
+    friend class InstructionSet<GameboyInstructionSet8bit, 256>;
+    friend class ThreadedInterpreter;
+    friend class GameboyInstructionSetFused;
 };
 
-class GameboyInstructionSet16bit: public InstructionSet
+class GameboyInstructionSet16bit: public InstructionSet<GameboyInstructionSet16bit, 256>
 {
 public:
     static constexpr uint8_t kInstructionSetCode = 0xCB;
-    static constexpr uint16_t kInstructionArraySize = 256;
+    static constexpr instructionSet kInstructionSet = instructionSet::set16bit;
 
 public:
-    GameboyInstructionSet16bit();
-    ~GameboyInstructionSet16bit() { }
-    
+    static void execute(CentralProcessor &cpu, uint8_t opcode, uint16_t imm);
+
 private:
-    void initSwapGroup();
-    
-    void initRlcGroup();
-    void initRlGroup();
-    void initRrcGroup();
-    void initRrGroup();
-    void initSlaGroup();
-    void initSraGroup();
-    void initSrlGroup();
-    
-    void initBitGroup();
-    void initSetGroup();
-    void initResGroup();
+    template<uint8_t Opcode>
+    static constexpr instruction describe() { return instruction(nullptr, kInstructionSet, Opcode, 0); }
+    template<uint8_t Opcode>
+    static void action(CentralProcessor &cpu, uint16_t imm);
+
+private:
+    static const std::array<instruction, kInstructionArraySize> kInstructions;
+    static const std::array<handler_t, kInstructionArraySize> kHandlers;
+
+    friend class InstructionSet<GameboyInstructionSet16bit, 256>;
+    friend class ThreadedInterpreter;
 };
 
-class GameboyInstructionSetStop: public InstructionSet
+class GameboyInstructionSetStop: public InstructionSet<GameboyInstructionSetStop, 1>
 {
 public:
     static constexpr uint8_t kInstructionSetCode = 0x10;
-    static constexpr uint16_t kInstructionArraySize = 1;
+    static constexpr instructionSet kInstructionSet = instructionSet::stop;
+
+public:
+    static void execute(CentralProcessor &cpu, uint8_t opcode, uint16_t imm);
+
+private:
+    template<uint8_t Opcode>
+    static constexpr instruction describe() { return instruction(nullptr, kInstructionSet, Opcode, 0); }
+    template<uint8_t Opcode>
+    static void action(CentralProcessor &cpu, uint16_t imm);
+
+private:
+    static const std::array<instruction, kInstructionArraySize> kInstructions;
+    static const std::array<handler_t, kInstructionArraySize> kHandlers;
+
+    friend class InstructionSet<GameboyInstructionSetStop, 1>;
+    friend class ThreadedInterpreter;
+};
+
+/**
+ * @brief Frequent straight-line sequences of 8-bit instructions, each run with a single dispatch.
+ *
+ * The instructions of a sequence are still traced, counted and timed one at a time, and the sequence stops early
+ * wherever the interpreter would have done something in between, see `CentralProcessor::continueFused`. Sequences are
+ * picked by profiling the games with `tools/fusion_profile`.
+ */
+class GameboyInstructionSetFused
+{
+public:
+    static constexpr instructionSet kInstructionSet = instructionSet::fused;
+    static constexpr uint8_t kMaxLength = 3;
+    using decodedInstruction = detail::cpu::decodedInstruction;
+
+public:
+    /**
+     * @brief Fuse the longest known sequence starting at `decoded`.
+     *
+     * @param[in]  decoded The decoded instructions of a block, from the first instruction of the sequence.
+     * @param[in]  count   Instructions left in the block.
+     * @param[out] fused   The fused instruction, with the address and encoded length of the whole sequence.
+     * @returns Whether a sequence matched.
+     */
+    static bool fuse(const decodedInstruction *decoded, size_t count, decodedInstruction &fused);
+    /// @brief Number of instructions a fused instruction runs.
+    static uint8_t getLength(uint8_t opcode) { return kSequences[opcode].length; }
+    /// @brief Run a fused instruction, the current block must be positioned just past it.
+    static void execute(CentralProcessor &cpu, uint8_t opcode);
 
+private:
+    template<uint8_t Opcode, uint8_t... Rest>
+    static void run(CentralProcessor &cpu, const decodedInstruction *decoded);
+
+private:
+    struct sequence
+    {
+        instruction                         descriptor;
+        uint8_t                             length;
+        std::array<uint8_t, kMaxLength>     opcodes;
+    };
+    /// Indexed by the opcode of the fused instruction, longest sequences first
+    static const sequence kSequences[];
+};
+
+/**
+ * @brief Interpreter loop that jumps straight from one instruction's handler to the next.
+ *
+ * Each handler inlines its action along with the fetch of the next instruction, and ends in its own indirect jump
+ * to the next handler, so there is no call, return or shared switch per instruction. Components still run when their
+ * events are due, as in `Emulator::Run`.
+ */
+class ThreadedInterpreter
+{
 public:
-    GameboyInstructionSetStop();
-    ~GameboyInstructionSetStop() { }
+    static constexpr bool isSupported() { return CPU_THREADED_DISPATCH; }
+    static uint32_t run(CentralProcessor &cpu, ::emu::Scheduler &scheduler, uint32_t budget);
 };
 
 } // namespace emu::gameboy::instruction
 
-#endif /* _CPU_INSTR_H_ */
\ No newline at end of file
+#endif /* _CPU_INSTR_H_ */
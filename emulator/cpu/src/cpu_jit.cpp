@@ -0,0 +1,233 @@
+#include "cpu_jit.h"
+#include "cpu_instr.h"
+#include "Scheduler.hpp"
+
+#include <sys/mman.h>
+
+using namespace emu::gameboy;
+using namespace emu::gameboy::jit;
+using namespace emu::gameboy::instruction;
+
+/// @brief Called by generated code ahead of a run of instructions, false if an event is due before they finish.
+static bool
+advanceClock(::emu::Scheduler *scheduler, uint32_t mCycles)
+{
+    return scheduler->tryAdvance(mCycles);
+}
+
+BlockCompiler::BlockCompiler(CentralProcessor &cpu): _cpu(cpu)
+{
+    require_or(isSupported(), return);
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_JIT
+    flags |= MAP_JIT;
+#endif
+    void *code = mmap(nullptr, kCodeCacheSize, PROT_READ | PROT_WRITE | PROT_EXEC, flags, -1, 0);
+    require_or(code != MAP_FAILED, log_error("Failed to map code cache! (%s)", strerror(errno)); return);
+    _code = static_cast<uint8_t *>(code);
+}
+
+BlockCompiler::~BlockCompiler()
+{
+    if (_code)
+    {
+        munmap(_code, kCodeCacheSize);
+    }
+}
+
+/* static */
+bool
+BlockCompiler::isSupported()
+{
+#if defined(__x86_64__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+BlockCompiler::compiledBlock
+BlockCompiler::compile(const CentralProcessor::decodedBlock &block)
+{
+    /// Upper bounds on the size of generated code.
+    static constexpr size_t kPrologueSize = 16;
+    static constexpr size_t kEpilogueSize = 16;
+    static constexpr size_t kInstructionSize = 96;
+    assert(isValid());
+    size_t size = kPrologueSize + kEpilogueSize + (block.instructions.size() * kInstructionSize);
+    require_or(_codeSize + size <= kCodeCacheSize, return nullptr);
+
+    auto entry = reinterpret_cast<compiledBlock>(&_code[_codeSize]);
+    /// Each instruction can leave before it runs, and after it if it calls into the interpreter.
+    std::array<size_t, 2 * CentralProcessor::decodedBlock::kMaxInstructions> exits;
+    size_t exitCount = 0;
+    /// Where the M-cycles of the run of instructions the clock is moved ahead of are patched in.
+    size_t runCycles = 0;
+    uint32_t cycles = 0;
+
+    /// push rbx; push r12; push rax (align stack); mov rbx, rdi; mov r12, rsi
+    emit({ 0x53, 0x41, 0x54, 0x50, 0x48, 0x89, 0xFB, 0x49, 0x89, 0xF4 });
+    for (size_t i = 0; i < block.instructions.size(); i++)
+    {
+        auto &decoded = block.instructions[i];
+        if (runCycles == 0)
+        {
+            /// Move the clock ahead of the instructions up to and including the next call into the interpreter, which
+            /// is the first that can observe it. Leave if an event is due before they finish.
+            /// mov rdi, r12; mov esi, cycles; mov rax, advanceClock; call rax; test al, al; je exit
+            emit({ 0x4C, 0x89, 0xE7, 0xBE });
+            runCycles = _codeSize;
+            emitValue<uint32_t>(0);
+            emit({ 0x48, 0xB8 });
+            emitValue(reinterpret_cast<uint64_t>(&advanceClock));
+            emit({ 0xFF, 0xD0, 0x84, 0xC0, 0x0F, 0x84 });
+            exits[exitCount++] = _codeSize;
+            emitValue<int32_t>(0);
+        }
+        /// mov word [rbx + programCounter], next
+        emit({ 0x66, 0xC7, 0x83 });
+        emitValue(displacement(&_cpu._registers.programCounter));
+        emitValue(static_cast<uint16_t>(decoded.address + decoded.length));
+        /// add qword [rbx + instructionCount], 1
+        emit({ 0x48, 0x83, 0x83 });
+        emitValue(displacement(&_cpu._instructionCount));
+        emit({ 0x01 });
+        bool inlined = emitInline(decoded);
+        if (!inlined)
+        {
+            emitCall(decoded);
+        }
+        /// add qword [rbx + mCycleCount], cycles
+        emit({ 0x48, 0x83, 0x83 });
+        emitValue(displacement(&_cpu._mCycleCount));
+        emit({ decoded.descriptor->getCycles() });
+        cycles += decoded.descriptor->getCycles();
+        require_or(!inlined, continue);
+        memcpy(&_code[runCycles], &cycles, sizeof(cycles));
+        runCycles = 0;
+        cycles = 0;
+        require_or(i + 1 < block.instructions.size(), continue);
+        /// Leave if the instruction invalidated decoded code.
+        /// cmp qword [rbx + block], 0; je exit
+        emit({ 0x48, 0x83, 0xBB });
+        emitValue(displacement(&_cpu._block));
+        emit({ 0x00, 0x0F, 0x84 });
+        exits[exitCount++] = _codeSize;
+        emitValue<int32_t>(0);
+    }
+    if (runCycles)
+    {
+        memcpy(&_code[runCycles], &cycles, sizeof(cycles));
+    }
+    for (size_t i = 0; i < exitCount; i++)
+    {
+        int32_t relative = static_cast<int32_t>(_codeSize - (exits[i] + sizeof(int32_t)));
+        memcpy(&_code[exits[i]], &relative, sizeof(int32_t));
+    }
+    /// pop rax; pop r12; pop rbx; ret
+    emit({ 0x58, 0x41, 0x5C, 0x5B, 0xC3 });
+    return entry;
+}
+
+bool
+BlockCompiler::emitInline(const CentralProcessor::decodedInstruction &decoded)
+{
+    auto descriptor = decoded.descriptor;
+    require_or(descriptor->getSet() == instructionSet::set8bit && descriptor->getName(), return false);
+    uint8_t opcode = descriptor->getOpcode();
+    uint8_t dst = (opcode >> 3) & 0x07;
+    uint8_t src = opcode & 0x07;
+    /// NOP
+    if (opcode == 0x00)
+    {
+        return true;
+    }
+    /// LD r,r' (excluding HALT and (HL) operands)
+    if ((opcode & 0xC0) == 0x40 && opcode != 0x76 && src != 6 && dst != 6)
+    {
+        /// mov al, [rbx + src]; mov [rbx + dst], al
+        emit({ 0x8A, 0x83 });
+        emitValue(registerDisplacement(src));
+        emit({ 0x88, 0x83 });
+        emitValue(registerDisplacement(dst));
+        return true;
+    }
+    /// LD r,d8 (excluding (HL))
+    if ((opcode & 0xC7) == 0x06 && dst != 6)
+    {
+        /// mov byte [rbx + dst], imm8
+        emit({ 0xC6, 0x83 });
+        emitValue(registerDisplacement(dst));
+        emitValue(static_cast<uint8_t>(decoded.imm));
+        return true;
+    }
+    /// LD rr,d16
+    if ((opcode & 0xCF) == 0x01)
+    {
+        /// mov word [rbx + rr], imm16
+        emit({ 0x66, 0xC7, 0x83 });
+        emitValue(widePairDisplacement(opcode >> 4));
+        emitValue(decoded.imm);
+        return true;
+    }
+    /// INC rr, DEC rr
+    if ((opcode & 0xC7) == 0x03)
+    {
+        /// inc/dec word [rbx + rr]
+        emit({ 0x66, 0xFF, static_cast<uint8_t>((opcode & 0x08) ? 0x8B : 0x83) });
+        emitValue(widePairDisplacement((opcode >> 4) & 0x03));
+        return true;
+    }
+    return false;
+}
+
+void
+BlockCompiler::emitCall(const CentralProcessor::decodedInstruction &decoded)
+{
+    GameboyInstructionSet8bit::handler_t handler = nullptr;
+    uint8_t opcode = decoded.descriptor->getOpcode();
+    switch (decoded.descriptor->getSet())
+    {
+    case instructionSet::set8bit:
+        handler = GameboyInstructionSet8bit::getHandler(opcode);
+        break;
+    case instructionSet::set16bit:
+        handler = GameboyInstructionSet16bit::getHandler(opcode);
+        break;
+    case instructionSet::stop:
+        handler = GameboyInstructionSetStop::getHandler(opcode);
+        break;
+    case instructionSet::fused:
+        /// Blocks are compiled from their plain instructions, fused sequences only run in the interpreters.
+        assert(false);
+        break;
+    case instructionSet::none:
+        break;
+    }
+    assert(handler);
+    /// mov rdi, rbx; mov esi, imm32; mov rax, handler; call rax
+    emit({ 0x48, 0x89, 0xDF, 0xBE });
+    emitValue(static_cast<uint32_t>(decoded.imm));
+    emit({ 0x48, 0xB8 });
+    emitValue(reinterpret_cast<uint64_t>(handler));
+    emit({ 0xFF, 0xD0 });
+}
+
+int32_t
+BlockCompiler::registerDisplacement(uint8_t index) const
+{
+    auto &registers = _cpu._registers;
+    const uint8_t *kRegisters[] = { &registers.b, &registers.c, &registers.d, &registers.e,
+                                    &registers.h, &registers.l, nullptr, &registers.a };
+    assert(index < 8 && kRegisters[index]);
+    return displacement(kRegisters[index]);
+}
+
+int32_t
+BlockCompiler::widePairDisplacement(uint8_t index) const
+{
+    auto &registers = _cpu._registers;
+    const uint16_t *kRegisters[] = { &registers.bc, &registers.de, &registers.hl, &registers.stackPointer };
+    assert(index < 4);
+    return displacement(kRegisters[index]);
+}
@@ -0,0 +1,72 @@
+#ifndef _CPU_JIT_H_
+#define _CPU_JIT_H_
+
+#include "cpu.h"
+#include "platform.h"
+
+namespace emu::gameboy::jit {
+/**
+ * @brief Translates decoded blocks into x86-64 code.
+ *
+ * Every guest instruction is either emitted inline (register loads/moves and 16-bit increments), or as a direct call
+ * into the interpreter's handler for the opcode. The generated code writes the program counter, counts instructions
+ * and M-cycles, and moves the clock ahead of each run of inline instructions and the call that ends it, the way the
+ * interpreter moves it ahead of each instruction. It exits before a run that an event is due in, and after a call
+ * that invalidated decoded code.
+ */
+class BlockCompiler
+{
+public:
+    using compiledBlock = void (*)(CentralProcessor *, ::emu::Scheduler *);
+
+    static constexpr size_t kCodeCacheSize = 4U << 20;
+
+public:
+    BlockCompiler(CentralProcessor &cpu);
+    ~BlockCompiler();
+
+    /// @brief True when the host can run generated code.
+    static bool isSupported();
+    bool isValid() const { return _code != nullptr; }
+
+    /// @brief Translate a block, returns nullptr when the code cache is full.
+    compiledBlock compile(const CentralProcessor::decodedBlock &block);
+    /// @brief Discard all generated code.
+    void flush() { _codeSize = 0; }
+
+private:
+    bool emitInline(const CentralProcessor::decodedInstruction &decoded);
+    void emitCall(const CentralProcessor::decodedInstruction &decoded);
+
+    void emit(std::initializer_list<uint8_t> bytes)
+    {
+        for (auto byte: bytes)
+        {
+            _code[_codeSize++] = byte;
+        }
+    }
+    template<typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
+    void emitValue(T value)
+    {
+        memcpy(&_code[_codeSize], &value, sizeof(T));
+        _codeSize += sizeof(T);
+    }
+
+    /// @brief Displacement of a CPU member from the CPU, which is held in `rbx` by generated code.
+    int32_t displacement(const void *member) const
+    {
+        return static_cast<int32_t>(reinterpret_cast<const uint8_t *>(member) - reinterpret_cast<const uint8_t *>(&_cpu));
+    }
+    /// @brief Displacement of an 8-bit register, indexed by its encoding in an opcode (B, C, D, E, H, L, (HL), A).
+    int32_t registerDisplacement(uint8_t index) const;
+    /// @brief Displacement of a 16-bit register, indexed by its encoding in an opcode (BC, DE, HL, SP).
+    int32_t widePairDisplacement(uint8_t index) const;
+
+private:
+    CentralProcessor &  _cpu;
+    uint8_t *           _code = nullptr;
+    size_t              _codeSize = 0;
+};
+} // namespace emu::gameboy::jit
+
+#endif /* _CPU_JIT_H_ */
@@ -0,0 +1,142 @@
+#include "cpu.h"
+#include "cpu_instr.h"
+
+#include <bit>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace emu::gameboy;
+using namespace emu::gameboy::detail::cpu;
+using namespace emu::gameboy::instruction;
+
+bool
+InstructionTrace::startStreaming(const char *filename, uint32_t capacity)
+{
+    require_or(filename && capacity > 0 && capacity <= (1U << 31), log_error("Invalid trace file!"); return false);
+    stopStreaming();
+    capacity = std::bit_ceil(capacity);
+    size_t fileSize = sizeof(fileHeader) + (static_cast<size_t>(capacity) * sizeof(traceRecord));
+    int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    require_or(fd >= 0, log_error("Failed to open %s (%s)", filename, strerror(errno)); return false);
+    require_or(ftruncate(fd, fileSize) == 0,
+               log_error("Failed to size %s (%s)", filename, strerror(errno)); close(fd); return false);
+    void *file = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    /// The mapping holds its own reference to the file.
+    close(fd);
+    require_or(file != MAP_FAILED, log_error("Failed to map %s (%s)", filename, strerror(errno)); return false);
+
+    _file = static_cast<fileHeader *>(file);
+    _fileSize = fileSize;
+    _file->magic = kFileMagic;
+    _file->recordSize = sizeof(traceRecord);
+    _file->capacity = capacity;
+    _file->count = 0;
+    _records = reinterpret_cast<traceRecord *>(_file + 1);
+    _count = &_file->count;
+    _mask = capacity - 1;
+    return true;
+}
+
+void
+InstructionTrace::stopStreaming()
+{
+    require_or(_file, return);
+    msync(_file, _fileSize, MS_SYNC);
+    munmap(_file, _fileSize);
+    _file = nullptr;
+    _fileSize = 0;
+    _records = _buffer.data();
+    _count = &_bufferCount;
+    _mask = kRecords - 1;
+}
+
+bool
+TraceFile::open(const char *filename)
+{
+    close();
+    int fd = ::open(filename, O_RDONLY);
+    require_or(fd >= 0, log_error("Failed to open %s (%s)", filename, strerror(errno)); return false);
+    struct stat info = {};
+    fstat(fd, &info);
+    size_t size = static_cast<size_t>(info.st_size);
+    require_or(size >= sizeof(InstructionTrace::fileHeader),
+               log_error("%s is not a trace file", filename); ::close(fd); return false);
+    void *file = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    require_or(file != MAP_FAILED, log_error("Failed to map %s (%s)", filename, strerror(errno)); return false);
+
+    auto header = static_cast<const InstructionTrace::fileHeader *>(file);
+    require_or(header->magic == InstructionTrace::kFileMagic && header->recordSize == sizeof(traceRecord) &&
+               header->capacity > 0 && (header->capacity & (header->capacity - 1)) == 0 &&
+               size >= sizeof(*header) + (header->capacity * sizeof(traceRecord)),
+               log_error("%s is not a trace file", filename); munmap(file, size); return false);
+    _header = header;
+    _size = size;
+    return true;
+}
+
+void
+TraceFile::close()
+{
+    require_or(_header, return);
+    munmap(const_cast<InstructionTrace::fileHeader *>(_header), _size);
+    _header = nullptr;
+    _size = 0;
+}
+
+/* static */
+const ::emu::gameboy::instruction::instruction *
+InstructionTrace::getInstruction(const traceRecord &record)
+{
+    switch (static_cast<instructionSet>(record.set))
+    {
+    case instructionSet::set8bit:
+        return GameboyInstructionSet8bit::getInstruction(record.opcode);
+    case instructionSet::set16bit:
+        return GameboyInstructionSet16bit::getInstruction(record.opcode);
+    case instructionSet::stop:
+        return GameboyInstructionSetStop::getInstruction(record.opcode);
+    default:
+        return nullptr;
+    }
+}
+
+/* static */
+void
+InstructionTrace::print(const traceRecord &record, bool full)
+{
+    static constexpr const char *kEventNames[] = { "INT", "HDEL", "INT %x" };
+    const char *name = nullptr;
+    if (static_cast<instructionSet>(record.set) == instructionSet::none)
+    {
+        name = (record.opcode < std::size(kEventNames)) ? kEventNames[record.opcode] : nullptr;
+    }
+    else
+    {
+        name = getInstruction(record)->getName();
+    }
+    char nameBuffer[16];
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+    snprintf(nameBuffer, sizeof(nameBuffer), name ? name : "???", record.imm);
+#pragma GCC diagnostic pop
+    require_or(full, printf("0x%04x:  %s \n", record.programCounter, nameBuffer); return);
+
+    registers reg;
+    reg.bc = record.bc;
+    reg.de = record.de;
+    reg.hl = record.hl;
+    reg.setAF(record.af);
+    reg.deferFlags(static_cast<registers::flagOperation>(record.flagOp), record.flagOperands, record.flagResult);
+    auto &flags = reg.getFlags();
+    printf("%s:\n", nameBuffer);
+    printf("\tM-Cycle = %llu\n"
+           "\tProgram Counter = 0x%X, Stack Pointer = 0x%X\n"
+           "\tRegister b = 0x%X, Register c = 0x%X\n"
+           "\tRegister d = 0x%X, Register e = 0x%X\n"
+           "\tRegister h = 0x%X, Register h = 0x%X\n"
+           "\tRegister a = 0x%X, fZero %u, fSubtract %u, fCarry %u, fHalfCarry %u\n",
+           static_cast<unsigned long long>(record.mCycle), record.programCounter, record.stackPointer,
+           reg.b, reg.c, reg.d, reg.e, reg.h, reg.l, reg.a, flags.zero, flags.subtract, flags.carry, flags.halfCarry);
+}
@@ -3,8 +3,12 @@
 
 #include "platform.h"
 
+#include <atomic>
+
 #define kHalWindowScaleFactor   (4ul)
 #define kHalWindowDelayMs60FPS  (17)
+#define kHalPixelBufferFrames   (3)
+#define kHalPixelBufferFresh    (0x80)
 #define kHalNSecToMSec          (1000ull * 1000ull)
 #define kHalAudioMinPitch       (0.01)
 #define kHalAudioMinGain        (0.01)
@@ -38,14 +42,22 @@ typedef enum HAL_PixelColor
 /** @brief keyboard event callback function type. */
 using HAL_KeyboardEventPtr = std::function<void(char, int, int)>;
 
-/** @brief Pixel buffer used by emulator to set pixels, then read by window driver. */
+/**
+ * @brief Pixel buffer used by emulator to set pixels, then read by window driver.
+ *
+ * Triple buffered, the emulator draws into the back frame without locking and publishes it when it is complete, the
+ * display takes the latest published frame. Neither side ever waits for the other, and the display never sees a frame
+ * that is still being drawn. Frames are `sizeY` rows of `sizeX` pixels, back to back.
+ */
 typedef struct HAL_PixelBuffer
 {
-    pthread_mutex_t lock;       /// Lock primative
-    uint8_t         **buffer;   /// buffer pointer
-    uint16_t        sizeX;      /// horizontal size
-    uint16_t        sizeY;      /// vertical size
-    HAL_State       state;      /// current state
+    uint8_t *            frames;    /// kHalPixelBufferFrames frames
+    uint8_t              back;      /// frame the emulator draws, only used by the emulator thread
+    uint8_t              front;     /// frame the display shows, only used by the display thread
+    std::atomic<uint8_t> pending;   /// last published frame, kHalPixelBufferFresh until the display takes it
+    uint16_t             sizeX;     /// horizontal size
+    uint16_t             sizeY;     /// vertical size
+    HAL_State            state;     /// current state
 } HAL_PixelBuffer;
 
 /**
@@ -63,19 +75,7 @@ HAL_PixelBuffer *HAL_PixelBufferCreate(uint16_t sizeX, uint16_t sizeY);
  */
 void HAL_PixelBufferDestroy(HAL_PixelBuffer *pixelBuffer);
 /**
- * @brief Locks the pixel buffer, granting exclusive read/write access to pixels.
- *
- * @param[in] pixelBuffer Pixel buffer object.
- */
-void HAL_PixelBufferReserve(HAL_PixelBuffer *pixelBuffer);
-/**
- * @brief Unlocks the pixel buffer.
- *
- * @param[in] pixelBuffer Pixel buffer object.
- */
-void HAL_PixelBufferRelease(HAL_PixelBuffer *pixelBuffer);
-/**
- * @brief Write a pixel in the pixel buffer.
+ * @brief Write a pixel in the back frame.
  *
  * @param[in] pixelBuffer Pixel buffer object.
  * @param[in] positionX Horizontal position of the pixel
@@ -86,7 +86,7 @@ void HAL_PixelBufferRelease(HAL_PixelBuffer *pixelBuffer);
 uint32_t HAL_PixelBufferSetPixel(HAL_PixelBuffer *pixelBuffer, uint8_t positionX, uint8_t positionY,
                                  uint8_t brightness);
 /**
- * @brief Read a pixel in the pixel buffer
+ * @brief Read a pixel in the back frame, the one the emulator is drawing.
  *
  * @param[in] pixelBuffer Pixel buffer object.
  * @param[in] positionX Horizontal position of the pixel
@@ -96,6 +96,28 @@ uint32_t HAL_PixelBufferSetPixel(HAL_PixelBuffer *pixelBuffer, uint8_t positionX
  */
 uint32_t HAL_PixelBufferGetPixel(HAL_PixelBuffer *pixelBuffer, uint8_t positionX, uint8_t positionY,
                                  uint8_t *brightness);
+/**
+ * @brief Get a row of the back frame, to write a whole line at once.
+ *
+ * @param[in] pixelBuffer Pixel buffer object.
+ * @param[in] positionY Vertical position of the row.
+ * @return uint8_t * sizeX pixels, NULL if not initialized or out of range.
+ */
+uint8_t *HAL_PixelBufferGetLine(HAL_PixelBuffer *pixelBuffer, uint8_t positionY);
+/**
+ * @brief Publish the back frame to the display and start drawing into another one, called by the emulator.
+ *
+ * @param[in] pixelBuffer Pixel buffer object.
+ */
+void HAL_PixelBufferPublish(HAL_PixelBuffer *pixelBuffer);
+/**
+ * @brief Get the latest published frame, called by the display.
+ *
+ * @param[in] pixelBuffer Pixel buffer object.
+ * @param[out] fresh True if the frame wasn't returned before.
+ * @return const uint8_t * Frame, valid until the next call, NULL if not initialized.
+ */
+const uint8_t *HAL_PixelBufferAcquire(HAL_PixelBuffer *pixelBuffer, bool *fresh);
 /**
  * @brief Get the pixel buffer horizontal size.
  *
@@ -117,13 +139,6 @@ uint16_t HAL_PixelBufferGetSizeY(HAL_PixelBuffer *pixelBuffer);
  * @return HAL_State Pixel buffer state.
  */
 HAL_State HAL_PixelBufferGetState(HAL_PixelBuffer *pixelBuffer);
-/**
- * @brief Marks the pixel buffer as running.
- *
- * @param[in] pixelBuffer Pixel buffer object.
- * @param[in] ready Bool indicating if the pixel buffer is running.
- */
-uint32_t HAL_PixelBufferSetReady(HAL_PixelBuffer *pixelBuffer, bool ready);
 
 /**
  * @brief Initialize the display driver.
@@ -177,17 +192,7 @@ uint32_t HAL_DisplayCancel(void);
  */
 HAL_State HAL_DisplayGetState(void);
 /**
- * @brief Locks the pixel buffer, granting exclusive read/write access to pixels.
- *
- */
-void HAL_DisplayReserve(void);
-/**
- * @brief Unlocks the pixel buffer.
- *
- */
-void HAL_DisplayRelease(void);
-/**
- * @brief Write a pixel in the pixel buffer.
+ * @brief Write a pixel in the back frame.
  *
  * @param[in] positionX Horizontal position of the pixel
  * @param[in] positionY Vertical position of the pixel
@@ -196,7 +201,7 @@ void HAL_DisplayRelease(void);
  */
 uint32_t HAL_DisplaySetPixel(uint8_t positionX, uint8_t positionY, uint8_t brightness);
 /**
- * @brief Read a pixel in the pixel buffer
+ * @brief Read a pixel in the back frame, the one the emulator is drawing.
  *
  * @param[in] positionX Horizontal position of the pixel
  * @param[in] positionY Vertical position of the pixel
@@ -204,6 +209,18 @@ uint32_t HAL_DisplaySetPixel(uint8_t positionX, uint8_t positionY, uint8_t brigh
  * @return uint32_t Return code, 0 on success
  */
 uint32_t HAL_DisplayGetPixel(uint8_t positionX, uint8_t positionY, uint8_t *brightness);
+/**
+ * @brief Get a row of the back frame, to write a whole line at once.
+ *
+ * @param[in] positionY Vertical position of the row.
+ * @return uint8_t * Pixels of the row, NULL if not initialized or out of range.
+ */
+uint8_t *HAL_DisplayGetLine(uint8_t positionY);
+/**
+ * @brief Publish the back frame to the display, once per frame when it is complete.
+ *
+ */
+void HAL_DisplayPublish(void);
 /**
  * @brief Get the pixel buffer horizontal size.
  *
@@ -222,12 +239,6 @@ uint16_t HAL_DisplayGetSizeY(void);
  * @return HAL_State Pixel buffer state.
  */
 HAL_State HAL_DisplayGetState(void);
-/**
- * @brief Marks the pixel buffer as running.
- *
- * @param[in] ready Bool indicating if the pixel buffer is running.
- */
-void HAL_DisplaySetReady(bool ready);
 
 /** @brief Timer callback type. */
 typedef void (*HAL_TimerCallbackPtr)(void *);
@@ -0,0 +1,74 @@
+#ifndef _HAL_PIXEL_H_
+#define _HAL_PIXEL_H_
+
+#include "platform.h"
+
+/**
+ * @brief Instruction set the pixel kernels run with.
+ *
+ * The best one the host supports is picked by a static initializer before main, so the emulation and display threads
+ * share it without locking, x86-64 hosts have at least SSE2. `HAL_PixelSetISA` is not thread safe, only call it
+ * while no kernel runs.
+ */
+typedef enum HAL_PixelISA
+{
+    HAL_PIXEL_ISA_SCALAR = 0,
+    HAL_PIXEL_ISA_SSE2,
+    HAL_PIXEL_ISA_AVX2,
+    HAL_PIXEL_ISA_COUNT,
+} HAL_PixelISA;
+
+/**
+ * @brief Check if the host can run the pixel kernels with an instruction set.
+ *
+ * @param[in] isa Instruction set.
+ * @return bool True if supported, the scalar kernels always are.
+ */
+bool HAL_PixelIsISASupported(HAL_PixelISA isa);
+/**
+ * @brief Select the instruction set the pixel kernels run with, e.g. to compare them.
+ *
+ * @param[in] isa Instruction set.
+ * @return uint32_t Return code, 0 on success.
+ */
+uint32_t HAL_PixelSetISA(HAL_PixelISA isa);
+/**
+ * @brief Get the instruction set the pixel kernels run with.
+ *
+ * @return HAL_PixelISA Instruction set.
+ */
+HAL_PixelISA HAL_PixelGetISA(void);
+/**
+ * @brief Get the name of an instruction set.
+ *
+ * @param[in] isa Instruction set.
+ * @return const char * Name, "unknown" if out of range.
+ */
+const char *HAL_PixelGetISAName(HAL_PixelISA isa);
+/**
+ * @brief Decode the 16 bytes of a 2bpp tile to one color index (0-3) per pixel.
+ *
+ * @param[in] tile Tile data, the low then high bitplane of each row, top to bottom.
+ * @param[out] indices 64 color indices, rows top to bottom and pixels left to right.
+ * @param[out] flipped 64 color indices with every row flipped horizontally.
+ */
+void HAL_PixelDecodeTile(const uint8_t *tile, uint8_t *indices, uint8_t *flipped);
+/**
+ * @brief Map color indices through a BGP/OBP0/OBP1 style palette to pixel brightness.
+ *
+ * @param[in] indices Color indices (0-3).
+ * @param[in] palette Palette register, 2 bits of shade per color index.
+ * @param[out] brightness One `HAL_PixelColor` per index.
+ * @param[in] count Number of pixels.
+ */
+void HAL_PixelApplyPalette(const uint8_t *indices, uint8_t palette, uint8_t *brightness, uint16_t count);
+/**
+ * @brief Convert pixel brightness to opaque gray ARGB8888 pixels, the format of the display texture.
+ *
+ * @param[in] brightness Pixel brightness (0-255).
+ * @param[out] argb One pixel per brightness, 0xAARRGGBB in host byte order.
+ * @param[in] count Number of pixels.
+ */
+void HAL_PixelToARGB8888(const uint8_t *brightness, uint32_t *argb, uint16_t count);
+
+#endif /* _HAL_PIXEL_H_ */
@@ -55,28 +55,27 @@
 #endif
 
 #include "hal.h"
+#include "hal_pixel.h"
 
 HAL_PixelBuffer *
 HAL_PixelBufferCreate(uint16_t sizeX, uint16_t sizeY)
 {
-    HAL_PixelBuffer *pixelBuffer = (HAL_PixelBuffer *)malloc(sizeof(HAL_PixelBuffer));
+    HAL_PixelBuffer *pixelBuffer = new (std::nothrow) HAL_PixelBuffer();
     require_or(pixelBuffer, return NULL);
 
     pixelBuffer->sizeX = sizeX;
     pixelBuffer->sizeY = sizeY;
     pixelBuffer->state = HAL_STATE_CREATED;
 
-    pixelBuffer->buffer = (uint8_t **)malloc(sizeY * sizeof(uint8_t *));
-    require_or(pixelBuffer->buffer, free(pixelBuffer); return NULL);
-    pthread_mutex_init(&pixelBuffer->lock, NULL);
-
-    for (uint16_t y = 0; y < sizeY; y++)
-    {
-        pixelBuffer->buffer[y] = (uint8_t *)malloc(sizeX * sizeof(uint8_t));
-        require_or(pixelBuffer->buffer[y], HAL_PixelBufferDestroy(pixelBuffer); return NULL);
-        memset(pixelBuffer->buffer[y], HAL_LCD_PIXEL_COLOR_WHITE, sizeX);
-    }
+    size_t frame_size = (size_t)sizeX * sizeY;
+    pixelBuffer->frames = (uint8_t *)malloc(kHalPixelBufferFrames * frame_size);
+    require_or(pixelBuffer->frames, delete pixelBuffer; return NULL);
+    memset(pixelBuffer->frames, HAL_LCD_PIXEL_COLOR_WHITE, kHalPixelBufferFrames * frame_size);
 
+    // every frame has one owner: the emulator, the display or the pending slot between them
+    pixelBuffer->back = 0;
+    pixelBuffer->pending = 1;
+    pixelBuffer->front = 2;
     return pixelBuffer;
 }
 
@@ -84,50 +83,23 @@ void
 HAL_PixelBufferDestroy(HAL_PixelBuffer *pixelBuffer)
 {
     assert(pixelBuffer);
-    require_or(pixelBuffer->buffer, return);
+    require_or(pixelBuffer->frames, return);
     require_or(pixelBuffer->state != HAL_STATE_INACTIVE, return);
 
-    HAL_PixelBufferReserve(pixelBuffer);
-
-    // free all buffers
-    for (uint16_t y = 0; y < pixelBuffer->sizeY; y++)
-    {
-        require_or(pixelBuffer->buffer[y], continue);
-        free(pixelBuffer->buffer[y]);
-        pixelBuffer->buffer[y] = NULL;
-    }
-
-    free(pixelBuffer->buffer);
-    pixelBuffer->buffer = NULL;
+    free(pixelBuffer->frames);
+    pixelBuffer->frames = NULL;
     pixelBuffer->sizeX = pixelBuffer->sizeY = 0;
     pixelBuffer->state = HAL_STATE_INACTIVE;
-    pthread_mutex_destroy(&pixelBuffer->lock);
-}
-
-void
-HAL_PixelBufferReserve(HAL_PixelBuffer *pixelBuffer)
-{
-    assert(pixelBuffer->buffer && pixelBuffer->state != HAL_STATE_INACTIVE);
-    LOCK(pixelBuffer->lock);
-}
-
-void
-HAL_PixelBufferRelease(HAL_PixelBuffer *pixelBuffer)
-{
-    assert(pixelBuffer->buffer && pixelBuffer->state != HAL_STATE_INACTIVE);
-    UNLOCK(pixelBuffer->lock);
 }
 
 uint32_t
 HAL_PixelBufferSetPixel(HAL_PixelBuffer *pixelBuffer, uint8_t positionX, uint8_t positionY, uint8_t brightness)
 {
-    require_or(pixelBuffer->buffer && pixelBuffer->state != HAL_STATE_INACTIVE, return kReturnEPixelBufferNull);
+    require_or(pixelBuffer->frames && pixelBuffer->state != HAL_STATE_INACTIVE, return kReturnEPixelBufferNull);
     require_or(positionX < pixelBuffer->sizeX, return kReturnEPixelBufferInvalidX);
     require_or(positionY < pixelBuffer->sizeY, return kReturnEPixelBufferInvalidY);
-    require_or(pthread_mutex_trylock(&pixelBuffer->lock) != 0, return kReturnEPixelBufferNotLocked);
 
-    /// @todo can we write directly to SDL here?
-    pixelBuffer->buffer[positionY][positionX] = brightness;
+    HAL_PixelBufferGetLine(pixelBuffer, positionY)[positionX] = brightness;
     return kReturnOK;
 }
 
@@ -136,26 +108,58 @@ HAL_PixelBufferGetPixel(HAL_PixelBuffer *pixelBuffer, uint8_t positionX, uint8_t
 {
     require_or(brightness, return kReturnEBadArgument);
     *brightness = 0;
-    require_or(pixelBuffer->buffer && pixelBuffer->state != HAL_STATE_INACTIVE, return kReturnEPixelBufferNull);
+    require_or(pixelBuffer->frames && pixelBuffer->state != HAL_STATE_INACTIVE, return kReturnEPixelBufferNull);
     require_or(positionX < pixelBuffer->sizeX, return kReturnEPixelBufferInvalidX);
     require_or(positionY < pixelBuffer->sizeY, return kReturnEPixelBufferInvalidY);
-    require_or(pthread_mutex_trylock(&pixelBuffer->lock) != 0, return kReturnEPixelBufferNotLocked);
 
-    emu::assign(brightness, pixelBuffer->buffer[positionY][positionX]);
+    emu::assign(brightness, HAL_PixelBufferGetLine(pixelBuffer, positionY)[positionX]);
     return kReturnOK;
 }
 
+uint8_t *
+HAL_PixelBufferGetLine(HAL_PixelBuffer *pixelBuffer, uint8_t positionY)
+{
+    require_or(pixelBuffer->frames && pixelBuffer->state != HAL_STATE_INACTIVE, return NULL);
+    require_or(positionY < pixelBuffer->sizeY, return NULL);
+    size_t frame_size = (size_t)pixelBuffer->sizeX * pixelBuffer->sizeY;
+    return pixelBuffer->frames + pixelBuffer->back * frame_size + (size_t)positionY * pixelBuffer->sizeX;
+}
+
+void
+HAL_PixelBufferPublish(HAL_PixelBuffer *pixelBuffer)
+{
+    require_or(pixelBuffer->frames && pixelBuffer->state != HAL_STATE_INACTIVE, return);
+    // release the drawn frame, take back the one the display skipped or already let go of
+    uint8_t previous = pixelBuffer->pending.exchange(pixelBuffer->back | kHalPixelBufferFresh, std::memory_order_acq_rel);
+    pixelBuffer->back = previous & ~kHalPixelBufferFresh;
+}
+
+const uint8_t *
+HAL_PixelBufferAcquire(HAL_PixelBuffer *pixelBuffer, bool *fresh)
+{
+    require_or(fresh, return NULL);
+    *fresh = false;
+    require_or(pixelBuffer->frames && pixelBuffer->state != HAL_STATE_INACTIVE, return NULL);
+    if (pixelBuffer->pending.load(std::memory_order_relaxed) & kHalPixelBufferFresh)
+    {
+        uint8_t previous = pixelBuffer->pending.exchange(pixelBuffer->front, std::memory_order_acq_rel);
+        pixelBuffer->front = previous & ~kHalPixelBufferFresh;
+        *fresh = true;
+    }
+    return pixelBuffer->frames + pixelBuffer->front * (size_t)pixelBuffer->sizeX * pixelBuffer->sizeY;
+}
+
 uint16_t
 HAL_PixelBufferGetSizeX(HAL_PixelBuffer *pixelBuffer)
 {
-    require_or(pixelBuffer->buffer && pixelBuffer->state != HAL_STATE_INACTIVE, return 0);
+    require_or(pixelBuffer->frames && pixelBuffer->state != HAL_STATE_INACTIVE, return 0);
     return pixelBuffer->sizeX;
 }
 
 uint16_t
 HAL_PixelBufferGetSizeY(HAL_PixelBuffer *pixelBuffer)
 {
-    require_or(pixelBuffer->buffer && pixelBuffer->state != HAL_STATE_INACTIVE, return 0);
+    require_or(pixelBuffer->frames && pixelBuffer->state != HAL_STATE_INACTIVE, return 0);
     return pixelBuffer->sizeY;
 }
 
@@ -166,19 +170,12 @@ HAL_PixelBufferGetState(HAL_PixelBuffer *pixelBuffer)
     return pixelBuffer->state;
 }
 
-uint32_t
-HAL_PixelBufferSetReady(HAL_PixelBuffer *pixelBuffer, bool ready)
-{
-    require_or(pixelBuffer->buffer && pixelBuffer->state != HAL_STATE_INACTIVE, return kReturnEPixelBufferNull);
-    pixelBuffer->state = (ready) ? HAL_STATE_RUNNING : HAL_STATE_CREATED;
-    return kReturnOK;
-}
-
 typedef struct HAL_Display
 {
 #if (USE_SDL_GRAPHICS == 1)
     SDL_Window *            window;
     SDL_Renderer *          renderer;
+    SDL_Texture *           texture;
     HAL_KeyboardEventPtr    keyboardEventCallback;
 #elif (USE_OPENGL_GRAPHICS == 1)
     const char *            windowName;
@@ -282,29 +279,44 @@ HAL_DisplayCheckForEvents(void)
 static void
 HAL_DisplaySetFrame(void)
 {
-    HAL_State pixel_buffer_state = HAL_PixelBufferGetState(halDisplay.pixelBuffer);
+    // only redraw when the emulator published a new frame
+    bool fresh;
+    const uint8_t *frame = HAL_PixelBufferAcquire(halDisplay.pixelBuffer, &fresh);
 #if (USE_SDL_GRAPHICS == 1)
-    require_or(pixel_buffer_state == HAL_STATE_RUNNING, return);
+    require_or(frame && fresh, return);
     SDL_RenderClear(halDisplay.renderer);
 #elif (USE_OPENGL_GRAPHICS == 1)
-    require_or(pixel_buffer_state == HAL_STATE_RUNNING, glutPostRedisplay(); return);
+    require_or(frame && fresh, glutPostRedisplay(); return);
     // Set background color to black and opaque
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
     glClear(GL_COLOR_BUFFER_BIT);
+#else
+    require_or(frame && fresh, return);
 #endif
-    // gain exclusive access to pixel buffer
-    HAL_PixelBufferReserve(halDisplay.pixelBuffer);
     uint16_t size_x = HAL_PixelBufferGetSizeX(halDisplay.pixelBuffer);
     uint16_t size_y = HAL_PixelBufferGetSizeY(halDisplay.pixelBuffer);
+#if (USE_SDL_GRAPHICS == 1)
+    // convert whole rows into the texture rather than drawing every pixel
+    void *pixels;
+    int pitch;
+    if (SDL_LockTexture(halDisplay.texture, NULL, &pixels, &pitch) == 0)
+    {
+        for (uint16_t y = 0; y < size_y; y++)
+        {
+            HAL_PixelToARGB8888(frame + y * size_x, (uint32_t *)((uint8_t *)pixels + y * pitch), size_x);
+        }
+        SDL_UnlockTexture(halDisplay.texture);
+        SDL_RenderCopy(halDisplay.renderer, halDisplay.texture, NULL, NULL);
+    }
+#else
     for (uint16_t y = 0; y < size_y; y++)
     {
         for (uint16_t x = 0; x < size_x; x++)
         {
-            uint8_t brightness;
-            HAL_PixelBufferGetPixel(halDisplay.pixelBuffer, x, y, &brightness);
-            HAL_DisplayDrawPixel(x, y, brightness);
+            HAL_DisplayDrawPixel(x, y, frame[y * size_x + x]);
         }
     }
+#endif
 #if (SHOW_TILE_OUTLINES == 1)
     for (uint16_t tile_x = 0; tile_x < size_x; tile_x += 8)
     {
@@ -315,8 +327,6 @@ HAL_DisplaySetFrame(void)
         HAL_DisplayDrawLine(0, size_x, tile_y, tile_y);
     }
 #endif
-    HAL_PixelBufferSetReady(halDisplay.pixelBuffer, false);
-    HAL_PixelBufferRelease(halDisplay.pixelBuffer);
 
 #if (USE_SDL_GRAPHICS == 1)
     SDL_RenderPresent(halDisplay.renderer);
@@ -365,6 +375,17 @@ HAL_DisplayInit(const char *windowName, uint16_t sizeX, uint16_t sizeY)
     }
 
     SDL_RenderSetScale(halDisplay.renderer, kHalWindowScaleFactor, kHalWindowScaleFactor);
+
+    halDisplay.texture = SDL_CreateTexture(halDisplay.renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                           sizeX, sizeY);
+    if (halDisplay.texture == NULL)
+    {
+        log_error("Error in SDL: %s", SDL_GetError());
+        SDL_DestroyRenderer(halDisplay.renderer);
+        SDL_DestroyWindow(halDisplay.window);
+        SDL_Quit();
+        return kReturnERendererInitError;
+    }
 #elif (USE_OPENGL_GRAPHICS == 1)
     int glut_argc = 0;
     char **glut_argv = NULL;
@@ -408,6 +429,11 @@ HAL_DisplayTerminate(void)
     }
 #if (USE_SDL_GRAPHICS == 1)
     halDisplay.keyboardEventCallback = NULL;
+    if (halDisplay.texture != NULL)
+    {
+        SDL_DestroyTexture(halDisplay.texture);
+        halDisplay.texture = NULL;
+    }
     if (halDisplay.renderer != NULL)
     {
 	    SDL_DestroyRenderer(halDisplay.renderer);
@@ -502,18 +528,6 @@ HAL_DisplayGetState(void)
     return halDisplay.state;
 }
 
-void
-HAL_DisplayReserve(void)
-{
-    HAL_PixelBufferReserve(halDisplay.pixelBuffer);
-}
-
-void
-HAL_DisplayRelease(void)
-{
-    HAL_PixelBufferRelease(halDisplay.pixelBuffer);
-}
-
 uint32_t
 HAL_DisplaySetPixel(uint8_t positionX, uint8_t positionY, uint8_t brightness)
 {
@@ -526,6 +540,18 @@ HAL_DisplayGetPixel(uint8_t positionX, uint8_t positionY, uint8_t *brightness)
     return HAL_PixelBufferGetPixel(halDisplay.pixelBuffer, positionX, positionY, brightness);
 }
 
+uint8_t *
+HAL_DisplayGetLine(uint8_t positionY)
+{
+    return HAL_PixelBufferGetLine(halDisplay.pixelBuffer, positionY);
+}
+
+void
+HAL_DisplayPublish(void)
+{
+    HAL_PixelBufferPublish(halDisplay.pixelBuffer);
+}
+
 uint16_t
 HAL_DisplayGetSizeX(void)
 {
@@ -544,12 +570,6 @@ HAL_DisplayGetPixelBufferState(void)
     return HAL_PixelBufferGetState(halDisplay.pixelBuffer);
 }
 
-void
-HAL_DisplaySetReady(bool ready)
-{
-    HAL_PixelBufferSetReady(halDisplay.pixelBuffer, ready);
-}
-
 typedef struct HAL_TimerPrivate
 {
 #if (LINUX == 1)
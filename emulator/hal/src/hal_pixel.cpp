@@ -0,0 +1,288 @@
+#include "hal.h"
+#include "hal_pixel.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define HAL_PIXEL_AVX2 __attribute__((target("avx2")))
+#endif
+
+/** @brief Brightness of the four shades a palette picks from, lightest first. */
+static const uint8_t kHalPixelShades[4] = {
+    HAL_LCD_PIXEL_COLOR_WHITE,
+    HAL_LCD_PIXEL_COLOR_LIGHT_GRAY,
+    HAL_LCD_PIXEL_COLOR_DARK_GRAY,
+    HAL_LCD_PIXEL_COLOR_BLACK
+};
+
+/** @brief Color index of the leftmost pixel of a row is the most significant bit, as bytes 0x80, 0x40 ... 0x01. */
+#define kHalPixelRowBits        (0x0102040810204080ll)
+#define kHalPixelFlippedRowBits (0x8040201008040201ll)
+#define kHalPixelOpaque         (0xFF000000u)
+
+typedef struct HAL_PixelKernels
+{
+    void (*decodeTile)(const uint8_t *tile, uint8_t *indices, uint8_t *flipped);
+    void (*applyPalette)(const uint8_t *indices, uint8_t palette, uint8_t *brightness, uint16_t count);
+    void (*toARGB8888)(const uint8_t *brightness, uint32_t *argb, uint16_t count);
+} HAL_PixelKernels;
+
+static void
+HAL_PixelDecodeTileScalar(const uint8_t *tile, uint8_t *indices, uint8_t *flipped)
+{
+    for (uint8_t row = 0; row < 8; row++)
+    {
+        const uint8_t lo = tile[row << 1];
+        const uint8_t hi = tile[(row << 1) + 1];
+        for (uint8_t x = 0; x < 8; x++)
+        {
+            uint8_t index = (emu::get_bit(hi, 7 - x) << 1) | emu::get_bit(lo, 7 - x);
+            indices[(row << 3) + x] = index;
+            flipped[(row << 3) + 7 - x] = index;
+        }
+    }
+}
+
+static void
+HAL_PixelApplyPaletteScalar(const uint8_t *indices, uint8_t palette, uint8_t *brightness, uint16_t count)
+{
+    const uint8_t lut[4] = {
+        kHalPixelShades[palette & 0x3],
+        kHalPixelShades[(palette >> 2) & 0x3],
+        kHalPixelShades[(palette >> 4) & 0x3],
+        kHalPixelShades[(palette >> 6) & 0x3]
+    };
+    for (uint16_t i = 0; i < count; i++)
+    {
+        brightness[i] = lut[indices[i] & 0x3];
+    }
+}
+
+static void
+HAL_PixelToARGB8888Scalar(const uint8_t *brightness, uint32_t *argb, uint16_t count)
+{
+    for (uint16_t i = 0; i < count; i++)
+    {
+        argb[i] = kHalPixelOpaque | (brightness[i] * 0x010101u);
+    }
+}
+
+#if defined(__x86_64__)
+static void
+HAL_PixelDecodeTileSSE2(const uint8_t *tile, uint8_t *indices, uint8_t *flipped)
+{
+    const __m128i bytes = _mm_loadu_si128((const __m128i *)tile);
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = _mm_packus_epi16(_mm_and_si128(bytes, _mm_set1_epi16(0x00FF)), zero);
+    const __m128i hi = _mm_packus_epi16(_mm_srli_epi16(bytes, 8), zero);
+    // Every bitplane byte repeated once per pixel, two rows per vector
+    const __m128i lo2 = _mm_unpacklo_epi8(lo, lo);
+    const __m128i hi2 = _mm_unpacklo_epi8(hi, hi);
+    const __m128i lo4[2] = { _mm_unpacklo_epi16(lo2, lo2), _mm_unpackhi_epi16(lo2, lo2) };
+    const __m128i hi4[2] = { _mm_unpacklo_epi16(hi2, hi2), _mm_unpackhi_epi16(hi2, hi2) };
+    const __m128i bits = _mm_set1_epi64x(kHalPixelRowBits);
+    const __m128i flippedBits = _mm_set1_epi64x(kHalPixelFlippedRowBits);
+    const __m128i one = _mm_set1_epi8(1);
+    const __m128i two = _mm_set1_epi8(2);
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        const __m128i l = (i & 1) ? _mm_unpackhi_epi32(lo4[i >> 1], lo4[i >> 1]) : _mm_unpacklo_epi32(lo4[i >> 1], lo4[i >> 1]);
+        const __m128i h = (i & 1) ? _mm_unpackhi_epi32(hi4[i >> 1], hi4[i >> 1]) : _mm_unpacklo_epi32(hi4[i >> 1], hi4[i >> 1]);
+        __m128i index = _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(l, bits), bits), one),
+                                     _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(h, bits), bits), two));
+        _mm_storeu_si128((__m128i *)(indices + (i << 4)), index);
+        index = _mm_or_si128(_mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(l, flippedBits), flippedBits), one),
+                             _mm_and_si128(_mm_cmpeq_epi8(_mm_and_si128(h, flippedBits), flippedBits), two));
+        _mm_storeu_si128((__m128i *)(flipped + (i << 4)), index);
+    }
+}
+
+static void
+HAL_PixelApplyPaletteSSE2(const uint8_t *indices, uint8_t palette, uint8_t *brightness, uint16_t count)
+{
+    // No byte shuffle before SSSE3, every index selects its shade with a compare
+    __m128i shades[4];
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        shades[i] = _mm_set1_epi8(kHalPixelShades[(palette >> (2 * i)) & 0x3]);
+    }
+    uint16_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i index = _mm_loadu_si128((const __m128i *)(indices + i));
+        __m128i pixels = _mm_and_si128(_mm_cmpeq_epi8(index, _mm_setzero_si128()), shades[0]);
+        pixels = _mm_or_si128(pixels, _mm_and_si128(_mm_cmpeq_epi8(index, _mm_set1_epi8(1)), shades[1]));
+        pixels = _mm_or_si128(pixels, _mm_and_si128(_mm_cmpeq_epi8(index, _mm_set1_epi8(2)), shades[2]));
+        pixels = _mm_or_si128(pixels, _mm_and_si128(_mm_cmpeq_epi8(index, _mm_set1_epi8(3)), shades[3]));
+        _mm_storeu_si128((__m128i *)(brightness + i), pixels);
+    }
+    HAL_PixelApplyPaletteScalar(indices + i, palette, brightness + i, count - i);
+}
+
+static void
+HAL_PixelToARGB8888SSE2(const uint8_t *brightness, uint32_t *argb, uint16_t count)
+{
+    const __m128i opaque = _mm_set1_epi32(kHalPixelOpaque);
+    uint16_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i gray = _mm_loadu_si128((const __m128i *)(brightness + i));
+        const __m128i gray2[2] = { _mm_unpacklo_epi8(gray, gray), _mm_unpackhi_epi8(gray, gray) };
+        for (uint8_t j = 0; j < 2; j++)
+        {
+            _mm_storeu_si128((__m128i *)(argb + i + 8 * j), _mm_or_si128(_mm_unpacklo_epi16(gray2[j], gray2[j]), opaque));
+            _mm_storeu_si128((__m128i *)(argb + i + 8 * j + 4), _mm_or_si128(_mm_unpackhi_epi16(gray2[j], gray2[j]), opaque));
+        }
+    }
+    HAL_PixelToARGB8888Scalar(brightness + i, argb + i, count - i);
+}
+
+HAL_PIXEL_AVX2 static void
+HAL_PixelDecodeTileAVX2(const uint8_t *tile, uint8_t *indices, uint8_t *flipped)
+{
+    const __m256i bytes = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)tile));
+    // Offset of the low bitplane of rows 0-3 repeated once per pixel, the high bitplane is the next byte
+    const __m256i rows = _mm256_setr_epi64x(0x0000000000000000ll, 0x0202020202020202ll,
+                                            0x0404040404040404ll, 0x0606060606060606ll);
+    const __m256i bits = _mm256_set1_epi64x(kHalPixelRowBits);
+    const __m256i flippedBits = _mm256_set1_epi64x(kHalPixelFlippedRowBits);
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i two = _mm256_set1_epi8(2);
+    for (uint8_t i = 0; i < 2; i++)
+    {
+        const __m256i loRows = _mm256_add_epi8(rows, _mm256_set1_epi8(8 * i));
+        const __m256i l = _mm256_shuffle_epi8(bytes, loRows);
+        const __m256i h = _mm256_shuffle_epi8(bytes, _mm256_add_epi8(loRows, one));
+        __m256i index = _mm256_or_si256(_mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(l, bits), bits), one),
+                                        _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(h, bits), bits), two));
+        _mm256_storeu_si256((__m256i *)(indices + (i << 5)), index);
+        index = _mm256_or_si256(_mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(l, flippedBits), flippedBits), one),
+                                _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_and_si256(h, flippedBits), flippedBits), two));
+        _mm256_storeu_si256((__m256i *)(flipped + (i << 5)), index);
+    }
+}
+
+HAL_PIXEL_AVX2 static void
+HAL_PixelApplyPaletteAVX2(const uint8_t *indices, uint8_t palette, uint8_t *brightness, uint16_t count)
+{
+    // The four shades repeated through every lane, indices 0-3 pick them with one shuffle
+    const uint32_t shades = kHalPixelShades[palette & 0x3] |
+                            (kHalPixelShades[(palette >> 2) & 0x3] << 8) |
+                            (kHalPixelShades[(palette >> 4) & 0x3] << 16) |
+                            ((uint32_t)kHalPixelShades[(palette >> 6) & 0x3] << 24);
+    const __m256i lut = _mm256_set1_epi32((int)shades);
+    uint16_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        const __m256i index = _mm256_loadu_si256((const __m256i *)(indices + i));
+        _mm256_storeu_si256((__m256i *)(brightness + i), _mm256_shuffle_epi8(lut, index));
+    }
+    HAL_PixelApplyPaletteScalar(indices + i, palette, brightness + i, count - i);
+}
+
+HAL_PIXEL_AVX2 static void
+HAL_PixelToARGB8888AVX2(const uint8_t *brightness, uint32_t *argb, uint16_t count)
+{
+    const __m256i opaque = _mm256_set1_epi32(kHalPixelOpaque);
+    // Each brightness byte copied to the blue, green and red bytes of its pixel, pixels 0-7 of the 16 loaded
+    // -128 zeroes the alpha byte and still does after adding 8 for pixels 8-15
+    const __m256i expand = _mm256_setr_epi8(0, 0, 0, -128, 1, 1, 1, -128, 2, 2, 2, -128, 3, 3, 3, -128,
+                                            4, 4, 4, -128, 5, 5, 5, -128, 6, 6, 6, -128, 7, 7, 7, -128);
+    const __m256i expandHigh = _mm256_add_epi8(expand, _mm256_set1_epi8(8));
+    uint16_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m256i gray = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)(brightness + i)));
+        _mm256_storeu_si256((__m256i *)(argb + i), _mm256_or_si256(_mm256_shuffle_epi8(gray, expand), opaque));
+        _mm256_storeu_si256((__m256i *)(argb + i + 8), _mm256_or_si256(_mm256_shuffle_epi8(gray, expandHigh), opaque));
+    }
+    HAL_PixelToARGB8888Scalar(brightness + i, argb + i, count - i);
+}
+#endif
+
+static const HAL_PixelKernels halPixelKernels[HAL_PIXEL_ISA_COUNT] = {
+    { HAL_PixelDecodeTileScalar, HAL_PixelApplyPaletteScalar, HAL_PixelToARGB8888Scalar },
+#if defined(__x86_64__)
+    { HAL_PixelDecodeTileSSE2, HAL_PixelApplyPaletteSSE2, HAL_PixelToARGB8888SSE2 },
+    { HAL_PixelDecodeTileAVX2, HAL_PixelApplyPaletteAVX2, HAL_PixelToARGB8888AVX2 },
+#else
+    { HAL_PixelDecodeTileScalar, HAL_PixelApplyPaletteScalar, HAL_PixelToARGB8888Scalar },
+    { HAL_PixelDecodeTileScalar, HAL_PixelApplyPaletteScalar, HAL_PixelToARGB8888Scalar },
+#endif
+};
+
+static HAL_PixelISA
+HAL_PixelGetBestISA(void)
+{
+    for (int isa = HAL_PIXEL_ISA_COUNT - 1; isa > HAL_PIXEL_ISA_SCALAR; isa--)
+    {
+        if (HAL_PixelIsISASupported((HAL_PixelISA)isa))
+        {
+            return (HAL_PixelISA)isa;
+        }
+    }
+    return HAL_PIXEL_ISA_SCALAR;
+}
+
+/// Picked before main, so the emulation and display threads never race to set it.
+static HAL_PixelISA halPixelISA = HAL_PixelGetBestISA();
+static const HAL_PixelKernels *halPixel = &halPixelKernels[halPixelISA];
+
+bool
+HAL_PixelIsISASupported(HAL_PixelISA isa)
+{
+    switch (isa)
+    {
+    case HAL_PIXEL_ISA_SCALAR:
+        return true;
+#if defined(__x86_64__)
+    case HAL_PIXEL_ISA_SSE2:
+        return true;
+    case HAL_PIXEL_ISA_AVX2:
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+uint32_t
+HAL_PixelSetISA(HAL_PixelISA isa)
+{
+    require_or(HAL_PixelIsISASupported(isa), return kReturnEBadArgument);
+    halPixelISA = isa;
+    halPixel = &halPixelKernels[isa];
+    return kReturnOK;
+}
+
+HAL_PixelISA
+HAL_PixelGetISA(void)
+{
+    return halPixelISA;
+}
+
+const char *
+HAL_PixelGetISAName(HAL_PixelISA isa)
+{
+    static const char *names[HAL_PIXEL_ISA_COUNT] = { "scalar", "sse2", "avx2" };
+    require_or(isa < HAL_PIXEL_ISA_COUNT, return "unknown");
+    return names[isa];
+}
+
+void
+HAL_PixelDecodeTile(const uint8_t *tile, uint8_t *indices, uint8_t *flipped)
+{
+    halPixel->decodeTile(tile, indices, flipped);
+}
+
+void
+HAL_PixelApplyPalette(const uint8_t *indices, uint8_t palette, uint8_t *brightness, uint16_t count)
+{
+    halPixel->applyPalette(indices, palette, brightness, count);
+}
+
+void
+HAL_PixelToARGB8888(const uint8_t *brightness, uint32_t *argb, uint16_t count)
+{
+    halPixel->toARGB8888(brightness, argb, count);
+}
@@ -22,7 +22,7 @@ private:
 
 public:
     Control(std::shared_ptr<GameboyMemory> memory);
-    ~Control() { }
+    ~Control() { _memory->deregisterIOHook(_ioHook); }
     
     void configureInterrupt(uint8_t interruptFlag) { _interruptFlag = interruptFlag; }
     void setInterruptCallback(interruptCallback cb) { _interruptOccured = cb; }
@@ -38,6 +38,7 @@ private:
     controlActionInputs            _actionInputs;
     interruptCallback              _interruptOccured;
     std::optional<uint8_t>         _interruptFlag = std::nullopt;
+    GameboyMemory::IOHookHandle    _ioHook = GameboyMemory::kInvalidIOHook;
 };
 } // namespace emu::gameboy
 
@@ -81,7 +81,8 @@ Control::Control(std::shared_ptr<GameboyMemory> memory): _memory(memory)
     _register = &(memory->getIORegisters()->ctrl);
     *_register = UINT8_MAX;
 
-    memory->registerIOSignaler([this](__unused uint16_t, __unused std::optional<uint8_t>) {
+    /// Selecting the buttons or the d-pad brings the register up to date, reading it has no side effects.
+    _ioHook = memory->registerIOWriteHook(kControlRegister, [this](__unused uint16_t, __unused uint8_t) {
         //assert(joypadInputRegister->actionSelect || joypadInputRegister->directionSelect);
         controlBase regState = { .base = *_register };
         if (regState.actionSelect == 0)
@@ -92,5 +93,5 @@ Control::Control(std::shared_ptr<GameboyMemory> memory): _memory(memory)
         {
             *_register |= _directionInputs.base & 0xF;
         }
-    }, kControlRegister, UINT16_MAX);
+    });
 }
@@ -0,0 +1,88 @@
+#ifndef _HEATMAP_H_
+#define _HEATMAP_H_
+
+#include "platform.h"
+
+#include <array>
+#include <type_traits>
+
+/// @brief Bytes per heatmap counter: 0 compiles the counters out, 1 counts every address, 16 every 16 byte line.
+#ifndef MEMORY_HEATMAP
+#define MEMORY_HEATMAP 0
+#endif
+
+namespace emu::gameboy::detail::GameboyMemory {
+/// @brief Access counting policy of the default build, every call compiles to nothing.
+struct noAccessCounting
+{
+    static constexpr bool kEnabled = false;
+
+    template <typename T>
+    void countRead(uint16_t) const {}
+    template <typename T>
+    void countWrite(uint16_t) const {}
+    void countRead(uint16_t, uint32_t) const {}
+    void countWrite(uint16_t, uint32_t) const {}
+    bool exportToFile(FILE *, uint64_t) const { return false; }
+    void printSummary(FILE *) const {}
+};
+
+/**
+ * @brief Access counting policy that counts the CPU's reads and writes per `kLineSize` bytes of the memory map.
+ *
+ * A multi-byte access counts once for every byte. Instructions are fetched once, when they are decoded, so code
+ * shows up as read once per decode. DMA and the PPU aren't counted, and neither are the iterations of idle loops
+ * that are skipped instead of run.
+ *
+ * `exportToFile` appends one record per call, little endian:
+ *
+ *     char     magic[8]     "GBHEAT"
+ *     uint32_t lineSize
+ *     uint32_t lineCount
+ *     uint64_t frame        frames completed when exported
+ *     uint64_t reads[lineCount]
+ *     uint64_t writes[lineCount]
+ */
+template <uint32_t kLineSize>
+class AccessHeatmap
+{
+    static_assert(kLineSize > 0 && (kLineSize & (kLineSize - 1)) == 0, "Lines must be a power of two bytes");
+
+public:
+    static constexpr bool     kEnabled = true;
+    static constexpr char     kMagic[8] = "GBHEAT";
+    static constexpr uint32_t kLineCount = (1U << 16) / kLineSize;
+
+    template <typename T>
+    void countRead(uint16_t address) const { countRead(address, sizeof(T)); }
+    template <typename T>
+    void countWrite(uint16_t address) const { countWrite(address, sizeof(T)); }
+    void countRead(uint16_t address, uint32_t nbytes) const { count(_reads, address, nbytes); }
+    void countWrite(uint16_t address, uint32_t nbytes) const { count(_writes, address, nbytes); }
+    /// @returns false if the record couldn't be written.
+    bool exportToFile(FILE *file, uint64_t frame) const;
+    /// @brief Totals per region of the memory map and the lines accessed most.
+    void printSummary(FILE *file) const;
+
+private:
+    using counters = std::array<uint64_t, kLineCount>;
+    static void count(counters &lines, uint16_t address, uint32_t nbytes)
+    {
+        for (uint32_t i = 0; i < nbytes; i++)
+        {
+            lines[static_cast<uint16_t>(address + i) / kLineSize]++;
+        }
+    }
+
+private:
+    mutable counters _reads = {};
+    mutable counters _writes = {};
+};
+
+static_assert(MEMORY_HEATMAP == 0 || MEMORY_HEATMAP == 1 || MEMORY_HEATMAP == 16, "MEMORY_HEATMAP is 0, 1 or 16");
+/// @brief The policy `GameboyMemory` is built with, picked by `MEMORY_HEATMAP`.
+using AccessCounter = std::conditional_t<MEMORY_HEATMAP == 0, noAccessCounting,
+                                         AccessHeatmap<(MEMORY_HEATMAP > 0) ? MEMORY_HEATMAP : 1>>;
+} // namespace emu::gameboy::detail::GameboyMemory
+
+#endif /* _HEATMAP_H_ */
@@ -0,0 +1,108 @@
+#ifndef _MBC_H_
+#define _MBC_H_
+
+#include "platform.h"
+
+#include <array>
+
+namespace emu::gameboy::detail::GameboyMemory {
+/**
+ * @brief Cartridge memory bank controller (MBC1, MBC3 and MBC5).
+ *
+ * Only decodes writes to its registers (0x0000-0x7FFF) into the banks that should be mapped, the memory maps them by
+ * pointing its pages into the ROM image or external RAM. Nothing is copied on a bank switch and accesses don't pass
+ * through the controller.
+ *
+ * The MBC3 clock counts emulated time, one second every `kMCyclesPerSecond` M-cycles of the caller's clock, and isn't
+ * kept in save files.
+ */
+class MemoryBankController
+{
+public:
+    enum class type : uint8_t
+    {
+        /// @brief ROM only, optionally with unbanked RAM.
+        none,
+        mbc1,
+        mbc3,
+        mbc5,
+    };
+    /// @brief Banks mapped into the cartridge's address ranges.
+    struct mapping
+    {
+        /// @brief ROM bank at 0x0000-0x3FFF, only MBC1 in advanced banking mode maps anything other than 0 there.
+        uint16_t romBank00 = 0;
+        /// @brief ROM bank at 0x4000-0x7FFF.
+        uint16_t romBank01 = 1;
+        /// @brief External RAM bank at 0xA000-0xBFFF.
+        uint8_t  ramBank = 0;
+        bool     ramEnabled = false;
+        /// @brief MBC3 clock register (0x08-0x0C) mapped at 0xA000-0xBFFF instead of RAM, 0 if none is.
+        uint8_t  clockRegister = 0;
+
+        bool operator==(const mapping &) const = default;
+    };
+
+    static constexpr uint32_t kROMBankSize = 16U << 10;
+    static constexpr uint32_t kRAMBankSize = 8U << 10;
+    static constexpr uint64_t kMCyclesPerSecond = 1U << 20;
+
+public:
+    /**
+     * @brief Set up the controller from the cartridge header.
+     *
+     * @param[in] cartridgeType Header byte 0x0147.
+     * @param[in] romBanks Number of 16 KB banks in the ROM image.
+     * @param[in] ramSize Header byte 0x0149.
+     * @returns false if the cartridge type isn't supported, the controller then behaves like a ROM only cartridge.
+     */
+    bool configure(uint8_t cartridgeType, uint16_t romBanks, uint8_t ramSize);
+    /**
+     * @brief Decode a write to the controller's registers.
+     *
+     * @param[in] mCycles M-cycles since power on, the clock runs up to it.
+     * @returns true if the mapping changed.
+     */
+    bool write(uint16_t address, uint8_t value, uint64_t mCycles);
+    /// @brief Read external RAM while it isn't mapped, i.e. disabled or a latched clock register is selected.
+    uint8_t readUnmapped() const;
+    /// @brief Write external RAM while it isn't mapped, see `readUnmapped` and `write`.
+    void writeUnmapped(uint8_t value, uint64_t mCycles);
+
+    type getType() const { return _type; }
+    const mapping &getMapping() const { return _mapping; }
+    /// @brief Bytes of external RAM on the cartridge, a multiple of `kRAMBankSize`.
+    uint32_t getRAMSize() const { return _ramBanks * kRAMBankSize; }
+    bool hasBattery() const { return _battery; }
+
+private:
+    void writeMBC1(uint16_t address, uint8_t value);
+    void writeMBC3(uint16_t address, uint8_t value, uint64_t mCycles);
+    /// @brief Count the whole seconds elapsed up to `mCycles` into the clock registers, unless the clock is halted.
+    void tickClock(uint64_t mCycles);
+    void writeMBC5(uint16_t address, uint8_t value);
+    /// @brief Bank numbers wrap around the number of banks present, like the unconnected address lines do.
+    uint16_t romBank(uint32_t bank) const { return static_cast<uint16_t>(bank % _romBanks); }
+    uint8_t ramBank(uint32_t bank) const { return _ramBanks ? static_cast<uint8_t>(bank % _ramBanks) : 0; }
+
+private:
+    type     _type = type::none;
+    mapping  _mapping;
+    uint16_t _romBanks = 2;
+    uint8_t  _ramBanks = 0;
+    bool     _battery = false;
+    bool     _clock = false;
+    /// @brief Bank registers as written, MBC1 derives both ROM banks and the RAM bank from them.
+    uint16_t _romBankRegister = 1;
+    uint8_t  _upperBankRegister = 0;
+    bool     _advancedBanking = false;
+    /// @brief MBC3 clock registers (seconds, minutes, hours, day low, day high/flags), running and as last latched.
+    std::array<uint8_t, 5> _clockRegisters = {};
+    std::array<uint8_t, 5> _latchedClockRegisters = {};
+    /// @brief M-cycle the clock registers were counted up to, the rest is the current fraction of a second.
+    uint64_t _clockUpdated = 0;
+    uint8_t  _clockLatch = 0xFF;
+};
+} // namespace emu::gameboy::detail::GameboyMemory
+
+#endif /* _MBC_H_ */
@@ -1,9 +1,17 @@
 #ifndef _MMU_H_
 #define _MMU_H_
 
+#include "heatmap.h"
+#include "mbc.h"
 #include "platform.h"
+#include "rom.h"
+#include "save.h"
+#include "view.h"
 
-#include <list>
+#include <array>
+#include <bitset>
+#include <functional>
+#include <vector>
 
 #define kMemoryMapSize (0x10000)
 #define kMemoryMap4KB  (4U << 10)
@@ -111,16 +119,24 @@ struct interruptEnable
 };
 static_assert(sizeof(interruptEnable) == 0x1);
 
+/**
+ * @brief OAM DMA transfer state.
+ *
+ * The transfer is copied in one go when it completes. Until then the CPU can only reach high RAM and the IO
+ * registers, so nothing can observe the copy happening late.
+ */
 struct DirectMemoryAccess
 {
     static constexpr uint8_t  kDurationMCycles = 160;
     static constexpr uint16_t kDestinationAddress = 0xFE00;
-    static constexpr uint8_t  kBufferLength = 0x9F;
+    static constexpr uint8_t  kLength = 0xA0;
     static constexpr uint16_t kStartAddress = 0xFF46;
 
     uint16_t sourceAddress = 0;
-    uint8_t  count = 0;
+    /// @brief M-cycles until the copy.
+    uint32_t remaining = 0;
     bool     inProgress = false;
+    bool     busLocked = false;
 };
 } // namespace detail::GameboyMemory
 
@@ -310,41 +326,96 @@ public:
     using interruptEnable = detail::GameboyMemory::interruptEnable;
     
     using DirectMemoryAccess = detail::GameboyMemory::DirectMemoryAccess;
+    using MemoryBankController = detail::GameboyMemory::MemoryBankController;
+    using ROMImage = detail::GameboyMemory::ROMImage;
+    using SaveFile = detail::GameboyMemory::SaveFile;
+    using LiveView = detail::GameboyMemory::LiveView;
+    using AccessCounter = detail::GameboyMemory::AccessCounter;
 
-private:
-    static constexpr const char *kDMGROMFilename = "/Users/croninj/Personal/gameboy-emulator-cpp/bin/DMG_ROM.bin";
-    
-private:
-    struct IOSignaler
-    {
-        using CallbackFn = std::function<void(uint16_t, std::optional<uint8_t>)>;
-        CallbackFn  callback = nullptr;
-        uint16_t    compare;
-        uint16_t    mask;
-        uint8_t    id; 
-    };
+public:
+    using CodeWriteCallbackFn = std::function<void(uint8_t)>;
+    using AccessCallbackFn = std::function<void(bool)>;
+    using BankSwitchCallbackFn = std::function<void()>;
+    using VideoRAMWriteCallbackFn = std::function<void(uint16_t)>;
+    using CycleCountFn = std::function<uint64_t()>;
+    /// @brief Called after a value is written to an IO register.
+    using IOWriteHookFn = std::function<void(uint16_t, uint8_t)>;
+    /// @brief Called before an IO register is read, e.g. to refresh its value.
+    using IOReadHookFn = std::function<void(uint16_t)>;
+    /// @brief Identifies a registered hook, `kInvalidIOHook` is never returned for a successful registration.
+    using IOHookHandle = uint32_t;
+
+    /// @brief One bit per 256 byte page of the address space.
+    using PageBitmap = std::bitset<(kMemoryMapSize >> 8)>;
+
+    static constexpr IOHookHandle kInvalidIOHook = 0;
+    static constexpr uint16_t     kVideoRAMAddress = 0x8000;
+    static constexpr uint16_t     kExternalRAMAddress = 0xA000;
+    static constexpr uint16_t     kIORegistersAddress = 0xFF00;
     
 public:
     GameboyMemory() = default;
     ~GameboyMemory();
     
-    bool activate(const char *gamefile);
+    /**
+     * @brief Load the game and map it.
+     *
+     * @param[in] bootROMFile Overlaid on 0x0000-0x00FF until 0xFF50 is written, nullptr to start without a boot ROM
+     *                        (see `loadPostBootState`).
+     */
+    bool activate(const char *gamefile, const char *bootROMFile = kConfigStartupCodeFile);
+    /**
+     * @brief Set the IO registers the boot ROM would have, for starting at 0x0100 without it.
+     *
+     * The registers are written like the CPU would write them, so call this once every component has hooked its
+     * registers. Video RAM is left cleared, the logo isn't drawn.
+     */
+    void loadPostBootState();
+    /**
+     * @brief Keep battery-backed cartridge RAM in `filename`, which is created if it doesn't exist.
+     *
+     * @returns false if the cartridge has no battery-backed RAM or the file can't be mapped.
+     */
+    bool loadSaveFile(const char *filename);
+    /// @brief Hand the save file's modified pages to its writer thread, called once per frame.
+    void flushSaveFile();
+    /**
+     * @brief Run on a memory map placed in the POSIX shared memory segment `name`, for external tools to read live.
+     *
+     * Must be called before `activate`. See `LiveView` for the segment's layout.
+     *
+     * @returns false if already activated or the segment can't be created.
+     */
+    bool shareMemory(const char *name);
+    /// @brief CPU accesses counted so far, nothing unless built with `MEMORY_HEATMAP` (see `AccessHeatmap`).
+    AccessCounter &getAccessCounter() { return _accessCounter; }
+    /// @brief Stamp the shared memory map with a completed frame, called once per frame.
+    void publishFrame(uint64_t cycles)
+    {
+        if (_view)
+        {
+            _view->publishFrame(cycles);
+        }
+    }
     
     /**
      * @brief Read a segment of memory from the game data buffer. 
      * 
+     * Pages backed by plain memory are a single indexed load, the rest go through the page's handler.
+     * 
      * @param[in] address The base address to read from (big endian?).
      * @returns The data located at the address given.
      */
     template <typename T = uint8_t, typename = std::enable_if_t<std::is_integral<T>::value>> 
     T read(uint16_t address) const
     {
-        const uint8_t *byte_ptr = &_memory->raw[address];
-        if (in_range(address, 0xFF00, 0xFF80))
+        _accessCounter.countRead<T>(address);
+        const uint8_t *page = _readPages[address >> 8];
+        if (expect_true(page != nullptr && isWithinPage<T>(address)))
         {
-            signal(address);
+            return *reinterpret_cast<const T *>(&page[address & 0xFF]);
         }
-        return *reinterpret_cast<const T *>(byte_ptr);
+        return readSlow<T>(address);
     }
     /**
      * @brief Read a buffer from memory.
@@ -358,26 +429,100 @@ public:
     template <typename T = uint8_t, typename = std::enable_if_t<std::is_integral<T>::value>> 
     void write(uint16_t address, T value)
     {
-        *reinterpret_cast<T *>(&_memory->raw[address]) = value; 
-        if (in_range(address, 0xFF00, 0xFF80))
+        _accessCounter.countWrite<T>(address);
+        uint8_t *page = _writePages[address >> 8];
+        if (expect_true(page != nullptr && isWithinPage<T>(address)))
         {
-            signal(address, static_cast<uint8_t>(value));
+            *reinterpret_cast<T *>(&page[address & 0xFF]) = value;
+            return;
         }
+        writeSlow<T>(address, value);
     }
     void write(uint16_t address, const uint8_t * const buffer, uint16_t nbytes);
     
-    void mCycleUpdate(uint8_t cycles);
+    void mCycleUpdate(uint32_t cycles);
+    /// @brief M-cycles until the DMA transfer needs to run again.
+    uint64_t getCyclesUntilEvent() const;
     void dumpToFile();
     
-    /// @todo How to clear this? 
-    uint8_t registerIOSignaler(IOSignaler::CallbackFn callback, uint16_t compare, uint16_t mask);
-    void deregisterIOSignaler(uint8_t id);
+    /**
+     * @brief Hook writes to `count` consecutive IO registers starting at `address`.
+     *
+     * Each register has at most one write and one read hook, registers without one cost nothing extra.
+     *
+     * @returns A handle for `deregisterIOHook`, `kInvalidIOHook` if a register is out of range or already hooked.
+     */
+    IOHookHandle registerIOWriteHook(uint16_t address, IOWriteHookFn hook, uint8_t count = 1);
+    /// @brief Hook reads of IO registers, see `registerIOWriteHook`. Only needed if reading has side effects.
+    IOHookHandle registerIOReadHook(uint16_t address, IOReadHookFn hook, uint8_t count = 1);
+    /// @brief Remove every hook registered under `handle`.
+    void deregisterIOHook(IOHookHandle handle);
     void requestInterrupt(uint8_t interruptFlag);
+
+    /**
+     * @brief Watch a 256 byte page for writes, used to invalidate decoded instructions.
+     * 
+     * The callback is invoked once with the page number on the first write that lands in the page,
+     * after which the page is no longer watched until `watchCodePage` is called again.
+     */
+    void watchCodePage(uint8_t page)
+    {
+        _codePages[page] = true;
+        updateWritePointer(page);
+        updateWritePointer(getAliasPage(page));
+    }
+    void setCodeWriteCallback(CodeWriteCallbackFn callback) { _codeWriteCallback = std::move(callback); }
+    /**
+     * @brief Called before the CPU reads IO registers, or writes video RAM, OAM or IO registers.
+     *        The argument is true for writes.
+     *
+     * Lets components that run behind the CPU catch up before their state is observed or changed.
+     */
+    void setAccessCallback(AccessCallbackFn callback) { _accessCallback = std::move(callback); }
+    /// @brief Returns M-cycles since power on, the cartridge's clock runs on it.
+    void setCycleCountCallback(CycleCountFn callback) { _cycleCountCallback = std::move(callback); }
+    /**
+     * @brief Called after a write to the memory bank controller maps different banks, and when OAM DMA locks or
+     *        unlocks the bus.
+     *
+     * Decoded instructions are tagged with their bank (see `getBankNumber`) so they stay valid, but the block being
+     * run may have been switched out from under the CPU.
+     */
+    void setBankSwitchCallback(BankSwitchCallbackFn callback) { _bankSwitchCallback = std::move(callback); }
+    /// @brief Called with the address of every write to video RAM just before it lands, e.g. to keep decoded tiles
+    ///        current.
+    void setVideoRAMWriteCallback(VideoRAMWriteCallbackFn callback) { _videoRAMWriteCallback = std::move(callback); }
+    /**
+     * @brief Track which pages of video RAM, external RAM, work RAM, OAM and high RAM are written.
+     *
+     * A tracked page is written through the handler once after each checkpoint, which marks it dirty and gives it
+     * back its direct write pointer. Nothing is tracked, and nothing costs anything, until this is enabled.
+     * Enabling it starts from a checkpoint.
+     */
+    void setDirtyTracking(bool enable);
+    /**
+     * @brief Pages written since the last checkpoint.
+     *
+     * Writes through echo RAM mark the work RAM page. Switching the external RAM bank marks all of 0xA000-0xBFFF, the
+     * contents seen there changed. The high RAM page (0xFF) includes the IO registers, but not the values the
+     * components update themselves (e.g. LY).
+     */
+    const PageBitmap &getDirtyPages() const { return _dirtyPages; }
+    /// @brief Checkpoint, forget what was written so far.
+    void clearDirtyPages();
+    /// @brief True while OAM DMA runs and reads of the page return 0xFF, only high RAM and IO stay reachable.
+    bool isBusLocked(uint8_t page) const { return expect_false(_dma.busLocked) && (page < 0xFF); }
+    /// @brief ROM bank mapped at `address`, 0 above 0x7FFF.
+    uint16_t getBankNumber(uint16_t address) const { return _mappedBanks[address >> 14]; }
+    const MemoryBankController &getMemoryBankController() const { return _controller; }
     
-    auto getROMBank00() { return &_memory->layout.romBank00; }
-    auto getROMBank01() { return &_memory->layout.romBank01; }
+    auto getROMBank00() const { return reinterpret_cast<const romBank00 *>(_rom->data()); }
+    auto getROMBank01() const { return reinterpret_cast<const romBank01 *>(_pages[sizeof(romBank00) >> 8].memory); }
+    /// @brief The cartridge ROM, shared with other instances running the same game.
+    const std::shared_ptr<const ROMImage> &getROMImage() const { return _rom; }
     auto getVideoRAM() { return &_memory->layout.videoRam; }
-    auto getExternalRAM() { return &_memory->layout.externalRam; }
+    /// @brief The mapped external RAM bank, nullptr while it is disabled or the cartridge has none.
+    auto getExternalRAM() { return reinterpret_cast<externalRAM *>(_pages[0xA0].memory); }
     auto getWorkRAM00() { return &_memory->layout.workRam00; }
     auto getWorkRAM01() { return &_memory->layout.workRam01; }
     auto getWorkRamMirror() { return &_memory->layout.workRamMirror; }
@@ -391,8 +536,122 @@ public:
     static void print(uint8_t *buffer, uint16_t offset, uint16_t length);
     
 private:
-    void signal(uint16_t address, std::optional<uint8_t> writeValue = std::nullopt) const;
-    bool loadFile(const char *filename, size_t size);
+    /// @brief How accesses that can't use a page's pointers are handled.
+    enum class accessHandler : uint8_t
+    {
+        /// @brief Plain memory, only reached for writes to pages holding decoded code.
+        none,
+        /// @brief Cartridge ROM, writes go to the memory bank controller.
+        rom,
+        /// @brief External RAM while it isn't mapped, the memory bank controller handles accesses.
+        cartridgeRAM,
+        /// @brief Video RAM and OAM, the PPU and DMA catch up before writes.
+        synchronized,
+        /// @brief IO registers (0xFF00-0xFF7F), high RAM and the interrupt enable register share the page.
+        io,
+    };
+    /**
+     * @brief One 256 byte page of the address space.
+     *
+     * Accesses go straight to the page's entry in `_readPages`/`_writePages` when it is set, bank switches and
+     * overlays only swap those pointers.
+     */
+    struct page
+    {
+        /// @brief Memory backing the page, the write pointer is restored to it once a watched code page is written.
+        uint8_t *       memory = nullptr;
+        accessHandler   handler = accessHandler::none;
+    };
+    static constexpr uint32_t kPageCount = kMemoryMapSize >> 8;
+    static constexpr uint16_t kHighRAMAddress = 0xFF80;
+
+private:
+    template <typename T>
+    static constexpr bool isWithinPage(uint16_t address)
+    {
+        return (sizeof(T) == sizeof(uint8_t)) || ((address & 0xFF) <= (0x100 - sizeof(T)));
+    }
+    /**
+     * @brief Access through the handler, one byte at a time (little endian).
+     *
+     * High RAM shares its page with the IO registers but is plain memory, so it is picked off first.
+     */
+    template <typename T>
+    T readSlow(uint16_t address) const
+    {
+        if (expect_true(address >= kHighRAMAddress && address <= (kMemoryMapSize - sizeof(T))))
+        {
+            return *reinterpret_cast<const T *>(&_memory->raw[address]);
+        }
+        T value = 0;
+        for (uint32_t i = 0; i < sizeof(T); i++)
+        {
+            value |= static_cast<T>(static_cast<T>(readHandler(static_cast<uint16_t>(address + i))) << (i * 8));
+        }
+        return value;
+    }
+    template <typename T>
+    void writeSlow(uint16_t address, T value)
+    {
+        if (expect_true(address >= kHighRAMAddress && address <= (kMemoryMapSize - sizeof(T)) && _highRAMWritable))
+        {
+            *reinterpret_cast<T *>(&_memory->raw[address]) = value;
+            return;
+        }
+        for (uint32_t i = 0; i < sizeof(T); i++)
+        {
+            writeHandler(static_cast<uint16_t>(address + i), static_cast<uint8_t>(value >> (i * 8)));
+        }
+    }
+    uint8_t readHandler(uint16_t address) const;
+    void writeHandler(uint16_t address, uint8_t value);
+    /// @brief Map the banks selected by the memory bank controller, only the ranges that changed are remapped.
+    void mapBanks();
+    /// @brief Map `count` pages starting at `first` onto `memory`, which is nullptr if the handler owns them.
+    void mapPages(uint8_t first, uint32_t count, uint8_t *memory, accessHandler handler);
+    /// @brief Point a page's read pointer at its memory (or the boot ROM), unless reads must go through the handler.
+    void updateReadPointer(uint8_t page);
+    /// @brief Point a page's write pointer at its memory, unless writes to it must be seen by the handler.
+    void updateWritePointer(uint8_t page);
+    void startDMA(uint8_t sourcePage);
+    void finishDMA();
+    /// @brief Send every access below the IO page through the handler, which blocks it while DMA runs.
+    void lockBus(bool locked);
+    /// @brief Echo RAM (0xE000-0xFDFF) pages and the work RAM pages they mirror alias each other.
+    static constexpr uint8_t getAliasPage(uint8_t page)
+    {
+        return in_range(page, 0xC0, 0xDE) ? (page + 0x20) : in_range(page, 0xE0, 0xFE) ? (page - 0x20) : page;
+    }
+    /// @brief Start of an external RAM bank, in the save file if there is one.
+    uint8_t *getExternalRAMBank(uint8_t bank)
+    {
+        return (_save ? _save->data() : _externalRAM.data()) + (bank * MemoryBankController::kRAMBankSize);
+    }
+    /// @brief Watch the mapped external RAM pages for the next write, which dirties the save file.
+    void watchSavePages();
+    void saveWritten(uint8_t page);
+    /// @brief True for the pages `setDirtyTracking` covers.
+    static constexpr bool isDirtyTracked(uint8_t page) { return in_range(page, 0x80, 0xE0) || page >= 0xFE; }
+    /// @brief Mark pages dirty, they are written directly until the next checkpoint.
+    void markDirty(uint8_t first, uint32_t count = 1);
+    /// @brief Read a byte without side effects, used by DMA. Unmapped external RAM reads as 0xFF.
+    uint8_t peek(uint16_t address) const;
+    bool canHookIORegisters(uint16_t address, uint8_t count, bool isWrite) const;
+    void accessed(bool isWrite) const
+    {
+        if (_accessCallback)
+        {
+            _accessCallback(isWrite);
+        }
+    }
+    uint64_t getCycleCount() const { return _cycleCountCallback ? _cycleCountCallback() : 0; }
+    /// @brief Start of a ROM bank, for mapping only. Writes never go through ROM pages, see `accessHandler::rom`.
+    uint8_t *getROMBankMemory(uint16_t bank) const
+    {
+        return const_cast<uint8_t *>(_rom->data() + (bank * ROMImage::kBankSize));
+    }
+    void disableBootROM();
+    void codeWritten(uint16_t address, uint32_t nbytes);
 
 private:
     union memory
@@ -415,11 +674,52 @@ private:
         static_assert(sizeof(memoryLayout) == kMemoryMapSize);
         uint8_t raw[kMemoryMapSize];
     };
+    /// @brief Everything but the cartridge ROM, which lives in `_rom`.
     memory *              _memory = nullptr;
+    std::shared_ptr<const ROMImage> _rom;
+    std::shared_ptr<const ROMImage> _bootROM;
+    /// @brief Every external RAM bank on the cartridge, unless it is kept in `_save`.
+    std::vector<uint8_t>  _externalRAM;
+    /// @brief Owns `_memory` if it is shared.
+    std::unique_ptr<LiveView> _view;
+    [[no_unique_address]] AccessCounter _accessCounter;
+    std::unique_ptr<SaveFile> _save;
+    MemoryBankController  _controller;
+    /// @brief ROM bank behind each 16 KB region, so `getBankNumber` is a single load.
+    std::array<uint16_t, 4> _mappedBanks = { 0, 1, 0, 0 };
+    /// @brief External RAM bank mapped at 0xA000-0xBFFF, -1 while it isn't.
+    int16_t               _mappedRAMBank = -1;
+    std::array<const uint8_t *, kPageCount> _readPages = {};
+    std::array<uint8_t *, kPageCount> _writePages = {};
+    std::array<page, kPageCount> _pages = {};
     DirectMemoryAccess    _dma;
-    std::list<IOSignaler> _ioSignalerList;
+    /// @brief Hooks for each IO register (0xFF00-0xFF7F).
+    struct ioHook
+    {
+        IOReadHookFn    read = nullptr;
+        IOWriteHookFn   write = nullptr;
+        IOHookHandle    readHandle = kInvalidIOHook;
+        IOHookHandle    writeHandle = kInvalidIOHook;
+    };
+    std::array<ioHook, sizeof(io::registers)> _ioHooks = {};
+    IOHookHandle          _nextIOHookHandle = kInvalidIOHook + 1;
     const char *          _gamefile = nullptr;
     bool                  _activated = false;
+    std::array<bool, kPageCount> _codePages = {};
+    /// @brief External RAM pages whose next write dirties the save file, they are written through the handler.
+    std::array<bool, kPageCount> _savePages = {};
+    bool                  _dirtyTracking = false;
+    /// @brief Tracked pages not written since the last checkpoint, also written through the handler.
+    std::array<bool, kPageCount> _cleanPages = {};
+    PageBitmap            _dirtyPages;
+    /// @brief High RAM writes don't need the handler (see `writeSlow`).
+    bool                  _highRAMWritable = true;
+    bool                  _bootROMMapped = false;
+    CodeWriteCallbackFn   _codeWriteCallback = nullptr;
+    AccessCallbackFn      _accessCallback = nullptr;
+    BankSwitchCallbackFn  _bankSwitchCallback = nullptr;
+    VideoRAMWriteCallbackFn _videoRAMWriteCallback = nullptr;
+    CycleCountFn          _cycleCountCallback = nullptr;
 };
 } // namespace emu::gameboy
 
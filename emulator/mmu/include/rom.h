@@ -0,0 +1,63 @@
+#ifndef _ROM_H_
+#define _ROM_H_
+
+#include "platform.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace emu::gameboy::detail::GameboyMemory {
+/**
+ * @brief Read-only image of a ROM file, shared by every emulator in the process that opens the same file.
+ *
+ * The file is mapped with `mmap(PROT_READ, MAP_SHARED)`, so opening it doesn't read anything and every instance uses
+ * the same physical pages (the page cache's). Files that can't be mapped (pipes, some file systems) are read into
+ * memory once instead. Either way the image is zero padded to whole banks.
+ */
+class ROMImage
+{
+public:
+    static constexpr size_t kBankSize = 16U << 10;
+    /// @brief Images are at least this long, i.e. both fixed banks of a cartridge without a memory bank controller.
+    static constexpr size_t kMinimumSize = 2 * kBankSize;
+
+public:
+    /**
+     * @brief Open `filename`, or share the image already open for it.
+     *
+     * Images are cached by canonical path, size and the header's checksums, a file that was replaced by a different ROM
+     * is opened again. The cache only holds images that are still in use.
+     *
+     * @returns nullptr if the file can't be read or is empty.
+     */
+    static std::shared_ptr<const ROMImage> open(const char *filename);
+
+    ROMImage(const ROMImage &) = delete;
+    ROMImage &operator=(const ROMImage &) = delete;
+    ~ROMImage();
+
+    const uint8_t *data() const { return _data; }
+    /// @brief Padded size, a multiple of `kBankSize`.
+    size_t size() const { return _size; }
+    /// @brief Size of the file.
+    size_t getFileSize() const { return _fileSize; }
+    /// @brief False if the file was read into a private copy.
+    bool isMapped() const { return _mapped; }
+
+private:
+    ROMImage() = default;
+    bool map(int fd, size_t fileSize);
+    bool read(int fd);
+
+private:
+    const uint8_t *      _data = nullptr;
+    size_t               _size = 0;
+    size_t               _fileSize = 0;
+    bool                 _mapped = false;
+    /// @brief Contents of a file that couldn't be mapped.
+    std::vector<uint8_t> _copy;
+};
+} // namespace emu::gameboy::detail::GameboyMemory
+
+#endif /* _ROM_H_ */
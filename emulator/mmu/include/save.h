@@ -0,0 +1,61 @@
+#ifndef _SAVE_H_
+#define _SAVE_H_
+
+#include "platform.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace emu::gameboy::detail::GameboyMemory {
+/**
+ * @brief Battery-backed cartridge RAM kept in a memory mapped `.sav` file.
+ *
+ * The RAM is the `MAP_SHARED` mapping itself, so every write the game makes is in the page cache right away and
+ * survives the emulator crashing. Writing it back to disk is left to a background thread: the emulator marks the
+ * pages it modified and hands them over with `flush`, which never waits for the disk.
+ */
+class SaveFile
+{
+public:
+    /**
+     * @brief Map `filename`, it is created or extended to `size` bytes of zeroes.
+     *
+     * @returns nullptr if the file can't be opened or mapped.
+     */
+    static std::unique_ptr<SaveFile> open(const char *filename, size_t size);
+
+    SaveFile(const SaveFile &) = delete;
+    SaveFile &operator=(const SaveFile &) = delete;
+    /// @brief Writes back whatever is still dirty before unmapping.
+    ~SaveFile();
+
+    uint8_t *data() const { return _data; }
+    size_t size() const { return _size; }
+    /// @brief Note that the host page holding `offset` was modified.
+    void markDirty(size_t offset) { _dirty[offset / _pageSize] = true; }
+    /// @brief Queue the pages modified since the last flush to be written back.
+    void flush();
+
+private:
+    SaveFile() = default;
+    void writeBack();
+
+private:
+    uint8_t *               _data = nullptr;
+    size_t                  _size = 0;
+    size_t                  _pageSize = 0;
+    /// @brief Modified host pages, only touched by the emulator.
+    std::vector<bool>       _dirty;
+    /// @brief Pages queued for the writer, guarded by `_lock`.
+    std::vector<bool>       _pending;
+    bool                    _stop = false;
+    std::mutex              _lock;
+    std::condition_variable _wake;
+    std::thread             _writer;
+};
+} // namespace emu::gameboy::detail::GameboyMemory
+
+#endif /* _SAVE_H_ */
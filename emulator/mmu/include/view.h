@@ -0,0 +1,74 @@
+#ifndef _VIEW_H_
+#define _VIEW_H_
+
+#include "platform.h"
+
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace emu::gameboy::detail::GameboyMemory {
+/**
+ * @brief Header at the start of the shared memory segment, read by external tools.
+ *
+ * `frame` and `cycles` are guarded by `sequence`, which is odd while they are being updated: a reader loads
+ * `sequence`, the stamps, then `sequence` again, and retries if the two loads differ or are odd.
+ */
+struct liveViewHeader
+{
+    static constexpr char     kMagic[8] = "GBVIEW";
+    static constexpr uint32_t kVersion = 1;
+
+    char                  magic[8];
+    uint32_t              version;
+    /// @brief Offset of the memory map from the start of the segment.
+    uint32_t              memoryOffset;
+    uint32_t              memorySize;
+    std::atomic<uint32_t> sequence;
+    /// @brief Frames completed, stamped when the frame enters VBlank.
+    std::atomic<uint64_t> frame;
+    /// @brief M-cycles run when `frame` was stamped.
+    std::atomic<uint64_t> cycles;
+};
+static_assert(std::atomic<uint64_t>::is_always_lock_free);
+static_assert(sizeof(liveViewHeader) == 40);
+
+/**
+ * @brief The guest memory map, placed in a named POSIX shared memory segment for external tools.
+ *
+ * The emulator runs on the segment itself, so readers see every write as it happens without anything being copied,
+ * and the emulator pays nothing but the per-frame stamp. Only what `GameboyMemory` keeps in its memory map is there:
+ * the ROM and external RAM ranges read as zeroes. The segment is at `/dev/shm/<name>` on Linux and is removed when
+ * the view is destroyed.
+ */
+class LiveView
+{
+public:
+    /**
+     * @brief Create the segment `name`, which holds the header and `memorySize` bytes of zeroes.
+     *
+     * @returns nullptr if the segment already exists or can't be created or mapped.
+     */
+    static std::unique_ptr<LiveView> create(const char *name, size_t memorySize);
+
+    LiveView(const LiveView &) = delete;
+    LiveView &operator=(const LiveView &) = delete;
+    ~LiveView();
+
+    /// @brief Start of the memory map, page aligned.
+    uint8_t *getMemory() const { return _data + _header->memoryOffset; }
+    /// @brief Count a completed frame and stamp it with the M-cycle count.
+    void publishFrame(uint64_t cycles);
+
+private:
+    LiveView() = default;
+
+private:
+    std::string      _name;
+    uint8_t *        _data = nullptr;
+    size_t           _size = 0;
+    liveViewHeader * _header = nullptr;
+};
+} // namespace emu::gameboy::detail::GameboyMemory
+
+#endif /* _VIEW_H_ */
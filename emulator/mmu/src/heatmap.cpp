@@ -0,0 +1,87 @@
+#include "heatmap.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+using namespace emu::gameboy::detail::GameboyMemory;
+
+namespace {
+struct region
+{
+    const char *name;
+    uint32_t    start;
+    uint32_t    end;
+};
+
+constexpr region kRegions[] = {
+    { "ROM bank 00", 0x0000, 0x4000 },
+    { "ROM bank NN", 0x4000, 0x8000 },
+    { "Video RAM", 0x8000, 0xA000 },
+    { "External RAM", 0xA000, 0xC000 },
+    { "Work RAM", 0xC000, 0xE000 },
+    { "Echo RAM", 0xE000, 0xFE00 },
+    { "OAM", 0xFE00, 0xFEA0 },
+    { "Unusable", 0xFEA0, 0xFF00 },
+    { "IO registers", 0xFF00, 0xFF80 },
+    { "High RAM", 0xFF80, 0xFFFF },
+    { "Interrupt enable", 0xFFFF, 0x10000 },
+};
+
+/// @brief Lines listed under each region of the summary.
+constexpr size_t kHottestLines = 4;
+} // namespace
+
+template <uint32_t kLineSize>
+bool
+AccessHeatmap<kLineSize>::exportToFile(FILE *file, uint64_t frame) const
+{
+    require_or(file != nullptr, return false);
+    uint32_t lineSize = kLineSize;
+    uint32_t lineCount = kLineCount;
+    bool written = (fwrite(kMagic, sizeof(kMagic), 1, file) == 1) && (fwrite(&lineSize, sizeof(lineSize), 1, file) == 1) &&
+                   (fwrite(&lineCount, sizeof(lineCount), 1, file) == 1) && (fwrite(&frame, sizeof(frame), 1, file) == 1) &&
+                   (fwrite(_reads.data(), sizeof(_reads), 1, file) == 1) &&
+                   (fwrite(_writes.data(), sizeof(_writes), 1, file) == 1);
+    require_or(written, log_error("Failed to write the memory heatmap (%s)", strerror(errno)); return false);
+    return true;
+}
+
+template <uint32_t kLineSize>
+void
+AccessHeatmap<kLineSize>::printSummary(FILE *file) const
+{
+    fprintf(file, "%-18s %14s %14s\n", "region", "reads", "writes");
+    for (auto &region: kRegions)
+    {
+        /// A line belongs to the region it starts in.
+        uint32_t first = (region.start + kLineSize - 1) / kLineSize;
+        uint32_t last = (region.end + kLineSize - 1) / kLineSize;
+        require_or(first < last, continue);
+        uint64_t reads = 0, writes = 0;
+        vector<uint32_t> lines;
+        for (uint32_t line = first; line < last; line++)
+        {
+            reads += _reads[line];
+            writes += _writes[line];
+            if (_reads[line] || _writes[line])
+            {
+                lines.push_back(line);
+            }
+        }
+        fprintf(file, "%-18s %14llu %14llu\n", region.name, static_cast<unsigned long long>(reads),
+                static_cast<unsigned long long>(writes));
+        size_t hottest = min(lines.size(), kHottestLines);
+        partial_sort(lines.begin(), lines.begin() + hottest, lines.end(), [this](uint32_t a, uint32_t b) {
+            return (_reads[a] + _writes[a]) > (_reads[b] + _writes[b]);
+        });
+        for (size_t i = 0; i < hottest; i++)
+        {
+            fprintf(file, "    0x%04x         %14llu %14llu\n", lines[i] * kLineSize,
+                    static_cast<unsigned long long>(_reads[lines[i]]), static_cast<unsigned long long>(_writes[lines[i]]));
+        }
+    }
+}
+
+template class emu::gameboy::detail::GameboyMemory::AccessHeatmap<1>;
+template class emu::gameboy::detail::GameboyMemory::AccessHeatmap<16>;
@@ -0,0 +1,226 @@
+#include "mbc.h"
+
+using namespace std;
+using namespace emu::gameboy::detail::GameboyMemory;
+
+bool
+MemoryBankController::configure(uint8_t cartridgeType, uint16_t romBanks, uint8_t ramSize)
+{
+    /// Header RAM size codes, in 8 KB banks. 2 KB cartridges get a whole bank.
+    static constexpr uint8_t kRAMBanks[] = { 0, 1, 1, 4, 16, 8 };
+
+    *this = MemoryBankController();
+    _romBanks = max<uint16_t>(romBanks, 2);
+    _ramBanks = (ramSize < sizeof(kRAMBanks)) ? kRAMBanks[ramSize] : 0;
+    switch (cartridgeType)
+    {
+    case 0x00:
+        _ramBanks = 0;
+        break;
+    case 0x08:
+        break;
+    case 0x09:
+        _battery = true;
+        break;
+    case 0x01:
+        _ramBanks = 0;
+        [[fallthrough]];
+    case 0x02:
+        _type = type::mbc1;
+        break;
+    case 0x03:
+        _type = type::mbc1;
+        _battery = true;
+        break;
+    case 0x0F:
+        _ramBanks = 0;
+        [[fallthrough]];
+    case 0x10:
+        _type = type::mbc3;
+        _battery = _clock = true;
+        break;
+    case 0x11:
+        _ramBanks = 0;
+        [[fallthrough]];
+    case 0x12:
+        _type = type::mbc3;
+        break;
+    case 0x13:
+        _type = type::mbc3;
+        _battery = true;
+        break;
+    case 0x19:
+    case 0x1C:
+        _ramBanks = 0;
+        [[fallthrough]];
+    case 0x1A:
+    case 0x1D:
+        _type = type::mbc5;
+        break;
+    case 0x1B:
+    case 0x1E:
+        _type = type::mbc5;
+        _battery = true;
+        break;
+    default:
+        _ramBanks = 0;
+        return false;
+    }
+    /// Without a controller the RAM can't be disabled.
+    _mapping.ramEnabled = (_type == type::none) && _ramBanks;
+    return true;
+}
+
+bool
+MemoryBankController::write(uint16_t address, uint8_t value, uint64_t mCycles)
+{
+    mapping previous = _mapping;
+    switch (_type)
+    {
+    case type::none:
+        return false;
+    case type::mbc1:
+        writeMBC1(address, value);
+        break;
+    case type::mbc3:
+        writeMBC3(address, value, mCycles);
+        break;
+    case type::mbc5:
+        writeMBC5(address, value);
+        break;
+    }
+    return !(_mapping == previous);
+}
+
+uint8_t
+MemoryBankController::readUnmapped() const
+{
+    require_or(_mapping.ramEnabled && _mapping.clockRegister, return 0xFF);
+    return _latchedClockRegisters[_mapping.clockRegister - 0x08];
+}
+
+void
+MemoryBankController::writeUnmapped(uint8_t value, uint64_t mCycles)
+{
+    require_or(_mapping.ramEnabled && _mapping.clockRegister, return);
+    tickClock(mCycles);
+    uint8_t index = _mapping.clockRegister - 0x08;
+    _clockRegisters[index] = value;
+    if (index == 0)
+    {
+        /// Writing the seconds restarts the current second.
+        _clockUpdated = mCycles;
+    }
+}
+
+void
+MemoryBankController::tickClock(uint64_t mCycles)
+{
+    static constexpr uint8_t kDayHigh = 0x01;
+    static constexpr uint8_t kHalt = 0x40;
+    static constexpr uint8_t kDayCarry = 0x80;
+    static constexpr uint64_t kSecondsPerDay = 24 * 60 * 60;
+
+    uint64_t seconds = (mCycles - _clockUpdated) / kMCyclesPerSecond;
+    _clockUpdated += seconds * kMCyclesPerSecond;
+    require_or(seconds && !(_clockRegisters[4] & kHalt), return);
+
+    auto &clock = _clockRegisters;
+    /// Out of range values count as their remainder, the day counter wraps at 512 and sets the carry flag.
+    uint64_t time = (clock[0] % 60) + 60 * (clock[1] % 60) + 60 * 60 * (clock[2] % 24) + seconds;
+    uint64_t days = (((clock[4] & kDayHigh) << 8) | clock[3]) + (time / kSecondsPerDay);
+    time %= kSecondsPerDay;
+    clock[0] = static_cast<uint8_t>(time % 60);
+    clock[1] = static_cast<uint8_t>((time / 60) % 60);
+    clock[2] = static_cast<uint8_t>(time / (60 * 60));
+    clock[3] = static_cast<uint8_t>(days);
+    clock[4] = (clock[4] & ~kDayHigh) | ((days >> 8) & kDayHigh) | ((days > 0x1FF) ? kDayCarry : 0);
+}
+
+void
+MemoryBankController::writeMBC1(uint16_t address, uint8_t value)
+{
+    switch (address >> 13)
+    {
+    case 0:
+        _mapping.ramEnabled = _ramBanks && ((value & 0x0F) == 0x0A);
+        break;
+    case 1:
+        /// Bank 0 can't be selected through the 5-bit register, which also makes banks 0x20/0x40/0x60 unreachable.
+        _romBankRegister = (value & 0x1F) ? (value & 0x1F) : 1;
+        break;
+    case 2:
+        _upperBankRegister = value & 0x03;
+        break;
+    case 3:
+        _advancedBanking = value & 0x01;
+        break;
+    }
+    /// The upper register extends the ROM bank, in advanced mode it also banks 0x0000-0x3FFF and the RAM.
+    _mapping.romBank01 = romBank((_upperBankRegister << 5) | _romBankRegister);
+    _mapping.romBank00 = _advancedBanking ? romBank(_upperBankRegister << 5) : 0;
+    _mapping.ramBank = _advancedBanking ? ramBank(_upperBankRegister) : 0;
+}
+
+void
+MemoryBankController::writeMBC3(uint16_t address, uint8_t value, uint64_t mCycles)
+{
+    switch (address >> 13)
+    {
+    case 0:
+        /// Enables the clock registers as well.
+        _mapping.ramEnabled = (_ramBanks || _clock) && ((value & 0x0F) == 0x0A);
+        break;
+    case 1:
+        _romBankRegister = (value & 0x7F) ? (value & 0x7F) : 1;
+        _mapping.romBank01 = romBank(_romBankRegister);
+        break;
+    case 2:
+        if (value <= 0x07)
+        {
+            _mapping.ramBank = ramBank(value);
+            _mapping.clockRegister = 0;
+        }
+        else if (_clock && in_range(value, 0x08, 0x0D))
+        {
+            _mapping.clockRegister = value;
+        }
+        break;
+    case 3:
+        /// Writing 0 then 1 copies the running clock to the registers that are read.
+        if (_clock && (_clockLatch == 0x00) && (value == 0x01))
+        {
+            tickClock(mCycles);
+            _latchedClockRegisters = _clockRegisters;
+        }
+        _clockLatch = value;
+        break;
+    }
+}
+
+void
+MemoryBankController::writeMBC5(uint16_t address, uint8_t value)
+{
+    switch (address >> 12)
+    {
+    case 0x0:
+    case 0x1:
+        _mapping.ramEnabled = _ramBanks && (value == 0x0A);
+        break;
+    case 0x2:
+        _romBankRegister = (_romBankRegister & 0x100) | value;
+        break;
+    case 0x3:
+        _romBankRegister = ((value & 0x01) << 8) | (_romBankRegister & 0xFF);
+        break;
+    case 0x4:
+    case 0x5:
+        /// Rumble cartridges wire bit 3 to the motor, they never have more than 4 banks so it wraps away.
+        _mapping.ramBank = ramBank(value & 0x0F);
+        break;
+    default:
+        break;
+    }
+    /// Bank 0 can be mapped at 0x4000-0x7FFF.
+    _mapping.romBank01 = romBank(_romBankRegister);
+}
@@ -6,82 +6,192 @@ using namespace emu::gameboy::detail::GameboyMemory;
 
 GameboyMemory::~GameboyMemory()
 {
-    _ioSignalerList.clear();
-    if (_memory)
+    /// A shared memory map belongs to `_view`.
+    if (_memory && !_view)
     {
         delete _memory;
     }
 }
 
 bool
-GameboyMemory::activate(const char *gamefile)
+GameboyMemory::activate(const char *gamefile, const char *bootROMFile)
 {
     require_or(gamefile != nullptr, return false);
-    assert(_memory = new memory);
+    _memory = _view ? new (_view->getMemory()) memory : new memory;
+    memset(_memory->raw, 0, sizeof(_memory->raw));
 
-    require_or(loadFile(gamefile, kMemoryMapSize), return false);
-    // Write ROM file onto the first 256 bytes of memory
-    require_or(loadFile(kDMGROMFilename, 0x100), return false);
+    require_or(_rom = ROMImage::open(gamefile), return false);
+    require_or(!bootROMFile || (_bootROM = ROMImage::open(bootROMFile)), return false);
     
     _gamefile = gamefile;
-    registerIOSignaler([&](uint16_t address, optional<uint8_t> value) {
-        require_or(value != nullopt, return);
-        _dma.inProgress = true;
-        _dma.sourceAddress = static_cast<uint16_t>(*value) << 8;
-        _dma.count = 0;
-    }, DirectMemoryAccess::kStartAddress, UINT16_MAX);
-    registerIOSignaler([&](uint16_t address, optional<uint8_t> value) {
-        require_or(value != nullopt, return);
-        /// @todo Shouldn't assume file is `kMemoryMapSize` bytes
-        loadFile(_gamefile, kMemoryMapSize);
-        memset(_memory->layout.objectAttributeMemory, 0, sizeof(_memory->layout.objectAttributeMemory));
-    }, 0xFF50, UINT16_MAX);
+    auto header = getROMBank00();
+    if (!_controller.configure(header->cartridgeType, static_cast<uint16_t>(_rom->size() / ROMImage::kBankSize), 
+                               header->ramSize))
+    {
+        log_error("Unsupported cartridge type 0x%02x, only the first 32 KB of ROM are mapped", header->cartridgeType);
+    }
+    _externalRAM.assign(_controller.getRAMSize(), 0);
+    /// The boot ROM is overlaid on the first page until it is disabled.
+    _bootROMMapped = (_bootROM != nullptr);
+    mapPages(0x00, sizeof(romBank00) >> 8, getROMBankMemory(0), accessHandler::rom);
+    mapPages(0x40, sizeof(romBank01) >> 8, getROMBankMemory(1), accessHandler::rom);
+    mapPages(0x80, sizeof(videoRAM) >> 8, _memory->raw + 0x8000, accessHandler::synchronized);
+    mapPages(0xA0, sizeof(externalRAM) >> 8, nullptr, accessHandler::cartridgeRAM);
+    mapPages(0xC0, (sizeof(workRAM00) + sizeof(workRAM01)) >> 8, _memory->raw + 0xC000, accessHandler::none);
+    mapPages(0xE0, sizeof(workRamMirror) >> 8, _memory->raw + 0xC000, accessHandler::none);
+    mapPages(0xFE, 1, _memory->raw + 0xFE00, accessHandler::synchronized);
+    mapPages(0xFF, 1, _memory->raw + 0xFF00, accessHandler::io);
+    mapBanks();
+
+    registerIOWriteHook(DirectMemoryAccess::kStartAddress, [&](uint16_t, uint8_t value) { startDMA(value); });
+    registerIOWriteHook(0xFF50, [&](uint16_t, uint8_t) { disableBootROM(); });
 
     return true;
 }
 
+void
+GameboyMemory::loadPostBootState()
+{
+    /// DMG values, the sound is powered on before its other registers are written.
+    static constexpr struct
+    {
+        uint16_t address;
+        uint8_t  value;
+    } kPostBootRegisters[] = {
+        { 0xFF00, 0xCF }, { 0xFF02, 0x7E }, { 0xFF05, 0x00 }, { 0xFF06, 0x00 }, { 0xFF07, 0xF8 },
+        { 0xFF26, 0xF1 }, { 0xFF10, 0x80 }, { 0xFF11, 0xBF }, { 0xFF12, 0xF3 }, { 0xFF13, 0xFF },
+        { 0xFF14, 0xBF }, { 0xFF16, 0x3F }, { 0xFF17, 0x00 }, { 0xFF18, 0xFF }, { 0xFF19, 0xBF },
+        { 0xFF1A, 0x7F }, { 0xFF1B, 0xFF }, { 0xFF1C, 0x9F }, { 0xFF1D, 0xFF }, { 0xFF1E, 0xBF },
+        { 0xFF20, 0xFF }, { 0xFF21, 0x00 }, { 0xFF22, 0x00 }, { 0xFF23, 0xBF }, { 0xFF24, 0x77 },
+        { 0xFF25, 0xF3 }, { 0xFF42, 0x00 }, { 0xFF43, 0x00 }, { 0xFF45, 0x00 }, { 0xFF47, 0xFC },
+        { 0xFF48, 0xFF }, { 0xFF49, 0xFF }, { 0xFF4A, 0x00 }, { 0xFF4B, 0x00 }, { 0xFF40, 0x91 },
+        { 0xFF50, 0x01 }, { 0xFF0F, 0xE1 }, { 0xFFFF, 0x00 },
+    };
+    for (auto &registerValue: kPostBootRegisters)
+    {
+        write<uint8_t>(registerValue.address, registerValue.value);
+    }
+    /// Writing DIV clears it, the PPU owns STAT's mode and LY.
+    _memory->layout.ioRegisters.timer.divider = 0xAB;
+}
+
 void
 GameboyMemory::read(uint16_t address, uint8_t * const bufferOut, uint16_t nbytes) const
 {
     assert((static_cast<uint32_t>(nbytes) + address) <= kMemoryMapSize);
-    memcpy(bufferOut, _memory->raw + address, nbytes);
+    _accessCounter.countRead(address, nbytes);
+    for (uint32_t offset = 0; offset < nbytes; offset++)
+    {
+        bufferOut[offset] = peek(static_cast<uint16_t>(address + offset));
+    }
 }
 
 void
 GameboyMemory::write(uint16_t address, const uint8_t * const buffer, uint16_t nbytes)
 {
     assert((static_cast<uint32_t>(nbytes) + address) <= kMemoryMapSize);
-    memcpy(&_memory->raw[address], buffer, nbytes);
+    _accessCounter.countWrite(address, nbytes);
+    for (uint32_t offset = 0; offset < nbytes; offset++)
+    {
+        uint16_t current = static_cast<uint16_t>(address + offset);
+        const page &entry = _pages[current >> 8];
+        require_or(entry.memory != nullptr && entry.handler != accessHandler::rom, continue);
+        if (in_range(current, kVideoRAMAddress, kExternalRAMAddress) && _videoRAMWriteCallback)
+        {
+            _videoRAMWriteCallback(current);
+        }
+        entry.memory[current & 0xFF] = buffer[offset];
+        if (_savePages[current >> 8])
+        {
+            saveWritten(current >> 8);
+        }
+        if (_cleanPages[getAliasPage(current >> 8)] || _cleanPages[current >> 8])
+        {
+            markDirty(current >> 8);
+        }
+    }
+    codeWritten(address, nbytes);
 }
 
 void
-GameboyMemory::mCycleUpdate(uint8_t cycles)
+GameboyMemory::mCycleUpdate(uint32_t cycles)
+{
+    require_or(_dma.inProgress, return);
+    _dma.remaining -= emu::min<uint32_t>(_dma.remaining, cycles);
+    require_or(_dma.remaining == 0, return);
+    finishDMA();
+}
+
+uint64_t
+GameboyMemory::getCyclesUntilEvent() const
 {
-    if (_dma.inProgress)
+    /// Nothing happens until the transfer completes.
+    return _dma.inProgress ? _dma.remaining : UINT64_MAX;
+}
+
+void
+GameboyMemory::startDMA(uint8_t sourcePage)
+{
+    /// A transfer started while one is in progress replaces it.
+    _dma.inProgress = true;
+    _dma.sourceAddress = static_cast<uint16_t>(sourcePage) << 8;
+    _dma.remaining = DirectMemoryAccess::kDurationMCycles;
+    lockBus(true);
+}
+
+void
+GameboyMemory::finishDMA()
+{
+    _dma.inProgress = false;
+    lockBus(false);
+    /// The source can't have changed while the bus was locked, so all of it is copied at once. Sources above work RAM
+    /// read echo RAM.
+    uint16_t source = _dma.sourceAddress;
+    if (source >= 0xE000)
     {
-        static constexpr uint8_t kLoopEndValue = DirectMemoryAccess::kDurationMCycles;
-        assert(_dma.count < kLoopEndValue);
-        for (; _dma.count < emu::min(kLoopEndValue, cycles + _dma.count); _dma.count++)
-        {
-            uint16_t dst = DirectMemoryAccess::kDestinationAddress + _dma.count;
-            uint16_t src = _dma.sourceAddress + _dma.count;
-            _memory->raw[dst] = _memory->raw[src]; 
-        }
-        if (_dma.count == kLoopEndValue)
+        source -= 0x2000;
+    }
+    const uint8_t *memory = _pages[source >> 8].memory;
+    auto destination = reinterpret_cast<uint8_t *>(_memory->layout.objectAttributeMemory);
+    if (memory && !((source < 0x100) && _bootROMMapped))
+    {
+        memcpy(destination, memory, DirectMemoryAccess::kLength);
+    }
+    else
+    {
+        for (uint16_t i = 0; i < DirectMemoryAccess::kLength; i++)
         {
-            _dma.inProgress = false;
-            for (auto attr: _memory->layout.objectAttributeMemory)
-            {
-                printf("attr.position.y = %x\n", attr.position.y);
-                printf("attr.position.x = %x\n", attr.position.x);
-                printf("attr.tileId = %x\n", attr.tileId);
-                printf("attr.flags.palette = %x\n", attr.flags.palette);
-                printf("attr.flags.flipX = %x\n", attr.flags.flipX);
-                printf("attr.flags.flipY = %x\n", attr.flags.flipY);
-                printf("attr.flags.priority = %x\n", attr.flags.priority);
-            }
+            destination[i] = peek(source + i);
         }
     }
+    if (_dirtyTracking)
+    {
+        markDirty(DirectMemoryAccess::kDestinationAddress >> 8);
+    }
+}
+
+void
+GameboyMemory::lockBus(bool locked)
+{
+    require_or(locked != _dma.busLocked, return);
+    _dma.busLocked = locked;
+    for (uint32_t page = 0; page < kPageCount; page++)
+    {
+        updateReadPointer(page);
+        updateWritePointer(page);
+    }
+    if (_bankSwitchCallback)
+    {
+        _bankSwitchCallback();
+    }
+}
+
+bool
+GameboyMemory::shareMemory(const char *name)
+{
+    require_or(!_memory, log_error("The memory map must be shared before it is activated"); return false);
+    require_or(_view = LiveView::create(name, sizeof(memory)), return false);
+    return true;
 }
 
 void
@@ -104,33 +214,78 @@ GameboyMemory::dumpToFile()
         }
         i++;
     }
+    /// Dump what the CPU sees, the cartridge ROM isn't part of `_memory`.
+    vector<uint8_t> snapshot(kMemoryMapSize);
+    for (uint32_t address = 0; address < kMemoryMapSize; address++)
+    {
+        snapshot[address] = peek(static_cast<uint16_t>(address));
+    }
     FILE *file = fopen(buffer, "w");
-    size_t bytes_written = fwrite(&_memory->raw, 1, kMemoryMapSize, file);
+    size_t bytes_written = fwrite(snapshot.data(), 1, kMemoryMapSize, file);
     log_debug("Wrote 0x%08x bytes to file.", (uint32_t)bytes_written);
     fclose(file);
 }
 
-uint8_t
-GameboyMemory::registerIOSignaler(IOSignaler::CallbackFn callback, uint16_t compare, uint16_t mask)
+GameboyMemory::IOHookHandle
+GameboyMemory::registerIOWriteHook(uint16_t address, IOWriteHookFn hook, uint8_t count)
 {
-    IOSignaler info = {
-        .callback = std::move(callback),
-        .compare = compare,
-        .mask = mask,
-        .id = static_cast<uint8_t>(_ioSignalerList.size()),
-    };
-    IOSignaler tmp = info;
-    _ioSignalerList.insert(_ioSignalerList.end(), info);
-    return info.id;
+    require_or(hook && canHookIORegisters(address, count, true),
+               log_error("Failed to hook writes to 0x%04x", address); return kInvalidIOHook);
+    IOHookHandle handle = _nextIOHookHandle++;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        auto &entry = _ioHooks[address - kIORegistersAddress + i];
+        entry.write = hook;
+        entry.writeHandle = handle;
+    }
+    return handle;
+}
+
+GameboyMemory::IOHookHandle
+GameboyMemory::registerIOReadHook(uint16_t address, IOReadHookFn hook, uint8_t count)
+{
+    require_or(hook && canHookIORegisters(address, count, false),
+               log_error("Failed to hook reads of 0x%04x", address); return kInvalidIOHook);
+    IOHookHandle handle = _nextIOHookHandle++;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        auto &entry = _ioHooks[address - kIORegistersAddress + i];
+        entry.read = hook;
+        entry.readHandle = handle;
+    }
+    return handle;
 }
 
 void 
-GameboyMemory::deregisterIOSignaler(uint8_t id)
+GameboyMemory::deregisterIOHook(IOHookHandle handle)
 {
-    static auto remove_predicate = [id](const IOSignaler &info) -> bool {
-        return info.id == id;
-    };
-    _ioSignalerList.remove_if(remove_predicate);
+    require_or(handle != kInvalidIOHook, return);
+    for (auto &entry: _ioHooks)
+    {
+        if (entry.writeHandle == handle)
+        {
+            entry.write = nullptr;
+            entry.writeHandle = kInvalidIOHook;
+        }
+        if (entry.readHandle == handle)
+        {
+            entry.read = nullptr;
+            entry.readHandle = kInvalidIOHook;
+        }
+    }
+}
+
+bool
+GameboyMemory::canHookIORegisters(uint16_t address, uint8_t count, bool isWrite) const
+{
+    require_or(count > 0 && address >= kIORegistersAddress &&
+               (address - kIORegistersAddress + count) <= static_cast<int>(_ioHooks.size()), return false);
+    for (uint16_t i = 0; i < count; i++)
+    {
+        auto &entry = _ioHooks[address - kIORegistersAddress + i];
+        require_or((isWrite ? entry.writeHandle : entry.readHandle) == kInvalidIOHook, return false);
+    }
+    return true;
 }
 
 void
@@ -170,37 +325,265 @@ GameboyMemory::print(uint8_t *buffer, uint16_t offset, uint16_t length)
     printBytes(&buffer[row], length - row);
 }
 
-void 
-GameboyMemory::signal(uint16_t address, std::optional<uint8_t> writeValue) const
+void
+GameboyMemory::codeWritten(uint16_t address, uint32_t nbytes)
 {
-    for (auto &itr : _ioSignalerList)
+    require_or(nbytes, return);
+    uint32_t lastPage = (address + nbytes - 1) >> 8;
+    for (uint32_t page = address >> 8; page <= lastPage; page++)
     {
-        require_or(itr.compare == (address & itr.mask), continue);
-        itr.callback(address, writeValue);
+        /// A write through echo RAM changes the work RAM page it mirrors, and vice versa.
+        for (uint8_t watched: { static_cast<uint8_t>(page), getAliasPage(static_cast<uint8_t>(page)) })
+        {
+            require_or(_codePages[watched], continue);
+            _codePages[watched] = false;
+            updateWritePointer(watched);
+            updateWritePointer(getAliasPage(watched));
+            if (_codeWriteCallback)
+            {
+                _codeWriteCallback(watched);
+            }
+        }
     }
 }
 
-bool
-GameboyMemory::loadFile(const char *filename, size_t size)
+void
+GameboyMemory::disableBootROM()
 {
-    assert(_memory);
-    log_debug("Loading game file \"%s\"", filename);
-    
-    FILE *stream = fopen(filename, "rb");
-    if (stream == NULL)
+    require_or(_bootROMMapped, return);
+    _bootROMMapped = false;
+    updateReadPointer(0x00);
+    memset(_memory->layout.objectAttributeMemory, 0, sizeof(_memory->layout.objectAttributeMemory));
+    /// Instructions decoded from the boot ROM are stale now.
+    codeWritten(0, 0x100);
+}
+
+uint8_t
+GameboyMemory::readHandler(uint16_t address) const
+{
+    if (in_range(address, kIORegistersAddress, kHighRAMAddress))
+    {
+        accessed(false);
+        auto &hook = _ioHooks[address - kIORegistersAddress];
+        if (hook.read)
+        {
+            hook.read(address);
+        }
+        return _memory->raw[address];
+    }
+    /// The bus is driven by the transfer, the CPU reads open bus.
+    require_or(!isBusLocked(address >> 8), return 0xFF);
+    return peek(address);
+}
+
+void
+GameboyMemory::writeHandler(uint16_t address, uint8_t value)
+{
+    uint8_t page = address >> 8;
+    const auto &entry = _pages[page];
+    require_or(!isBusLocked(page), return);
+    if (entry.handler == accessHandler::rom)
+    {
+        if (_controller.write(address, value, getCycleCount()))
+        {
+            mapBanks();
+        }
+        return;
+    }
+    require_or(entry.handler != accessHandler::cartridgeRAM, _controller.writeUnmapped(value, getCycleCount()); return);
+    bool isRegister = (entry.handler == accessHandler::io) && (address < kHighRAMAddress);
+    if ((entry.handler == accessHandler::synchronized) || isRegister)
+    {
+        accessed(true);
+    }
+    if (in_range(address, kVideoRAMAddress, kExternalRAMAddress) && _videoRAMWriteCallback)
+    {
+        _videoRAMWriteCallback(address);
+    }
+    entry.memory[address & 0xFF] = value;
+    if (expect_false(_codePages[page] || _codePages[getAliasPage(page)]))
+    {
+        codeWritten(address, sizeof(uint8_t));
+    }
+    if (expect_false(_savePages[page]))
+    {
+        saveWritten(page);
+    }
+    if (expect_false(_cleanPages[page] || _cleanPages[getAliasPage(page)]))
+    {
+        markDirty(page);
+    }
+    if (isRegister)
     {
-        fprintf(stderr, "Failed to open file! (%s)\n", strerror(errno));
-        return false;
+        auto &hook = _ioHooks[address - kIORegistersAddress];
+        if (hook.write)
+        {
+            hook.write(address, value);
+        }
     }
+}
 
-    size_t bytesRead = fread(_memory->raw, sizeof(uint8_t), size, stream);
-    fclose(stream);
-    if (bytesRead == 0)
+void
+GameboyMemory::mapBanks()
+{
+    auto &mapping = _controller.getMapping();
+    bool switched = false;
+    if (mapping.romBank00 != _mappedBanks[0])
+    {
+        mapPages(0x00, sizeof(romBank00) >> 8, getROMBankMemory(mapping.romBank00), accessHandler::rom);
+        _mappedBanks[0] = mapping.romBank00;
+        switched = true;
+    }
+    if (mapping.romBank01 != _mappedBanks[1])
+    {
+        mapPages(0x40, sizeof(romBank01) >> 8, getROMBankMemory(mapping.romBank01), accessHandler::rom);
+        _mappedBanks[1] = mapping.romBank01;
+        switched = true;
+    }
+    bool ramMapped = mapping.ramEnabled && !mapping.clockRegister && _controller.getRAMSize();
+    int16_t ramBank = ramMapped ? mapping.ramBank : -1;
+    if (ramBank != _mappedRAMBank)
     {
-        fprintf(stderr, "Failed to initialize file! (%s)\n", strerror(errno));
-        return false;
+        uint8_t *bank = ramMapped ? getExternalRAMBank(mapping.ramBank) : nullptr;
+        mapPages(0xA0, sizeof(externalRAM) >> 8, bank, ramMapped ? accessHandler::none : accessHandler::cartridgeRAM);
+        _mappedRAMBank = ramBank;
+        watchSavePages();
+        if (_dirtyTracking)
+        {
+            markDirty(0xA0, sizeof(externalRAM) >> 8);
+        }
+        /// Code run from external RAM isn't tagged with its bank, it is decoded again.
+        codeWritten(0xA000, sizeof(externalRAM));
+        switched = true;
+    }
+    if (switched && _bankSwitchCallback)
+    {
+        _bankSwitchCallback();
     }
-    // clear unset memory
-    memset(_memory->raw + bytesRead, 0, size - bytesRead);
+}
+
+bool
+GameboyMemory::loadSaveFile(const char *filename)
+{
+    require_or(_controller.hasBattery() && _controller.getRAMSize(), return false);
+    auto save = SaveFile::open(filename, _controller.getRAMSize());
+    require_or(save, return false);
+    _save = std::move(save);
+    _externalRAM.clear();
+    /// Map the bank again from the file.
+    _mappedRAMBank = -1;
+    mapBanks();
     return true;
 }
+
+void
+GameboyMemory::flushSaveFile()
+{
+    require_or(_save, return);
+    _save->flush();
+    watchSavePages();
+}
+
+void
+GameboyMemory::watchSavePages()
+{
+    static constexpr uint8_t kExternalRAMPage = 0xA0;
+    for (uint8_t page = kExternalRAMPage; page < kExternalRAMPage + (sizeof(externalRAM) >> 8); page++)
+    {
+        _savePages[page] = _save && (_mappedRAMBank >= 0);
+        updateWritePointer(page);
+    }
+}
+
+void
+GameboyMemory::saveWritten(uint8_t page)
+{
+    _savePages[page] = false;
+    updateWritePointer(page);
+    _save->markDirty((_mappedRAMBank * MemoryBankController::kRAMBankSize) + ((page & 0x1F) << 8));
+}
+
+void
+GameboyMemory::setDirtyTracking(bool enable)
+{
+    _dirtyTracking = enable;
+    clearDirtyPages();
+}
+
+void
+GameboyMemory::clearDirtyPages()
+{
+    _dirtyPages.reset();
+    for (uint32_t page = 0; page < kPageCount; page++)
+    {
+        _cleanPages[page] = _dirtyTracking && isDirtyTracked(page);
+    }
+    for (uint32_t page = 0; page < kPageCount; page++)
+    {
+        updateWritePointer(page);
+    }
+}
+
+void
+GameboyMemory::markDirty(uint8_t first, uint32_t count)
+{
+    for (uint32_t i = first; i < first + count; i++)
+    {
+        /// Echo RAM is tracked as the work RAM it mirrors.
+        uint8_t page = in_range(i, 0xE0, 0xFE) ? getAliasPage(i) : i;
+        _dirtyPages.set(page);
+        require_or(_cleanPages[page], continue);
+        _cleanPages[page] = false;
+        updateWritePointer(page);
+        updateWritePointer(getAliasPage(page));
+    }
+}
+
+void
+GameboyMemory::mapPages(uint8_t first, uint32_t count, uint8_t *memory, accessHandler handler)
+{
+    assert(first + count <= kPageCount);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        page &entry = _pages[first + i];
+        entry.memory = memory ? (memory + (i << 8)) : nullptr;
+        entry.handler = handler;
+        updateReadPointer(static_cast<uint8_t>(first + i));
+        updateWritePointer(static_cast<uint8_t>(first + i));
+    }
+}
+
+void
+GameboyMemory::updateReadPointer(uint8_t page)
+{
+    const uint8_t *memory = (_pages[page].handler == accessHandler::io) ? nullptr : _pages[page].memory;
+    if ((page == 0x00) && _bootROMMapped)
+    {
+        memory = _bootROM->data();
+    }
+    _readPages[page] = isBusLocked(page) ? nullptr : memory;
+}
+
+void
+GameboyMemory::updateWritePointer(uint8_t page)
+{
+    uint8_t alias = getAliasPage(page);
+    bool watched = _codePages[page] || _codePages[alias] || _savePages[page] || _cleanPages[page] || _cleanPages[alias];
+    bool direct = (_pages[page].handler == accessHandler::none) && !watched && !isBusLocked(page);
+    _writePages[page] = direct ? _pages[page].memory : nullptr;
+    if (page == (kHighRAMAddress >> 8))
+    {
+        _highRAMWritable = !watched;
+    }
+}
+
+uint8_t
+GameboyMemory::peek(uint16_t address) const
+{
+    if (expect_false((address < 0x100) && _bootROMMapped))
+    {
+        return _bootROM->data()[address];
+    }
+    const uint8_t *memory = _pages[address >> 8].memory;
+    return memory ? memory[address & 0xFF] : _controller.readUnmapped();
+}
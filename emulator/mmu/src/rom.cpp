@@ -0,0 +1,111 @@
+#include "rom.h"
+
+#include <fcntl.h>
+#include <map>
+#include <mutex>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
+
+using namespace std;
+using namespace emu::gameboy::detail::GameboyMemory;
+
+/// @brief Header checksum (0x014D) followed by the global checksum (0x014E-0x014F).
+static constexpr off_t kChecksumOffset = 0x014D;
+
+static size_t
+paddedSize(size_t fileSize)
+{
+    size_t size = (fileSize + ROMImage::kBankSize - 1) & ~(ROMImage::kBankSize - 1);
+    return max(size, ROMImage::kMinimumSize);
+}
+
+/* static */
+shared_ptr<const ROMImage>
+ROMImage::open(const char *filename)
+{
+    /// Canonical path, file size and checksums.
+    using key = tuple<string, size_t, uint32_t>;
+    static mutex cacheLock;
+    static std::map<key, weak_ptr<const ROMImage>> cache;
+
+    require_or(filename != nullptr, return nullptr);
+    log_debug("Loading ROM file \"%s\"", filename);
+    int fd = ::open(filename, O_RDONLY);
+    require_or(fd >= 0, log_error("Failed to open %s (%s)", filename, strerror(errno)); return nullptr);
+    struct stat info = {};
+    fstat(fd, &info);
+    shared_ptr<ROMImage> image(new ROMImage);
+    /// Only regular files can be identified without reading them, anything else gets a private copy.
+    if (!S_ISREG(info.st_mode))
+    {
+        bool loaded = image->read(fd);
+        close(fd);
+        require_or(loaded, log_error("Failed to read %s", filename); return nullptr);
+        return image;
+    }
+    uint8_t checksum[3] = {};
+    pread(fd, checksum, sizeof(checksum), kChecksumOffset);
+    char path[PATH_MAX];
+    key cacheKey(realpath(filename, path) ? path : filename, static_cast<size_t>(info.st_size),
+                 (checksum[0] << 16) | (checksum[1] << 8) | checksum[2]);
+
+    lock_guard<mutex> lock(cacheLock);
+    if (auto cached = cache[cacheKey].lock())
+    {
+        close(fd);
+        return cached;
+    }
+    bool loaded = image->map(fd, info.st_size) || image->read(fd);
+    close(fd);
+    require_or(loaded, log_error("Failed to read %s", filename); return nullptr);
+    /// Drop the entries of images nobody uses anymore.
+    erase_if(cache, [](auto &entry) { return entry.second.expired(); });
+    cache[cacheKey] = image;
+    return image;
+}
+
+ROMImage::~ROMImage()
+{
+    if (_mapped)
+    {
+        munmap(const_cast<uint8_t *>(_data), _size);
+    }
+}
+
+bool
+ROMImage::map(int fd, size_t fileSize)
+{
+    require_or(fileSize > 0, return false);
+    size_t size = paddedSize(fileSize);
+    /// Reserve the padded size as zero pages first, touching file pages past the end of the file would fault.
+    void *reserved = mmap(nullptr, size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    require_or(reserved != MAP_FAILED, return false);
+    void *file = mmap(reserved, fileSize, PROT_READ, MAP_SHARED | MAP_FIXED, fd, 0);
+    require_or(file != MAP_FAILED, munmap(reserved, size); return false);
+    _data = static_cast<const uint8_t *>(file);
+    _size = size;
+    _fileSize = fileSize;
+    _mapped = true;
+    return true;
+}
+
+bool
+ROMImage::read(int fd)
+{
+    _copy.clear();
+    uint8_t buffer[4096];
+    ssize_t bytesRead = 0;
+    lseek(fd, 0, SEEK_SET);
+    while ((bytesRead = ::read(fd, buffer, sizeof(buffer))) > 0)
+    {
+        _copy.insert(_copy.end(), buffer, buffer + bytesRead);
+    }
+    require_or(bytesRead == 0 && !_copy.empty(), return false);
+    _fileSize = _copy.size();
+    _copy.resize(paddedSize(_fileSize), 0);
+    _data = _copy.data();
+    _size = _copy.size();
+    _mapped = false;
+    return true;
+}
@@ -0,0 +1,103 @@
+#include "save.h"
+
+#include <algorithm>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+using namespace emu::gameboy::detail::GameboyMemory;
+
+/* static */
+unique_ptr<SaveFile>
+SaveFile::open(const char *filename, size_t size)
+{
+    require_or(filename != nullptr && size > 0, return nullptr);
+    int fd = ::open(filename, O_RDWR | O_CREAT, 0644);
+    require_or(fd >= 0, log_error("Failed to open %s (%s)", filename, strerror(errno)); return nullptr);
+    struct stat info = {};
+    fstat(fd, &info);
+    /// Longer files are left alone, other emulators append the clock after the RAM.
+    if (static_cast<size_t>(info.st_size) < size && ftruncate(fd, size) != 0)
+    {
+        log_error("Failed to extend %s (%s)", filename, strerror(errno));
+        close(fd);
+        return nullptr;
+    }
+    void *data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    require_or(data != MAP_FAILED, log_error("Failed to map %s (%s)", filename, strerror(errno)); return nullptr);
+
+    unique_ptr<SaveFile> save(new SaveFile);
+    save->_data = static_cast<uint8_t *>(data);
+    save->_size = size;
+    save->_pageSize = sysconf(_SC_PAGESIZE);
+    save->_dirty.assign((size + save->_pageSize - 1) / save->_pageSize, false);
+    save->_pending = save->_dirty;
+    save->_writer = thread([save = save.get()]() { save->writeBack(); });
+    return save;
+}
+
+SaveFile::~SaveFile()
+{
+    flush();
+    {
+        lock_guard<mutex> lock(_lock);
+        _stop = true;
+    }
+    _wake.notify_one();
+    if (_writer.joinable())
+    {
+        _writer.join();
+    }
+    munmap(_data, _size);
+}
+
+void
+SaveFile::flush()
+{
+    require_or(find(_dirty.begin(), _dirty.end(), true) != _dirty.end(), return);
+    {
+        lock_guard<mutex> lock(_lock);
+        for (size_t i = 0; i < _dirty.size(); i++)
+        {
+            _pending[i] = _pending[i] || _dirty[i];
+        }
+    }
+    _dirty.assign(_dirty.size(), false);
+    _wake.notify_one();
+}
+
+void
+SaveFile::writeBack()
+{
+    vector<bool> pages(_pending.size(), false);
+    unique_lock<mutex> lock(_lock);
+    while (true)
+    {
+        _wake.wait(lock, [&]() { return _stop || find(_pending.begin(), _pending.end(), true) != _pending.end(); });
+        /// Pending pages are written back before stopping.
+        require_or(!_stop || find(_pending.begin(), _pending.end(), true) != _pending.end(), break);
+        swap(pages, _pending);
+        lock.unlock();
+        /// Runs of consecutive pages are synced together.
+        for (size_t first = 0; first < pages.size(); first++)
+        {
+            require_or(pages[first], continue);
+            size_t last = first;
+            while ((last + 1) < pages.size() && pages[last + 1])
+            {
+                last++;
+            }
+            size_t offset = first * _pageSize;
+            size_t length = emu::min((last + 1) * _pageSize, _size) - offset;
+            if (msync(_data + offset, length, MS_SYNC) != 0)
+            {
+                log_error("Failed to write back the save file (%s)", strerror(errno));
+            }
+            fill(pages.begin() + first, pages.begin() + last + 1, false);
+            first = last;
+        }
+        lock.lock();
+    }
+}
@@ -0,0 +1,63 @@
+#include "view.h"
+
+#include <fcntl.h>
+#include <new>
+#include <sys/mman.h>
+
+using namespace std;
+using namespace emu::gameboy::detail::GameboyMemory;
+
+/* static */
+unique_ptr<LiveView>
+LiveView::create(const char *name, size_t memorySize)
+{
+    require_or(name != nullptr && memorySize > 0, return nullptr);
+    /// POSIX names start with a single slash.
+    string path = (name[0] == '/') ? name : string("/") + name;
+    /// Never take over an existing segment, another emulator or tool may still be using it.
+    int fd = shm_open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    require_or(fd >= 0 || errno != EEXIST,
+               log_error("%s already exists, close the emulator using it or unlink it", path.c_str());
+               return nullptr);
+    require_or(fd >= 0, log_error("Failed to create %s (%s)", path.c_str(), strerror(errno)); return nullptr);
+    /// The header gets a page to itself so the memory map starts page aligned.
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t size = pageSize + memorySize;
+    void *data = MAP_FAILED;
+    if (ftruncate(fd, size) == 0)
+    {
+        data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    require_or(data != MAP_FAILED, log_error("Failed to map %s (%s)", path.c_str(), strerror(errno));
+               shm_unlink(path.c_str()); return nullptr);
+
+    unique_ptr<LiveView> view(new LiveView);
+    view->_name = path;
+    view->_data = static_cast<uint8_t *>(data);
+    view->_size = size;
+    view->_header = new (data) liveViewHeader{};
+    memcpy(view->_header->magic, liveViewHeader::kMagic, sizeof(liveViewHeader::kMagic));
+    view->_header->version = liveViewHeader::kVersion;
+    view->_header->memoryOffset = static_cast<uint32_t>(pageSize);
+    view->_header->memorySize = static_cast<uint32_t>(memorySize);
+    return view;
+}
+
+LiveView::~LiveView()
+{
+    munmap(_data, _size);
+    shm_unlink(_name.c_str());
+}
+
+void
+LiveView::publishFrame(uint64_t cycles)
+{
+    /// Single writer, the stamps only have to be ordered between the two sequence updates.
+    uint32_t sequence = _header->sequence.load(memory_order_relaxed);
+    _header->sequence.store(sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    _header->frame.store(_header->frame.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    _header->cycles.store(cycles, memory_order_relaxed);
+    _header->sequence.store(sequence + 2, memory_order_release);
+}
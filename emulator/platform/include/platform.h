@@ -15,7 +15,7 @@
 #include <signal.h>
 #include <time.h>
 
-#include <queue>
+#include <type_traits>
 
 #include "config.h"
 
@@ -231,32 +231,56 @@ inline char to_upper(char c)
     return ('a' <= c && c <= 'z') ? c - 'a' + 'A' : c;
 }
 
+/**
+ * @brief Bounded FIFO with its storage inline, it never allocates and copies like a plain struct.
+ *
+ * The head and tail count up forever and are masked on access, which is why the capacity is a power of two: the
+ * difference between them stays the size across wrap-around. Enqueuing onto a full queue drops the oldest element.
+ */
 template <typename T, size_t kCapacity>
-class circular_queue: public std::queue<T>
+class circular_queue
 {
+    static_assert((kCapacity > 0) && ((kCapacity & (kCapacity - 1)) == 0), "The capacity must be a power of two");
+    static_assert(kCapacity <= (1U << 31), "The capacity must fit the indexes");
+    static_assert(std::is_trivially_copyable<T>::value, "Elements are copied around as bytes");
+
 public:
     void enqueue(T newValue)
     {
-        if (this->size() == kCapacity)
+        if (full())
         {
-            this->pop();
+            _head++;
         }
-        this->push(newValue);
+        _elements[_tail++ & kMask] = newValue;
     }
     
     T dequeue()
     {
-        auto fnt = this->front();
-        this->pop();
-        return std::move(fnt);
+        assert(!empty());
+        return _elements[_head++ & kMask];
     }
-    
-    void clear()
+
+    T &front()
     {
-        std::queue<T> empty;
-        std::swap(*this, empty);
+        assert(!empty());
+        return _elements[_head & kMask];
     }
+
+    size_t size() const { return _tail - _head; }
+    bool empty() const { return _tail == _head; }
+    bool full() const { return size() == kCapacity; }
+    static constexpr size_t capacity() { return kCapacity; }
+    
+    void clear() { _head = _tail = 0; }
+
+private:
+    static constexpr uint32_t kMask = kCapacity - 1;
+
+    T        _elements[kCapacity];
+    uint32_t _head = 0;
+    uint32_t _tail = 0;
 };
+static_assert(std::is_trivially_copyable<circular_queue<uint8_t, 16>>::value);
 } // namespace emu
 
 #endif /* _PLATFORM_H_ */
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "hal.h"
 #include "mmu.h"
 #include "platform.h"
+#include "tile_cache.h"
 
 namespace emu::gameboy {
 namespace detail::PixelProcessor {
@@ -30,7 +31,7 @@ public:
     };
 
 public:
-    PixelFetcher(std::shared_ptr<GameboyMemory> memory);
+    PixelFetcher(std::shared_ptr<GameboyMemory> memory, TileCache *tileCache);
     ~PixelFetcher();
     
     void reset(config_t config, point_t point);
@@ -42,8 +43,7 @@ public:
 
 private:
     uint8_t getTileId(io::ppu::lcd::tilemap tilemapBlock, uint8_t x, uint8_t y);
-    uint8_t getTileDataIndex(uint8_t positionY);
-    void insertPixels(circular_queue<pixelInfo, 16> *queue, uint8_t priority, uint8_t palette, bool flipX, bool isBg);
+    void insertPixels(circular_queue<pixelInfo, 16> *queue, uint8_t priority, uint8_t palette, bool isBg);
 
 private:
     /** Current state machine state */
@@ -63,11 +63,13 @@ private:
     config_t                         _config;
     GameboyMemory::objectAttributes *_object = nullptr;
     GameboyMemory::videoRAM *        _videoRam = nullptr;
+    TileCache *                      _tileCache = nullptr;
     uint8_t                          _objectRow;
     /** Tile data from VRAM */
     struct
     {
-        Word16 data;
+        /// Color indices of the fetched row, already flipped for objects with flipX
+        uint8_t pixels[8];
         uint8_t tileId;
     } _info;
 };
@@ -83,9 +85,20 @@ public:
     using lcdControl = io::ppu::lcd::control;
     using lcdStatus = io::ppu::lcd::status;
     using objectAttributes = GameboyMemory::objectAttributes;
+    /// @brief Called when a frame is complete, as VBlank starts.
+    using FrameCallbackFn = std::function<void()>;
+    /// @brief Lines drawn by each renderer.
+    struct lineStats
+    {
+        /// Drawn at once by `renderScanline`
+        uint32_t scanline = 0;
+        /// Drawn a dot at a time by the pixel FIFO
+        uint32_t fifo = 0;
+    };
 
 private:
     using PixelFetcher = detail::PixelProcessor::PixelFetcher;
+    using TileCache = detail::PixelProcessor::TileCache;
 
 public:
     PixelProcessor();
@@ -101,11 +114,39 @@ public:
     void setBGWindowTileDataArea(tiledata block);
     
     uint8_t getCurrentRow() const;
+    /// @brief Decoded tiles, for anything that shows them.
+    TileCache &getTileCache() { return _tileCache; }
+    void setFrameCallback(FrameCallbackFn callback) { _frameCallback = std::move(callback); }
+    /**
+     * @brief Draw lines at once when the transfer ends rather than through the pixel FIFO, on by default.
+     *
+     * A line falls back to the FIFO when it needs it: the scroll, palette, LCDC or window registers or video RAM are
+     * written during its transfer, or its objects overlap. OAM writes during the transfer, including the ones OAM DMA
+     * makes, aren't watched: the line is drawn with the objects as they are when the transfer ends, where the FIFO
+     * fetches each one when it reaches its position.
+     */
+    void setScanlineRendering(bool enable) { _scanlineRendering = enable; }
+    /// @brief Lines drawn by each renderer in the last complete frame.
+    const lineStats &getLineStats() const { return _frameLineStats; }
 
-    void mCycleUpdate(uint8_t mCycles);
+    void mCycleUpdate(uint32_t mCycles);
+    /// @brief M-cycles until the next change the CPU can observe without reading PPU registers, i.e. an interrupt.
+    uint64_t getCyclesUntilEvent() const;
     
+private:
+    static constexpr uint16_t kLCDControlRegister = 0xFF40;
+    static constexpr uint16_t kScrollRegisters = 0xFF42;
+    /// @brief BGP, OBP0, OBP1, WY and WX.
+    static constexpr uint16_t kPaletteWindowRegisters = 0xFF47;
+    static constexpr uint8_t  kMaxObjectsOnLine = 10;
+
 private:
     void sync();
+    void lcdControlWritten();
+    /// @brief A register the line is drawn with was written, the transfer in progress can't be drawn at once anymore.
+    void lineRegisterWritten();
+    /// @brief Video RAM is about to be written, the FIFO must catch up with what it would have read before.
+    void videoRAMWritten(uint16_t address);
 
     bool inWindow(uint8_t x, uint8_t y) const;
     bool inWindow(point_t point) const { return inWindow(point.x, point.y); }
@@ -115,21 +156,48 @@ private:
     
     void objectAttributeMemorySearchAction();
     void pixelTransferAction();
+    /// @brief Decide how the line is drawn as its transfer starts.
+    void beginTransfer();
+    void endTransfer();
+    /**
+     * @brief Dots the pixel FIFO takes to transfer the line, from the fetcher's timing alone.
+     *
+     * @returns 0 if the line can't be drawn at once (overlapping objects).
+     */
+    uint32_t getTransferDots() const;
+    /// @brief Draw the whole line from video RAM, OAM and the registers, as the FIFO would have.
+    void renderScanline();
+    /// @brief Run the FIFO over the dots the transfer has taken so far, and let it finish the line.
+    void fallBackToFIFO();
     void hBlankAction();
     void vBlankAction();
 
 private:
+    TileCache                      _tileCache;
     PixelFetcher                   _pixelFetcher;
     std::shared_ptr<GameboyMemory> _memory = nullptr;
     io::ppu::registers *           _registers = nullptr;
-    std::queue<uint8_t>            _backgroundPixelFifo;
-    std::queue<uint8_t>            _objectPixelFifo;
     std::optional<uint8_t>         _vblankInterruptFlag = std::nullopt;
     std::optional<uint8_t>         _statInterruptFlag = std::nullopt;
     uint32_t                       _stateMachineCycle = 0;
     uint8_t                        _currentX = 0;
     uint8_t                        _objectsOnLineCount = 0;
-    objectAttributes *             _objectsOnLine[10];
+    /// @brief Objects on the line by descending X, pointing into OAM.
+    objectAttributes *             _objectsOnLine[kMaxObjectsOnLine];
+    bool                           _lcdEnabled = false;
+    GameboyMemory::IOHookHandle    _ioHook = GameboyMemory::kInvalidIOHook;
+    GameboyMemory::IOHookHandle    _scrollHook = GameboyMemory::kInvalidIOHook;
+    GameboyMemory::IOHookHandle    _paletteWindowHook = GameboyMemory::kInvalidIOHook;
+    bool                           _scanlineRendering = true;
+    /// @brief The line in transfer is drawn at once when it ends, at `_transferStart + _transferDots`.
+    bool                           _scanlineTransfer = false;
+    uint32_t                       _transferStart = 0;
+    uint32_t                       _transferDots = 0;
+    /// @brief Palettes as the transfer started, for the FIFO to catch up with.
+    io::ppu::palettes              _transferPalettes = {};
+    lineStats                      _lineStats;
+    lineStats                      _frameLineStats;
+    FrameCallbackFn                _frameCallback = nullptr;
 };
 } // namespace emu::gameboy
 #endif /* _PPU_H_ */
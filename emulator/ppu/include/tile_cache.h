@@ -0,0 +1,62 @@
+#ifndef _TILE_CACHE_H_
+#define _TILE_CACHE_H_
+
+#include "mmu.h"
+#include "platform.h"
+
+#include <bitset>
+
+namespace emu::gameboy::detail::PixelProcessor {
+/**
+ * @brief Every tile in video RAM decoded to one color index (0-3) per pixel, as is and flipped horizontally.
+ *
+ * Tiles are decoded when first read after their 16 bytes were written, video RAM writes only mark them stale (see
+ * `GameboyMemory::setVideoRAMWriteCallback`).
+ */
+class TileCache
+{
+public:
+    /// @brief The three 128 tile blocks at 0x8000, 0x8800 and 0x9000.
+    static constexpr uint16_t kTileCount = 384;
+
+public:
+    TileCache(GameboyMemory::videoRAM *videoRam): _videoRam(videoRam) { _stale.set(); }
+
+    /**
+     * @brief Index of a tile in the cache.
+     *
+     * @param[in] signedIds True for the 0x8800 addressing mode, where IDs 0-127 are the tiles at 0x9000.
+     */
+    static uint16_t getTileIndex(uint8_t tileId, bool signedIds)
+    {
+        return signedIds ? static_cast<uint16_t>(256 + static_cast<int8_t>(tileId)) : tileId;
+    }
+    /// @brief The 8 color indices of a row of `tile`, left to right.
+    const uint8_t *getRow(uint16_t tile, uint8_t row, bool flipX)
+    {
+        if (expect_false(_stale[tile]))
+        {
+            decode(tile);
+        }
+        return _pixels[tile][flipX][row & 0x7];
+    }
+    /// @brief Called for every video RAM write, writes to the tile maps don't affect the cache.
+    void written(uint16_t address)
+    {
+        uint16_t offset = address - 0x8000;
+        require_or(offset < sizeof(_videoRam->tiledata), return);
+        _stale.set(offset >> 4);
+    }
+    void invalidate() { _stale.set(); }
+
+private:
+    void decode(uint16_t tile);
+
+private:
+    GameboyMemory::videoRAM *  _videoRam = nullptr;
+    std::bitset<kTileCount>    _stale;
+    alignas(8) uint8_t         _pixels[kTileCount][2][8][8];
+};
+} // namespace emu::gameboy::detail::PixelProcessor
+
+#endif /* _TILE_CACHE_H_ */
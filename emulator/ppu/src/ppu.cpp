@@ -1,4 +1,5 @@
 #include "ppu.h"
+#include "hal_pixel.h"
 
 #define kPPUCyclesOAMSearch 80ul
 #define kPPUCyclesPerLine 456ul
@@ -9,7 +10,7 @@ using namespace emu::gameboy;
 using namespace emu::gameboy::detail::PixelProcessor;
 using namespace emu::gameboy::io::ppu;
 
-PixelFetcher::PixelFetcher(std::shared_ptr<GameboyMemory> memory)
+PixelFetcher::PixelFetcher(std::shared_ptr<GameboyMemory> memory, TileCache *tileCache): _tileCache(tileCache)
 {
     _videoRam = memory->getVideoRAM();
     reset(config_t {
@@ -63,26 +64,19 @@ PixelFetcher::update()
         break;
     case state::getDataLow:
     {
-        uint8_t index, tile_id;
-        uint8_t *tile_bytes;
+        const uint8_t *pixels;
         if (_object)
         {
             uint8_t tile_row = (_object->flags.flipY) ? 7 - _objectRow : _objectRow;
-            index = getTileDataIndex(tile_row);
-            assert(index < 16);
-            tile_id = _object->tileId;
-            tile_bytes = _videoRam->tiledata[0][tile_id];
+            pixels = _tileCache->getRow(_object->tileId, tile_row, _object->flags.flipX);
         }
         else
         {
-            index = getTileDataIndex(_currentPixel.y);
-            assert(index < 16);
-            tile_id = _info.tileId;
-            tile_bytes = (_config.tiledataId == lcd::tiledata::block0) ?
-                _videoRam->tiledata[2][static_cast<int8_t>(tile_id)] : _videoRam->tiledata[0][tile_id];
+            bool signedIds = (_config.tiledataId == lcd::tiledata::block0);
+            pixels = _tileCache->getRow(TileCache::getTileIndex(_info.tileId, signedIds), _currentPixel.y, false);
         }
-        _info.data.lo = tile_bytes[index];
-        _info.data.hi = tile_bytes[index + 1];
+        /// Copied, like the tile bytes would be, in case the tile is written before the pixels are pushed.
+        memcpy(_info.pixels, pixels, sizeof(_info.pixels));
         _state = state::getDataHigh;
         break;
     }
@@ -99,13 +93,13 @@ PixelFetcher::update()
         if (_object)
         {
             require_or(_objectQueue.size() <= 8, break);
-            insertPixels(&_objectQueue, _object->flags.priority, _object->flags.palette, _object->flags.flipX, false);
+            insertPixels(&_objectQueue, _object->flags.priority, _object->flags.palette, false);
             _object = NULL;
         }
         else
         {
             require_or(_backgroundQueue.size() <= 8, break);
-            insertPixels(&_backgroundQueue, 0, 0, false, true);
+            insertPixels(&_backgroundQueue, 0, 0, true);
             _currentPixel.x += 8;
         }
         _state = state::getTileID;
@@ -128,22 +122,14 @@ PixelFetcher::getTileId(lcd::tilemap tilemapBlock, uint8_t x, uint8_t y)
     return _videoRam->tilemap[idx][y >> 3][x >> 3];
 }
 
-uint8_t 
-PixelFetcher::getTileDataIndex(uint8_t positionY)
-{
-    return (positionY & 0x7) << 1;
-}
-
 void 
-PixelFetcher::insertPixels(circular_queue<PixelFetcher::pixelInfo, 16> *queue, uint8_t priority, uint8_t palette, bool flipX, bool isBgPixel)
+PixelFetcher::insertPixels(circular_queue<PixelFetcher::pixelInfo, 16> *queue, uint8_t priority, uint8_t palette, bool isBgPixel)
 {
     assert(queue);
     for (uint8_t i = 0; i < 8; i++)
     {
-        uint8_t x = (flipX) ? i : 7 - i;
-        uint8_t encoding = (get_bit(_info.data.hi, x) << 1) | get_bit(_info.data.lo, x);
         pixelInfo pixel = {
-            .encoding = encoding,
+            .encoding = _info.pixels[i],
             .isBgPixel = isBgPixel,
             .objectPalette = palette,
             .priority = priority
@@ -152,16 +138,30 @@ PixelFetcher::insertPixels(circular_queue<PixelFetcher::pixelInfo, 16> *queue, u
     }
 }
 
-PixelProcessor::PixelProcessor(shared_ptr<GameboyMemory> memory): _pixelFetcher(memory), _memory(memory)
+PixelProcessor::PixelProcessor(shared_ptr<GameboyMemory> memory):
+    _tileCache(memory->getVideoRAM()), _pixelFetcher(memory, &_tileCache), _memory(memory)
 {
+    _memory->setVideoRAMWriteCallback([this](uint16_t address) { videoRAMWritten(address); });
     _registers = &_memory->getIORegisters()->ppu;
     _registers->y.coordinate = 0;
     _registers->lcdStatus.mode = lcd::mode::searchingObjectAttributeMemory;
+    _lcdEnabled = _registers->lcdControl.enable;
+    _ioHook = _memory->registerIOWriteHook(kLCDControlRegister, [this](uint16_t, uint8_t) { lcdControlWritten(); });
+    _scrollHook = _memory->registerIOWriteHook(kScrollRegisters, [this](uint16_t, uint8_t) { lineRegisterWritten(); },
+                                               sizeof(scroll));
+    _paletteWindowHook = _memory->registerIOWriteHook(kPaletteWindowRegisters, 
+                                                      [this](uint16_t, uint8_t) { lineRegisterWritten(); },
+                                                      sizeof(palettes) + sizeof(window));
     sync();
 }
 
 PixelProcessor::~PixelProcessor()
-{ }
+{
+    _memory->deregisterIOHook(_ioHook);
+    _memory->deregisterIOHook(_scrollHook);
+    _memory->deregisterIOHook(_paletteWindowHook);
+    _memory->setVideoRAMWriteCallback(nullptr);
+}
 
 void
 PixelProcessor::reset()
@@ -180,6 +180,7 @@ PixelProcessor::reset()
     _registers->y.coordinate = 0;
     _registers->lcdStatus.mode = lcd::mode::searchingObjectAttributeMemory;
     _objectsOnLineCount = 0;
+    _scanlineTransfer = false;
     sync();
 }
 
@@ -222,6 +223,37 @@ PixelProcessor::setBGWindowTileDataArea(lcd::tiledata block)
     _registers->lcdControl.backgroundWindowTiledataArea = block;
 }
 
+void
+PixelProcessor::lcdControlWritten()
+{
+    lineRegisterWritten();
+    bool enabled = _registers->lcdControl.enable;
+    require_or(enabled != _lcdEnabled, return);
+    _lcdEnabled = enabled;
+    /// The LCD stops with LY at 0 in HBlank, and starts over from the top of the frame when turned back on.
+    _stateMachineCycle = 0;
+    _currentX = 0;
+    _objectsOnLineCount = 0;
+    _scanlineTransfer = false;
+    _registers->y.coordinate = 0;
+    _registers->lcdStatus.mode = enabled ? lcd::mode::searchingObjectAttributeMemory : lcd::mode::hBlank;
+}
+
+void
+PixelProcessor::lineRegisterWritten()
+{
+    /// The write synchronized the PPU first, the transfer has run up to the dot it happened on.
+    require_or(_scanlineTransfer && (_registers->lcdStatus.mode == lcd::mode::transferringToLcd), return);
+    fallBackToFIFO();
+}
+
+void
+PixelProcessor::videoRAMWritten(uint16_t address)
+{
+    lineRegisterWritten();
+    _tileCache.written(address);
+}
+
 uint8_t
 PixelProcessor::getCurrentRow() const
 {
@@ -230,13 +262,33 @@ PixelProcessor::getCurrentRow() const
 }
 
 void 
-PixelProcessor::mCycleUpdate(uint8_t mCycles)
+PixelProcessor::mCycleUpdate(uint32_t mCycles)
 {
     /// @todo shouldn't hard-code `4 *` here (based on CPU speed setting)
-    uint16_t dotCycles = 4 * mCycles;
+    uint64_t dotCycles = 4ull * mCycles;
     while (dotCycles--)
     {
         require_or(_registers->lcdControl.enable, return);
+        auto mode = _registers->lcdStatus.mode;
+        /// Blanking does nothing until the end of the line, and a transfer drawn at once nothing until it ends.
+        uint32_t actionCycle = 0;
+        if ((mode == lcd::mode::hBlank) || (mode == lcd::mode::vBlank))
+        {
+            actionCycle = kPPUCyclesPerLine;
+        }
+        else if ((mode == lcd::mode::transferringToLcd) && _scanlineTransfer)
+        {
+            actionCycle = _transferStart + _transferDots;
+        }
+        if (_stateMachineCycle + 1 < actionCycle)
+        {
+            /// Catch up to the next dot that does something in one step.
+            uint64_t idleCycles = emu::min(dotCycles + 1, actionCycle - 1 - _stateMachineCycle);
+            _stateMachineCycle += idleCycles;
+            dotCycles -= idleCycles - 1;
+            sync();
+            continue;
+        }
         _stateMachineCycle++;
         switch (_registers->lcdStatus.mode)
         {
@@ -262,6 +314,41 @@ PixelProcessor::mCycleUpdate(uint8_t mCycles)
     }
 }
 
+uint64_t
+PixelProcessor::getCyclesUntilEvent() const
+{
+    require_or(_registers->lcdControl.enable, return UINT64_MAX);
+    auto &status = _registers->lcdStatus;
+    bool lycIsTrue = (_registers->y.coordinate == _registers->y.compare);
+    /// STAT sources are level triggered in `sync`, keep stepping while one of them is asserted.
+    if ((status.lycInterruptMode && lycIsTrue && (status.lycEqualsLY == false))                 ||
+        (status.oamInterruptMode && (status.mode == lcd::mode::searchingObjectAttributeMemory)) ||
+        (status.vblankInterruptMode && (status.mode == lcd::mode::vBlank))                      ||
+        (status.hblankInterruptMode && (status.mode == lcd::mode::hBlank)))
+    {
+        return 1;
+    }
+
+    /// LY, VBlank and the OAM/VBlank modes only change at the end of a line, which needs HBlank to have started.
+    int64_t dots = static_cast<int64_t>(kPPUCyclesPerLine) - _stateMachineCycle;
+    if ((status.mode == lcd::mode::searchingObjectAttributeMemory) || (status.mode == lcd::mode::transferringToLcd))
+    {
+        /// Transfer outputs at most one pixel per dot, a line drawn at once knows when it ends.
+        int64_t hblankDots = static_cast<int64_t>(HAL_DisplayGetSizeX()) - _currentX;
+        if (_scanlineTransfer && (status.mode == lcd::mode::transferringToLcd))
+        {
+            hblankDots = static_cast<int64_t>(_transferStart + _transferDots) - _stateMachineCycle;
+        }
+        if (status.mode == lcd::mode::searchingObjectAttributeMemory)
+        {
+            hblankDots += static_cast<int64_t>(kPPUCyclesOAMSearch) - _stateMachineCycle;
+        }
+        dots = status.hblankInterruptMode ? hblankDots : std::max(dots, hblankDots + 1);
+    }
+    require_or(dots > 0, return 1);
+    return static_cast<uint64_t>((dots + 3) / 4);
+}
+
 void
 PixelProcessor::sync()
 {
@@ -317,9 +404,7 @@ PixelProcessor::sortObjectQueue(void)
             maxIdx = j;
         }
         require_or(maxIdx != i, continue);
-        // only works if objectAttributes is 4 bytes
-        static_assert(sizeof(*_objectsOnLine[0]) == 4);
-        swap(*reinterpret_cast<uint32_t *>(_objectsOnLine[maxIdx]), *reinterpret_cast<uint32_t *>(_objectsOnLine[i]));
+        std::swap(_objectsOnLine[maxIdx], _objectsOnLine[i]);
     }
 }
 
@@ -328,11 +413,9 @@ PixelProcessor::objectAttributeMemorySearchAction()
 {
     assert(_registers);
     assert(_registers->lcdStatus.mode == lcd::mode::searchingObjectAttributeMemory);
-    if (_stateMachineCycle & 1)
+    if ((_stateMachineCycle & 1) && (_objectsOnLineCount < kMaxObjectsOnLine))
     {
-        uint8_t index = _stateMachineCycle >> 1;
-        
-        auto attr = (*_memory->getObjectAttributeMemory())[_stateMachineCycle >> 1];
+        auto &attr = (*_memory->getObjectAttributeMemory())[_stateMachineCycle >> 1];
         const uint8_t objectHeight = (_registers->lcdControl.objectSize == lcd::objectSize::standard) ? 8 : 16;
         if ((attr.position.x != 0) &&
             in_range(_registers->y.coordinate + 16, attr.position.y, attr.position.y + objectHeight))
@@ -352,14 +435,161 @@ PixelProcessor::objectAttributeMemorySearchAction()
         });
         _registers->lcdStatus.mode = lcd::mode::transferringToLcd;
         sortObjectQueue();
+        beginTransfer();
     }
 }
 
+void
+PixelProcessor::beginTransfer()
+{
+    _transferStart = _stateMachineCycle;
+    _transferDots = _scanlineRendering ? getTransferDots() : 0;
+    _scanlineTransfer = (_transferDots > 0);
+    _transferPalettes = _registers->palettes;
+}
+
+void
+PixelProcessor::endTransfer()
+{
+    _currentX = 0;
+    _objectsOnLineCount = 0;
+    _registers->lcdStatus.mode = lcd::mode::hBlank;
+    if (_scanlineTransfer)
+    {
+        _lineStats.scanline++;
+    }
+    else
+    {
+        _lineStats.fifo++;
+    }
+    _scanlineTransfer = false;
+}
+
+uint32_t
+PixelProcessor::getTransferDots() const
+{
+    /// Objects are fetched from the lowest X up. Objects whose pixels overlap share the object queue in ways only
+    /// the FIFO gets right.
+    int8_t next = static_cast<int8_t>(_objectsOnLineCount) - 1;
+    for (int8_t i = next; i > 0; i--)
+    {
+        require_or(_objectsOnLine[i]->position.x >= 8, break);
+        require_or(_objectsOnLine[i - 1]->position.x >= (_objectsOnLine[i]->position.x + 8), return 0);
+    }
+
+    /// `PixelFetcher::update` and `pixelTransferAction` with nothing but the queue sizes.
+    enum { getTileID, getDataLow, getDataHigh, push } state = getTileID;
+    const uint16_t width = HAL_DisplayGetSizeX();
+    uint8_t  backgroundPixels = 0, objectPixels = 0, x = 0;
+    bool     fetchingObject = false;
+    for (uint32_t dots = 1; dots < (kPPUCyclesPerLine - kPPUCyclesOAMSearch); dots++)
+    {
+        switch (state)
+        {
+        case getTileID:
+            state = getDataLow;
+            break;
+        case getDataLow:
+            state = getDataHigh;
+            break;
+        case getDataHigh:
+            state = push;
+            break;
+        case push:
+        {
+            uint8_t &queued = fetchingObject ? objectPixels : backgroundPixels;
+            require_or(queued <= 8, break);
+            queued += 8;
+            fetchingObject = false;
+            state = getTileID;
+            break;
+        }
+        }
+        require_or((backgroundPixels >= 8) && !fetchingObject, continue);
+        if ((next >= 0) && ((x + 8) == _objectsOnLine[next]->position.x))
+        {
+            fetchingObject = true;
+            state = getDataLow;
+            next--;
+            continue;
+        }
+        backgroundPixels--;
+        objectPixels -= (objectPixels > 0);
+        require_or(++x == width, continue);
+        return dots;
+    }
+    return 0;
+}
+
+void
+PixelProcessor::renderScanline()
+{
+    const uint16_t width = emu::min<uint16_t>(HAL_DisplayGetSizeX(), kConfigScreenPixelsX);
+    const uint8_t row = _registers->y.coordinate;
+    const palettes &pal = _registers->palettes;
+    auto videoRam = _memory->getVideoRAM();
+    /// Rounded up to whole tiles, the palette is applied to the whole line at once.
+    uint8_t indices[kConfigScreenPixelsX + 7];
+    /// Drawn straight into the frame the display isn't showing.
+    uint8_t *line = HAL_DisplayGetLine(row);
+    require_or(line, return);
+
+    /// Background, from tile 0 of the map row the fetcher starts the line at.
+    const uint8_t y = row + _registers->scroll.y;
+    const uint8_t *tileIds = videoRam->tilemap[static_cast<uint8_t>(_registers->lcdControl.backgroundTileMapArea)][y >> 3];
+    const bool signedTileIds = (_registers->lcdControl.backgroundWindowTiledataArea == lcd::tiledata::block0);
+    for (uint16_t x = 0; x < width; x += 8)
+    {
+        memcpy(&indices[x], _tileCache.getRow(TileCache::getTileIndex(tileIds[x >> 3], signedTileIds), y, false), 8);
+    }
+    HAL_PixelApplyPalette(indices, pal.monochrome, line, width);
+
+    /// Objects in the order the FIFO fetches them, up to one it never reaches.
+    for (int8_t i = static_cast<int8_t>(_objectsOnLineCount) - 1; i >= 0; i--)
+    {
+        const objectAttributes *object = _objectsOnLine[i];
+        require_or(in_range(object->position.x, 8, width + 8), break);
+        uint8_t objectRow = row - object->position.y;
+        uint8_t tileRow = object->flags.flipY ? 7 - objectRow : objectRow;
+        const uint8_t *pixels = _tileCache.getRow(object->tileId, tileRow, object->flags.flipX);
+        const uint8_t left = object->position.x - 8;
+        uint8_t colors[8];
+        HAL_PixelApplyPalette(pixels, pal.object[object->flags.palette], colors, 8);
+        for (uint8_t j = 0; (j < 8) && ((left + j) < width); j++)
+        {
+            require_or(pixels[j] && (object->flags.priority == 0), continue);
+            line[left + j] = colors[j];
+        }
+    }
+}
+
+void
+PixelProcessor::fallBackToFIFO()
+{
+    _scanlineTransfer = false;
+    /// Nothing was drawn yet. The FIFO reads the palettes as it goes, so it catches up with the ones it would have.
+    palettes written = _registers->palettes;
+    _registers->palettes = _transferPalettes;
+    for (uint32_t dot = _transferStart; dot < _stateMachineCycle; dot++)
+    {
+        pixelTransferAction();
+    }
+    _registers->palettes = written;
+    assert(_registers->lcdStatus.mode == lcd::mode::transferringToLcd);
+}
+
 void
 PixelProcessor::pixelTransferAction(void)
 {
     assert(_registers && _registers->lcdStatus.mode == lcd::mode::transferringToLcd);
     const uint16_t max_pixel_x = HAL_DisplayGetSizeX();
+    if (_scanlineTransfer)
+    {
+        require_or(_stateMachineCycle - _transferStart >= _transferDots, return);
+        renderScanline();
+        endTransfer();
+        return;
+    }
 
     _pixelFetcher.update();
 
@@ -377,7 +607,6 @@ PixelProcessor::pixelTransferAction(void)
         return;
     }
 
-    HAL_DisplayReserve();
     auto pixel = bgQueue->dequeue();
     auto objQueue = _pixelFetcher.getObjectQueue();
     if (objQueue->size() > 0)
@@ -391,14 +620,10 @@ PixelProcessor::pixelTransferAction(void)
 
     HAL_DisplaySetPixel(_currentX, _registers->y.coordinate, colorPaletteToValue(pixel));
     _currentX++;
-    HAL_DisplayRelease();
 
     if (_currentX == max_pixel_x)
     {
-        _currentX = 0;
-        _objectsOnLineCount = 0;
-        HAL_DisplaySetReady(true);
-        _registers->lcdStatus.mode = lcd::mode::hBlank;
+        endTransfer();
     }
 }
 
@@ -416,6 +641,13 @@ PixelProcessor::hBlankAction()
         _registers->lcdStatus.mode = lcd::mode::vBlank;
         assert(_vblankInterruptFlag != nullopt);
         _memory->requestInterrupt(*_vblankInterruptFlag);
+        HAL_DisplayPublish();
+        _frameLineStats = _lineStats;
+        _lineStats = {};
+        if (_frameCallback)
+        {
+            _frameCallback();
+        }
     }
     else
     {
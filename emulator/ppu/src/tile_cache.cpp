@@ -0,0 +1,11 @@
+#include "tile_cache.h"
+#include "hal_pixel.h"
+
+using namespace emu::gameboy::detail::PixelProcessor;
+
+void
+TileCache::decode(uint16_t tile)
+{
+    HAL_PixelDecodeTile(_videoRam->tiledata[tile >> 7][tile & 0x7F], _pixels[tile][0][0], _pixels[tile][1][0]);
+    _stale.reset(tile);
+}
@@ -22,7 +22,9 @@ public:
     GameboyTimer(std::shared_ptr<GameboyMemory> memory, uint8_t interruptFlag);
     ~GameboyTimer();
     
-    void mCycleUpdate(uint8_t mCycles);
+    void mCycleUpdate(uint32_t mCycles);
+    /// @brief M-cycles until the counter overflows and raises its interrupt.
+    uint64_t getCyclesUntilEvent() const;
 
 private:
     static uint64_t convertClockSelectToCount(uint8_t clockSelect);
@@ -33,7 +35,7 @@ private:
     uint64_t                        _absoluteCounter = 256ull;
     uint8_t                         _dividerCounter = 0;
     uint8_t                         _timerExpiredInterruptFlag = 0;
-    uint8_t                         _ioSignalerId = 0;
+    GameboyMemory::IOHookHandle     _ioHook = GameboyMemory::kInvalidIOHook;
 };
 } // namespace emu::gameboy
 
@@ -11,7 +11,7 @@ GameboyTimer::GameboyTimer(shared_ptr<GameboyMemory> memory, uint8_t interruptFl
     uint8_t clockSelect = _registers->control.clockSelect;
     _absoluteCounter = convertClockSelectToCount(clockSelect);
     
-    auto registerWriteOccured = [&](uint16_t address, __unused optional<uint8_t>) {
+    auto registerWriteOccured = [&](uint16_t address, __unused uint8_t) {
         switch (address)
         {
         case kDividerRegister:
@@ -26,26 +26,23 @@ GameboyTimer::GameboyTimer(shared_ptr<GameboyMemory> memory, uint8_t interruptFl
             assert(0);
         }
     };
-    _ioSignalerId = _memory->registerIOSignaler(registerWriteOccured, kDividerRegister, 0xFFFC);
+    _ioHook = _memory->registerIOWriteHook(kDividerRegister, registerWriteOccured, kControlRegister - kDividerRegister + 1);
 }
 
 GameboyTimer::~GameboyTimer()
 { 
-    _memory->deregisterIOSignaler(_ioSignalerId);
+    _memory->deregisterIOHook(_ioHook);
 }
 
 void 
-GameboyTimer::mCycleUpdate(uint8_t mCycles)
+GameboyTimer::mCycleUpdate(uint32_t mCycles)
 {
     const uint8_t dividerMaxValue = kConfigMCycleHz(kConfigSingleSpeedMode) / 16384;
     
     // Divider logic
-    _dividerCounter += mCycles;
-    if (_dividerCounter >= dividerMaxValue)
-    {
-        _dividerCounter -= dividerMaxValue;
-        _registers->divider++;
-    }
+    uint32_t dividerCount = _dividerCounter + mCycles;
+    _registers->divider += static_cast<uint8_t>(dividerCount / dividerMaxValue);
+    _dividerCounter = static_cast<uint8_t>(dividerCount % dividerMaxValue);
     
     // Counter logic
     require_or(_registers->control.enable, return);
@@ -64,6 +61,14 @@ double_expire:
     require_or((_absoluteCounter != 0) && (_absoluteCounter <= countMaxValue), goto double_expire);
 }
 
+uint64_t
+GameboyTimer::getCyclesUntilEvent() const
+{
+    require_or(_registers->control.enable, return UINT64_MAX);
+    const uint64_t countMaxValue = convertClockSelectToCount(_registers->control.clockSelect);
+    return _absoluteCounter + ((0xFF - _registers->counter) * countMaxValue);
+}
+
 /* static */
 uint64_t 
 GameboyTimer::convertClockSelectToCount(uint8_t clockSelect)
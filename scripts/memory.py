@@ -1,9 +1,17 @@
 import argparse
+import mmap
+import struct
+import time
 
 GAMEBOY_MEMORY_OFFSETS = [
     { "name": "ROM Bank 00", "offset": 0, "length": 16 * (1 << 10) },
 ]
 
+# Layout of `liveViewHeader` (emulator/mmu/include/view.h)
+LIVE_VIEW_HEADER = struct.Struct("<8sIIIIQQ")
+LIVE_VIEW_MAGIC = b"GBVIEW\0\0"
+LIVE_VIEW_SEQUENCE_OFFSET = 20
+
 class GameboyMemory:
     def __read_number__(raw: bytearray, address: int, size: int) -> int:
         return int.from_bytes(raw[address:address+size], 'little')
@@ -19,15 +27,59 @@ class GameboyMemory:
         self.__parse_reset_vectors__(raw)
 
 
+class LiveGameboyMemory:
+    """Memory of a running emulator started with `-m name`, read in place from its shared memory segment."""
+
+    def __init__(self, name):
+        with open("/dev/shm/" + name.lstrip("/"), "rb") as file:
+            self.segment = mmap.mmap(file.fileno(), 0, access=mmap.ACCESS_READ)
+        magic, version, self.memory_offset, self.memory_size, _, _, _ = LIVE_VIEW_HEADER.unpack_from(self.segment)
+        if magic != LIVE_VIEW_MAGIC or version != 1:
+            raise ValueError("{} isn't a gameboy memory view".format(name))
+        # Memory is live, slicing the view copies only what is read.
+        self.memory = memoryview(self.segment)[self.memory_offset:self.memory_offset + self.memory_size]
+
+    def stamp(self) -> tuple:
+        """Frame counter and M-cycle count of the last completed frame, read under the header's seqlock."""
+        while True:
+            before = struct.unpack_from("<I", self.segment, LIVE_VIEW_SEQUENCE_OFFSET)[0]
+            frame, cycles = struct.unpack_from("<QQ", self.segment, LIVE_VIEW_SEQUENCE_OFFSET + 4)
+            after = struct.unpack_from("<I", self.segment, LIVE_VIEW_SEQUENCE_OFFSET)[0]
+            if before == after and not before & 1:
+                return frame, cycles
+
+    def read(self, address: int, length: int) -> bytes:
+        return bytes(self.memory[address:address + length])
+
+
+def watch(name: str, address: int, length: int):
+    live = LiveGameboyMemory(name)
+    last_frame = None
+    while True:
+        frame, cycles = live.stamp()
+        if frame != last_frame:
+            print("frame {} cycles {}: {}".format(frame, cycles, live.read(address, length).hex()))
+            last_frame = frame
+        time.sleep(1 / 120)
+
+
 def main():
     parser = argparse.ArgumentParser()
     parser.add_argument("-i", "--input_file", help="Path to gameboy memory dump")
+    parser.add_argument("--shm", help="Name of a running emulator's shared memory view (gameboy -m)")
+    parser.add_argument("--address", type=lambda value: int(value, 0), default=0xC000,
+                        help="Start of the range printed every frame with --shm")
+    parser.add_argument("--length", type=lambda value: int(value, 0), default=16)
     args = parser.parse_args()
 
+    if args.shm:
+        watch(args.shm, args.address, args.length)
+        return 0
+
     gameboy_mem = GameboyMemory(args.input_file)
     print(gameboy_mem.reset_vectors)
 
     return 0
 
 if __name__ == "__main__":
-    main()
\ No newline at end of file
+    main()
@@ -7,12 +7,25 @@
 #include "timer.h"
 #include "Emulator.hpp"
 
+#include <chrono>
 #include <thread>
 
 using namespace std;
 using namespace emu::gameboy;
 
 const char *gameFilename = nullptr;
+const char *bootROMFilename = kConfigStartupCodeFile;
+uint64_t    benchmarkInstructions = 0;
+bool        useRecompiler = false;
+bool        useThreaded = false;
+bool        skipIdleLoops = true;
+bool        fuseInstructions = true;
+bool        saveRAM = true;
+bool        scanlineRendering = true;
+const char *traceFilename = nullptr;
+const char *sharedMemoryName = nullptr;
+const char *heatmapFilename = nullptr;
+bool        heatmapEveryFrame = false;
 int         systemExitStatus = 1;
 
 unique_ptr<emu::Emulator> emulator; 
@@ -55,16 +68,110 @@ main(int argc, char **argv)
     while (true)
     {
         int opt = 0;
-        require_or((opt = getopt(argc, argv, "g:")) != -1, break);
+        require_or((opt = getopt(argc, argv, "g:b:jTt:IFB:fSm:H:h:R")) != -1, break);
         switch (opt)
         {
         case 'g':
             gameFilename = optarg;
             break;
+        case 'b':
+            benchmarkInstructions = strtoull(optarg, nullptr, 0);
+            break;
+        case 'j':
+            useRecompiler = true;
+            break;
+        case 'T':
+            useThreaded = true;
+            break;
+        case 't':
+            traceFilename = optarg;
+            break;
+        case 'I':
+            skipIdleLoops = false;
+            break;
+        case 'F':
+            fuseInstructions = false;
+            break;
+        case 'B':
+            bootROMFilename = optarg;
+            break;
+        case 'f':
+            /// Fast start, skip the boot ROM.
+            bootROMFilename = nullptr;
+            break;
+        case 'S':
+            saveRAM = false;
+            break;
+        case 'R':
+            /// Draw every line through the pixel FIFO.
+            scanlineRendering = false;
+            break;
+        case 'm':
+            /// Live view of guest memory for external tools, see `scripts/memory.py --shm`.
+            sharedMemoryName = optarg;
+            break;
+        case 'H':
+        case 'h':
+            /// Memory access heatmap for the whole run, or for every frame.
+            heatmapFilename = optarg;
+            heatmapEveryFrame = (opt == 'h');
+            break;
         }
     }
     require_or(gameFilename, log_error("No game file specified!"); exit(1));
-    require_or(emulator->Activate(gameFilename), return 1);
+    if (sharedMemoryName)
+    {
+        require_or(emulator->ShareMemory(sharedMemoryName), return 1);
+    }
+    require_or(emulator->Activate(gameFilename, bootROMFilename), return 1);
+    if (saveRAM)
+    {
+        /// Fails quietly for cartridges without a battery.
+        emulator->LoadSaveFile();
+    }
+    if (useRecompiler)
+    {
+        require_or(emulator->SetCpuBackend(CentralProcessor::backend::recompiler), 
+                   log_error("Falling back to the interpreter."));
+    }
+    else if (useThreaded)
+    {
+        require_or(emulator->SetCpuBackend(CentralProcessor::backend::threaded), 
+                   log_error("Falling back to the interpreter."));
+    }
+    emulator->SetIdleLoopSkipping(skipIdleLoops);
+    emulator->SetInstructionFusion(fuseInstructions);
+    emulator->SetScanlineRendering(scanlineRendering);
+    if (heatmapFilename)
+    {
+        require_or(emulator->RecordHeatmap(heatmapFilename, heatmapEveryFrame), log_error("Not recording the heatmap."));
+    }
+    if (traceFilename)
+    {
+        require_or(emulator->StreamTrace(traceFilename), log_error("Not streaming the instruction trace."));
+    }
+
+    // Headless benchmark, run a fixed number of instructions and report instructions per second
+    if (benchmarkInstructions)
+    {
+        auto start = chrono::steady_clock::now();
+        while (emulator->GetInstructionCount() < benchmarkInstructions)
+        {
+            emulator->Run();
+        }
+        chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+        uint64_t instructions = emulator->GetInstructionCount();
+        printf("%llu instructions in %.3fs, %.0f instructions/s\n", static_cast<unsigned long long>(instructions), 
+               elapsed.count(), instructions / elapsed.count());
+        auto &idleLoops = emulator->GetIdleLoopStats();
+        printf("%llu idle loops skipped, %llu instructions and %llu M-cycles not executed\n", 
+               static_cast<unsigned long long>(idleLoops.skips), static_cast<unsigned long long>(idleLoops.instructions),
+               static_cast<unsigned long long>(idleLoops.mCycles));
+        auto &lines = emulator->GetLineStats();
+        printf("last frame: %u lines drawn at once, %u through the pixel FIFO\n", lines.scanline, lines.fifo);
+        systemExitStatus = 0;
+        exit(0);
+    }
     
     thread emulatorMainLoop([&]() -> void {
         uint32_t audio_device_status = HAL_AudioDeviceInit();
@@ -0,0 +1,233 @@
+/**
+ * @file backend_check.cpp
+ * @brief Differential check of the CPU backends with the whole system running.
+ *
+ * usage: bin/backend_check [-c M-cycles] [game files...]
+ *
+ * Every ROM runs on each backend the host supports, with the PPU, timer and DMA ticking as they do in the emulator.
+ * The interrupts and halt wake-ups recorded in their traces must match the interpreter's: same M-cycle, same
+ * registers. The small ROMs built in here always run first, each reproduces a backend bug found before. Games start
+ * without the boot ROM.
+ */
+#include "Emulator.hpp"
+#include "hal.h"
+
+#include <vector>
+
+using namespace std;
+using namespace emu::gameboy;
+using namespace emu::gameboy::detail::cpu;
+using emu::gameboy::instruction::instructionSet;
+
+int systemExitStatus = 1;
+
+/// @brief A trace record of an interrupt or halt, which every backend leaves the same way.
+struct event
+{
+    uint64_t mCycle;
+    uint16_t programCounter;
+    uint16_t stackPointer;
+    uint16_t af;
+    uint16_t bc;
+    uint16_t de;
+    uint16_t hl;
+    uint8_t  opcode;
+
+    bool operator==(const event &) const = default;
+};
+
+struct run
+{
+    vector<event> events;
+    /// Oldest M-cycle still in the trace, earlier events were overwritten
+    uint64_t      firstCycle = 0;
+};
+
+struct builtinROM
+{
+    const char *            name;
+    /// Code placed at 0x0150, the cartridge jumps there from its entry point
+    vector<uint8_t>         code;
+    /// Interrupt handlers, RETI at each vector
+    bool                    returnFromInterrupts;
+};
+
+static const builtinROM kBuiltinROMs[] = {
+    /// HALT with IME=0 wakes in the interpreter, which must leave the threaded interpreter a block it can run.
+    { "halt with interrupts disabled",
+      { 0xF3,                       /// DI
+        0x3E, 0x01, 0xE0, 0xFF,     /// LD A,1; LDH (IE),A
+        0xAF, 0xE0, 0x0F,           /// loop: XOR A; LDH (IF),A
+        0x76, 0x00,                 /// HALT; NOP
+        0x40, 0x49,                 /// LD B,B; LD C,C
+        0x18, 0xF7 },               /// JR loop
+      false },
+    /// VBlank must interrupt a long straight-line block at the same instruction in every backend.
+    { "interrupt inside a block",
+      [] {
+          vector<uint8_t> code = { 0x3E, 0x01, 0xE0, 0xFF,  /// LD A,1; LDH (IE),A
+                                   0xAF, 0xE0, 0x0F,        /// XOR A; LDH (IF),A
+                                   0xFB };                  /// EI
+          code.insert(code.end(), 24, 0x03);                /// loop: INC BC x24
+          code.insert(code.end(), { 0x18, 0xE6 });          /// JR loop
+          return code;
+      }(),
+      true },
+};
+
+/// @brief Write a 32 KB ROM only cartridge holding `rom` into a temporary file.
+static bool
+writeBuiltinROM(const builtinROM &rom, char *filename)
+{
+    vector<uint8_t> image(detail::GameboyMemory::ROMImage::kMinimumSize, 0);
+    for (uint16_t address = 0x40; rom.returnFromInterrupts && address <= 0x60; address += 8)
+    {
+        image[address] = 0xD9;
+    }
+    /// NOP; JP 0x0150
+    const uint8_t entry[] = { 0x00, 0xC3, 0x50, 0x01 };
+    memcpy(&image[0x100], entry, sizeof(entry));
+    memcpy(&image[0x150], rom.code.data(), rom.code.size());
+
+    int fd = mkstemp(filename);
+    require_or(fd >= 0, log_error("Failed to create %s (%s)", filename, strerror(errno)); return false);
+    bool written = (write(fd, image.data(), image.size()) == static_cast<ssize_t>(image.size()));
+    close(fd);
+    require_or(written, log_error("Failed to write %s", filename); unlink(filename); return false);
+    return true;
+}
+
+/// @brief Run a ROM for `mCycles` with one backend, and collect the events of its trace.
+static bool
+runROM(const char *romFilename, CentralProcessor::backend backend, bool fusion, uint64_t mCycles, run &out)
+{
+    char traceFilename[] = "/tmp/backend_check_XXXXXX";
+    int fd = mkstemp(traceFilename);
+    require_or(fd >= 0, log_error("Failed to create %s (%s)", traceFilename, strerror(errno)); return false);
+    close(fd);
+    {
+        /// The trace is flushed when the emulator is destroyed.
+        emu::Emulator emulator(emu::Emulator::Type::gameboy);
+        bool started = emulator.Activate(romFilename, nullptr) && emulator.SetCpuBackend(backend) &&
+                       emulator.StreamTrace(traceFilename);
+        require_or(started, unlink(traceFilename); return false);
+        emulator.SetIdleLoopSkipping(false);
+        emulator.SetInstructionFusion(fusion);
+        while (emulator.GetCycleCount() < mCycles)
+        {
+            emulator.Run();
+        }
+    }
+
+    TraceFile trace;
+    bool opened = trace.open(traceFilename);
+    unlink(traceFilename);
+    require_or(opened, return false);
+    out = run();
+    bool first = true;
+    trace.forEach(UINT64_MAX, [&](const traceRecord &record) {
+        if (first)
+        {
+            out.firstCycle = record.mCycle;
+            first = false;
+        }
+        require_or(static_cast<instructionSet>(record.set) == instructionSet::none, return);
+        require_or(record.mCycle < mCycles, return);
+        /// F is only current once the pending flags are applied.
+        registers reg;
+        reg.setAF(record.af);
+        reg.deferFlags(static_cast<registers::flagOperation>(record.flagOp), record.flagOperands, record.flagResult);
+        out.events.push_back({ record.mCycle, record.programCounter, record.stackPointer, reg.getAF(), record.bc,
+                               record.de, record.hl, record.opcode });
+    });
+    return true;
+}
+
+static void
+printEvent(const char *name, const event &e)
+{
+    printf("    %-20s M-cycle %llu event %u PC=%04x SP=%04x AF=%04x BC=%04x DE=%04x HL=%04x\n", name,
+           static_cast<unsigned long long>(e.mCycle), e.opcode, e.programCounter, e.stackPointer, e.af, e.bc, e.de,
+           e.hl);
+}
+
+/// @brief Compare every backend against the interpreter on one ROM, returns false on the first difference.
+static bool
+checkROM(const char *name, const char *romFilename, uint64_t mCycles)
+{
+    static constexpr struct
+    {
+        const char *                name;
+        CentralProcessor::backend   backend;
+        bool                        fusion;
+    } kEngines[] = {
+        { "interpreter",            CentralProcessor::backend::interpreter, false },
+        { "interpreter (fused)",    CentralProcessor::backend::interpreter, true },
+        { "threaded",               CentralProcessor::backend::threaded,    false },
+        { "recompiler",             CentralProcessor::backend::recompiler,  false },
+    };
+    printf("%s\n", name);
+    run baseline;
+    require_or(runROM(romFilename, kEngines[0].backend, kEngines[0].fusion, mCycles, baseline), return false);
+    for (size_t i = 1; i < std::size(kEngines); i++)
+    {
+        auto &engine = kEngines[i];
+        run other;
+        require_or(runROM(romFilename, engine.backend, engine.fusion, mCycles, other),
+                   printf("  %-20s not supported\n", engine.name); continue);
+        /// Compare from the oldest event both traces still hold.
+        uint64_t firstCycle = max(baseline.firstCycle, other.firstCycle);
+        auto skip = [firstCycle](const vector<event> &events) {
+            return find_if(events.begin(), events.end(), [firstCycle](const event &e) { return e.mCycle >= firstCycle; });
+        };
+        auto expected = skip(baseline.events), actual = skip(other.events);
+        size_t matched = 0;
+        for (; expected != baseline.events.end() && actual != other.events.end(); expected++, actual++, matched++)
+        {
+            require_or(*expected == *actual,
+                       printf("  %-20s differs at event %zu\n", engine.name, matched);
+                       printEvent(kEngines[0].name, *expected); printEvent(engine.name, *actual); return false);
+        }
+        require_or(expected == baseline.events.end() && actual == other.events.end(),
+                   printf("  %-20s has %zu events, not %zu\n", engine.name, other.events.size(),
+                          baseline.events.size());
+                   return false);
+        printf("  %-20s %zu events match\n", engine.name, matched);
+    }
+    return true;
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t mCycles = 2000000;
+    while (true)
+    {
+        int opt = 0;
+        require_or((opt = getopt(argc, argv, "c:")) != -1, break);
+        switch (opt)
+        {
+        case 'c':
+            mCycles = strtoull(optarg, nullptr, 0);
+            break;
+        }
+    }
+    /// The PPU draws into the display's pixel buffer.
+    HAL_DisplayInit("backend_check", kConfigScreenPixelsX, kConfigScreenPixelsY);
+
+    bool passed = true;
+    for (auto &rom: kBuiltinROMs)
+    {
+        char romFilename[] = "/tmp/backend_check_XXXXXX";
+        require_or(writeBuiltinROM(rom, romFilename), return 1);
+        passed = checkROM(rom.name, romFilename, 200000) && passed;
+        unlink(romFilename);
+    }
+    for (int i = optind; i < argc; i++)
+    {
+        passed = checkROM(argv[i], argv[i], mCycles) && passed;
+    }
+    require_or(passed, log_error("The backends disagree"); return 1);
+    systemExitStatus = 0;
+    return 0;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file fusion_profile.cpp
+ * @brief Count the most frequent straight-line opcode pairs and triples in an instruction trace.
+ *
+ * These are the candidates for `GameboyInstructionSetFused` in `cpu_instr.cpp`, profile a game with
+ * `gameboy -g <game> -b <instructions> -t <file>` and rerun this to refresh the set for it.
+ *
+ * usage: bin/fusion_profile [-n count] <trace file>
+ */
+#include "cpu.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace emu::gameboy;
+using namespace emu::gameboy::detail::cpu;
+using emu::gameboy::instruction::instructionSet;
+
+int systemExitStatus = 1;
+
+/// @brief Mnemonic with the operand left out, e.g. "CP n".
+static string
+mnemonic(const instruction::instruction *descriptor)
+{
+    string name = descriptor->getName() ? descriptor->getName() : "???";
+    size_t operand = name.find("%x");
+    if (operand != string::npos)
+    {
+        name.replace(operand, 2, "n");
+    }
+    return name;
+}
+
+/// @brief Sequences are keyed by their opcodes, the 16-bit set is marked with a 0xCB prefix.
+static uint32_t
+opcodeKey(const traceRecord &record)
+{
+    uint32_t prefix = (static_cast<instructionSet>(record.set) == instructionSet::set16bit) ? 0xCB00 : 0;
+    return prefix | record.opcode;
+}
+
+static void
+printTop(const char *title, const map<vector<uint32_t>, uint64_t> &counts,
+         const map<uint32_t, string> &names, uint64_t total, uint64_t limit)
+{
+    vector<pair<uint64_t, const vector<uint32_t> *>> sorted;
+    for (auto &[sequence, count]: counts)
+    {
+        sorted.emplace_back(count, &sequence);
+    }
+    sort(sorted.begin(), sorted.end(), [](auto &lhs, auto &rhs) { return lhs.first > rhs.first; });
+    printf("%s:\n", title);
+    for (uint64_t i = 0; i < min<uint64_t>(limit, sorted.size()); i++)
+    {
+        printf("  %6.2f%%  %10llu  ", 100.0 * sorted[i].first / total, static_cast<unsigned long long>(sorted[i].first));
+        const char *separator = "";
+        for (auto key: *sorted[i].second)
+        {
+            printf("%s%s (%s%02x)", separator, names.at(key).c_str(), (key > 0xFF) ? "CB " : "", key & 0xFF);
+            separator = " / ";
+        }
+        printf("\n");
+    }
+}
+
+int
+main(int argc, char **argv)
+{
+    uint64_t limit = 20;
+    while (true)
+    {
+        int opt = 0;
+        require_or((opt = getopt(argc, argv, "n:")) != -1, break);
+        switch (opt)
+        {
+        case 'n':
+            limit = strtoull(optarg, nullptr, 0);
+            break;
+        }
+    }
+    require_or(optind < argc, log_error("No trace file specified!"); return 1);
+    const char *filename = argv[optind];
+
+    TraceFile trace;
+    require_or(trace.open(filename), return 1);
+
+    /// Only instructions that fall through to the next one can be fused, a run is broken by any branch taken,
+    /// interrupt or halt.
+    map<vector<uint32_t>, uint64_t> pairs;
+    map<vector<uint32_t>, uint64_t> triples;
+    map<uint32_t, string> names;
+    vector<uint32_t> run;
+    uint64_t instructions = 0;
+    uint16_t nextAddress = 0;
+    trace.forEach(UINT64_MAX, [&](const traceRecord &record) {
+        auto descriptor = InstructionTrace::getInstruction(record);
+        if (descriptor == nullptr)
+        {
+            run.clear();
+            return;
+        }
+        instructions++;
+        if (record.programCounter != nextAddress)
+        {
+            run.clear();
+        }
+        uint32_t key = opcodeKey(record);
+        names.emplace(key, mnemonic(descriptor));
+        run.push_back(key);
+        if (run.size() > 3)
+        {
+            run.erase(run.begin());
+        }
+        if (run.size() >= 2)
+        {
+            pairs[{ run.end() - 2, run.end() }]++;
+        }
+        if (run.size() == 3)
+        {
+            triples[run]++;
+        }
+        uint8_t length = sizeof(uint8_t) + descriptor->getImmediateSize() +
+                         (descriptor->getSet() != instructionSet::set8bit);
+        nextAddress = record.programCounter + length;
+    });
+    require_or(instructions, log_error("%s has no instructions", filename); return 1);
+
+    printf("%llu instructions\n", static_cast<unsigned long long>(instructions));
+    printTop("Pairs", pairs, names, instructions, limit);
+    printTop("Triples", triples, names, instructions, limit);
+    systemExitStatus = 0;
+    return 0;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file trace_decoder.cpp
+ * @brief Print an instruction trace streamed by `gameboy -t <file>`.
+ *
+ * usage: bin/trace_decoder [-f] [-n count] <trace file>
+ */
+#include "cpu.h"
+
+using namespace std;
+using namespace emu::gameboy;
+using namespace emu::gameboy::detail::cpu;
+
+int systemExitStatus = 1;
+
+int
+main(int argc, char **argv)
+{
+    bool full = false;
+    uint64_t limit = UINT64_MAX;
+    while (true)
+    {
+        int opt = 0;
+        require_or((opt = getopt(argc, argv, "fn:")) != -1, break);
+        switch (opt)
+        {
+        case 'f':
+            full = true;
+            break;
+        case 'n':
+            limit = strtoull(optarg, nullptr, 0);
+            break;
+        }
+    }
+    require_or(optind < argc, log_error("No trace file specified!"); return 1);
+    const char *filename = argv[optind];
+
+    TraceFile trace;
+    require_or(trace.open(filename), return 1);
+    trace.forEach(limit, [full](const traceRecord &record) { InstructionTrace::print(record, full); });
+    systemExitStatus = 0;
+    return 0;
+}